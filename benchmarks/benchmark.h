@@ -0,0 +1,210 @@
+//   Copyright 2016-2023 Jean-Francois Poilpret
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+/*
+ * Common harness for FastArduino micro-benchmarks.
+ *
+ * Each benchmark measures the exact number of CPU cycles spent in a piece of
+ * code, by reading Timer1 counter (running without prescaler) before and
+ * after that code, with interrupts disabled. The fixed cost of the measure
+ * itself is calibrated once and subtracted from all results.
+ *
+ * Results are written to USART0 (115200 bps) as tab-separated lines:
+ *
+ *     BENCH	<name>	<cycles>
+ *
+ * Once all benchmarks are done, the MCU is put to sleep with interrupts
+ * disabled, which stops simavr. Benchmarks can also run on a real board, in
+ * which case results can be read from the serial console.
+ *
+ * Note that a single measure must not exceed 65535 cycles.
+ *
+ * When built with `-DFASTARDUINO_ISR_PROFILE`, `end()` also outputs the
+ * statistics of every ISR that was called during benchmarks, as lines:
+ *
+ *     ISR	<vector>	<count>	<max cycles>	<avg cycles>
+ *
+ * Usage:
+ * @code
+ * REGISTER_BENCHMARK_ISR()
+ *
+ * int main()
+ * {
+ *     board::init();
+ *     benchmark::Benchmark bench;
+ *     bench.begin();
+ *     BENCHMARK(bench, "queue/push", queue.push_(value));
+ *     bench.end();
+ * }
+ * @endcode
+ */
+#ifndef BENCHMARK_HH
+#define BENCHMARK_HH
+
+#include <avr/sleep.h>
+#include <fastarduino/boards/board.h>
+#include <fastarduino/flash.h>
+#include <fastarduino/streams.h>
+#include <fastarduino/timer.h>
+#include <fastarduino/uart.h>
+
+#if !defined(ARDUINO_UNO) && !defined(ARDUINO_NANO) && !defined(BREADBOARD_ATMEGA328P)
+#error "Benchmarks are only supported on ATmega328P based targets!"
+#endif
+
+/**
+ * Register ISR needed by `benchmark::Benchmark` to output its results.
+ * This must be called once in each benchmark program.
+ */
+#define REGISTER_BENCHMARK_ISR()	\
+	REGISTER_UART_ISR(0)			\
+	REGISTER_OSTREAMBUF_LISTENERS(serial::hard::UART<board::USART::USART0>)
+
+/**
+ * Measure the number of cycles spent executing `__VA_ARGS__` and report it
+ * under @p NAME.
+ */
+#define BENCHMARK(BENCH, NAME, ...)	\
+	{								\
+		BENCH.start();				\
+		__VA_ARGS__;				\
+		BENCH.stop(F(NAME));		\
+	}
+
+namespace benchmark
+{
+	/**
+	 * Prevent the compiler from optimizing away computation of @p value, or
+	 * from moving it outside of the measured section.
+	 */
+	template<typename T> inline void keep(T& value)
+	{
+		__asm__ __volatile__("" : "+m" (value) :: "memory");
+	}
+
+	class Benchmark
+	{
+	private:
+		using UART = serial::hard::UART<board::USART::USART0>;
+		using TIMER = timer::Timer<board::Timer::TIMER1>;
+
+	public:
+		Benchmark()
+			:	uart_{input_buffer_, output_buffer_},
+				timer_{timer::TimerMode::NORMAL, TIMER::PRESCALER::NO_PRESCALING} {}
+		Benchmark(const Benchmark&) = delete;
+		Benchmark& operator=(const Benchmark&) = delete;
+
+		/**
+		 * Start UART output and cycles counter, then calibrate the cost of
+		 * measuring.
+		 */
+		void begin()
+		{
+			sei();
+			uart_.begin(BAUD_RATE);
+			timer_.begin();
+			start();
+			overhead_ = elapsed();
+			sei();
+		}
+
+		/**
+		 * Flush all results, then stop the MCU (and thus the simulator).
+		 */
+		void end()
+		{
+#ifdef FASTARDUINO_ISR_PROFILE
+			report_isr();
+#endif
+			out().flush();
+			cli();
+			set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+			sleep_enable();
+			sleep_cpu();
+		}
+
+		/**
+		 * The output stream used for results; benchmarks may use it to output
+		 * additional information, but not within a measured section.
+		 */
+		streams::ostream out()
+		{
+			return uart_.out();
+		}
+
+		/** Start a measured section; interrupts are disabled until `stop()`. */
+		void start() INLINE
+		{
+			cli();
+			timer_.reset_();
+			__asm__ __volatile__("" ::: "memory");
+		}
+
+		/**
+		 * Return the number of cycles since last `start()`; interrupts remain
+		 * disabled, this is useful to chain several measures without letting
+		 * ISR execute in between.
+		 */
+		uint16_t elapsed() INLINE
+		{
+			__asm__ __volatile__("" ::: "memory");
+			return timer_.ticks_() - overhead_;
+		}
+
+		/** End a measured section and report its cycles under @p name. */
+		void stop(const flash::FlashStorage* name) INLINE
+		{
+			const uint16_t cycles = elapsed();
+			sei();
+			report(name, cycles);
+		}
+
+		/** Report @p cycles for benchmark @p name. */
+		void report(const flash::FlashStorage* name, uint16_t cycles)
+		{
+			streams::ostream output = out();
+			output << F("BENCH\t") << name << '\t' << cycles << streams::endl;
+		}
+
+#ifdef FASTARDUINO_ISR_PROFILE
+		/** Report statistics of all ISR called so far. */
+		void report_isr()
+		{
+			streams::ostream output = out();
+			for (const interrupt::ISRStats* stats = interrupt::ISRProfiler::first(); stats != nullptr;
+				stats = stats->next())
+			{
+				const interrupt::ISRStatsData data = stats->stats();
+				if (data.count)
+					output	<< F("ISR\t") << stats->name() << '\t' << data.count << '\t' << data.max << '\t'
+							<< (data.total / data.count) << streams::endl;
+			}
+		}
+#endif
+
+	private:
+		static constexpr const uint32_t BAUD_RATE = 115200;
+		static constexpr const uint8_t INPUT_BUFFER_SIZE = 8;
+		static constexpr const uint8_t OUTPUT_BUFFER_SIZE = 64;
+
+		char input_buffer_[INPUT_BUFFER_SIZE];
+		char output_buffer_[OUTPUT_BUFFER_SIZE];
+		UART uart_;
+		TIMER timer_;
+		uint16_t overhead_ = 0;
+	};
+}
+
+#endif /* BENCHMARK_HH */
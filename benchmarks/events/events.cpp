@@ -0,0 +1,120 @@
+//   Copyright 2016-2023 Jean-Francois Poilpret
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+/*
+ * Benchmarks of events::Dispatcher and events::Scheduler, on a typical event
+ * loop: pull an event from a queue, then dispatch it to its handler.
+ */
+
+#include <fastarduino/events.h>
+#include <fastarduino/scheduler.h>
+#include <benchmark.h>
+
+REGISTER_BENCHMARK_ISR()
+
+using EVENT = events::Event<uint8_t>;
+
+class Handler : public events::EventHandler<EVENT>
+{
+public:
+	explicit Handler(uint8_t type) : events::EventHandler<EVENT>{type} {}
+
+protected:
+	void on_event(const EVENT& event) final
+	{
+		value_ = event.value();
+	}
+
+private:
+	volatile uint8_t value_ = 0;
+};
+
+// Clock always returning the same time
+class Clock
+{
+public:
+	uint32_t millis() const
+	{
+		return NOW;
+	}
+	static constexpr const uint32_t NOW = 1000;
+};
+
+class Task : public events::Job
+{
+public:
+	Task(uint32_t next, uint32_t period) : events::Job{next, period} {}
+
+protected:
+	void on_schedule(uint32_t millis) final
+	{
+		millis_ = millis;
+	}
+
+private:
+	volatile uint32_t millis_ = 0;
+};
+
+static constexpr const uint8_t QUEUE_SIZE = 8;
+static EVENT buffer[QUEUE_SIZE];
+
+int main() __attribute__((OS_main));
+int main()
+{
+	board::init();
+	benchmark::Benchmark bench;
+	bench.begin();
+
+	containers::Queue<EVENT> queue{buffer};
+	events::Dispatcher<EVENT> dispatcher;
+	Handler handler1{events::Type::USER_EVENT};
+	Handler handler2{events::Type::USER_EVENT + 1};
+	Handler handler3{events::Type::USER_EVENT + 2};
+	Handler handler4{events::Type::USER_EVENT + 3};
+	dispatcher.insert(handler1);
+	dispatcher.insert(handler2);
+	dispatcher.insert(handler3);
+	dispatcher.insert(handler4);
+
+	const EVENT first{events::Type::USER_EVENT, 1};
+	const EVENT last{events::Type::USER_EVENT + 3, 2};
+	const EVENT none{events::Type::USER_EVENT + 4, 3};
+	EVENT event;
+
+	BENCHMARK(bench, "events/push", queue.push_(first))
+	BENCHMARK(bench, "events/pull", queue.pull_(event))
+	BENCHMARK(bench, "dispatcher/dispatch_first", dispatcher.dispatch(first))
+	BENCHMARK(bench, "dispatcher/dispatch_last", dispatcher.dispatch(last))
+	BENCHMARK(bench, "dispatcher/dispatch_none", dispatcher.dispatch(none))
+	BENCHMARK(bench, "dispatcher/loop", queue.push_(last); queue.pull_(event); dispatcher.dispatch(event))
+
+	// Scheduler ticks, with jobs not due or due
+	Clock clock;
+	events::Scheduler<Clock, EVENT> scheduler{clock, events::Type::RTT_TIMER};
+	dispatcher.insert(scheduler);
+	Task task1{Clock::NOW + 1000, 1000};
+	Task task2{Clock::NOW + 1000, 1000};
+	scheduler.schedule(task1);
+	scheduler.schedule(task2);
+	const EVENT tick{events::Type::RTT_TIMER};
+
+	BENCHMARK(bench, "scheduler/tick_idle", dispatcher.dispatch(tick))
+	task1.reschedule(Clock::NOW);
+	BENCHMARK(bench, "scheduler/tick_one_due", dispatcher.dispatch(tick))
+	task1.reschedule(Clock::NOW);
+	task2.reschedule(Clock::NOW);
+	BENCHMARK(bench, "scheduler/tick_two_due", dispatcher.dispatch(tick))
+
+	bench.end();
+}
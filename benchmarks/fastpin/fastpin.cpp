@@ -0,0 +1,47 @@
+//   Copyright 2016-2023 Jean-Francois Poilpret
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+/*
+ * Benchmarks of gpio::FastPin and gpio::FastPort operations.
+ */
+
+#include <fastarduino/gpio.h>
+#include <benchmark.h>
+
+REGISTER_BENCHMARK_ISR()
+
+int main() __attribute__((OS_main));
+int main()
+{
+	board::init();
+	benchmark::Benchmark bench;
+	bench.begin();
+
+	gpio::FastPinType<board::DigitalPin::LED>::TYPE output{gpio::PinMode::OUTPUT};
+	gpio::FastPinType<board::DigitalPin::D2_PD2>::TYPE input{gpio::PinMode::INPUT_PULLUP};
+	gpio::FastPort<board::Port::PORT_C> port{0xFF};
+	gpio::FastMaskedPort<board::Port::PORT_C, 0x0F> masked_port{0xFF};
+	bool value = false;
+
+	BENCHMARK(bench, "fastpin/set", output.set())
+	BENCHMARK(bench, "fastpin/clear", output.clear())
+	BENCHMARK(bench, "fastpin/toggle", output.toggle())
+	BENCHMARK(bench, "fastpin/value", value = input.value(); benchmark::keep(value))
+	BENCHMARK(bench, "fastpin/set_mode", input.set_mode(gpio::PinMode::INPUT))
+	BENCHMARK(bench, "fastport/set_PORT", port.set_PORT(0x55))
+	BENCHMARK(bench, "fastport/get_PIN", uint8_t pins = port.get_PIN(); benchmark::keep(pins))
+	BENCHMARK(bench, "fastmaskedport/set_PORT", masked_port.set_PORT(0x05))
+
+	bench.end();
+}
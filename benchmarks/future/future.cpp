@@ -0,0 +1,53 @@
+//   Copyright 2016-2023 Jean-Francois Poilpret
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+/*
+ * Benchmarks of future::Future operations, as used by ISR (producer side)
+ * and by application code (consumer side).
+ */
+
+#include <fastarduino/future.h>
+#include <benchmark.h>
+
+REGISTER_BENCHMARK_ISR()
+REGISTER_FUTURE_NO_LISTENERS()
+
+int main() __attribute__((OS_main));
+int main()
+{
+	board::init();
+	benchmark::Benchmark bench;
+	bench.begin();
+
+	future::Future<uint16_t> future16;
+	future::Future<uint32_t, uint8_t> future32{0x12};
+	uint16_t value16 = 0x1234;
+	uint32_t value32 = 0;
+	uint8_t input = 0;
+
+	BENCHMARK(bench, "future/set_value", future16.set_future_value_(value16))
+	BENCHMARK(bench, "future/get", future16.get(value16))
+	BENCHMARK(bench, "future/reset", future16.reset_())
+	BENCHMARK(bench, "future/set_error", future16.set_future_error_(errors::EIO))
+	future16.reset_();
+	BENCHMARK(bench, "future/get_storage_value", future32.get_storage_value_(input))
+	BENCHMARK(bench, "future/set_value_chunks",
+		for (uint8_t i = 0; i < sizeof(uint32_t); ++i) future32.set_future_value_(i))
+	BENCHMARK(bench, "future/get_long", future32.get(value32))
+	benchmark::keep(value16);
+	benchmark::keep(value32);
+	benchmark::keep(input);
+
+	bench.end();
+}
@@ -0,0 +1,94 @@
+//   Copyright 2016-2023 Jean-Francois Poilpret
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+/*
+ * Benchmarks of asynchronous I2C manager: commands launch and TWI ISR.
+ * A DS1307 datetime read is launched, then each TWI interrupt is serviced
+ * by calling the ISR directly, with interrupts disabled, as soon as TWINT is
+ * set; this gives the exact cost of each ISR call, including its prologue
+ * and epilogue.
+ * This benchmark does not need any I2C device; without device, the ISR cost
+ * of a NACK on device address is measured.
+ */
+
+#include <fastarduino/i2c_handler.h>
+#include <fastarduino/devices/ds1307.h>
+#include <benchmark.h>
+
+using MANAGER = i2c::I2CAsyncManager<i2c::I2CMode::STANDARD>;
+using RTC = devices::rtc::DS1307<MANAGER>;
+
+REGISTER_BENCHMARK_ISR()
+REGISTER_I2C_ISR(MANAGER)
+REGISTER_FUTURE_NO_LISTENERS()
+
+extern "C" void TWI_vect();
+
+static constexpr const uint8_t I2C_BUFFER_SIZE = 32;
+static MANAGER::I2CCOMMAND i2c_buffer[I2C_BUFFER_SIZE];
+
+// Maximum number of ISR calls for one transaction
+static constexpr const uint8_t MAX_ISR_CALLS = 32;
+// Maximum loops waiting for TWINT before giving up
+static constexpr const uint16_t MAX_WAIT_LOOPS = 10000;
+
+static bool wait_twint()
+{
+	for (uint16_t loops = 0; loops < MAX_WAIT_LOOPS; ++loops)
+		if (TWCR & _BV(TWINT)) return true;
+	return false;
+}
+
+int main() __attribute__((OS_main));
+int main()
+{
+	board::init();
+	benchmark::Benchmark bench;
+	bench.begin();
+
+	MANAGER manager{i2c_buffer};
+	manager.begin();
+	RTC rtc{manager};
+	RTC::GetDatetimeFuture future;
+
+	bench.start();
+	rtc.get_datetime(future);
+	const uint16_t launch = bench.elapsed();
+
+	uint16_t first = 0;
+	uint16_t max = 0;
+	uint16_t total = 0;
+	for (uint8_t calls = 0; calls < MAX_ISR_CALLS; ++calls)
+	{
+		if (future.status() != future::FutureStatus::NOT_READY) break;
+		if (!wait_twint()) break;
+		bench.start();
+		// ISR returns with interrupts enabled, disable them immediately
+		TWI_vect();
+		cli();
+		const uint16_t cycles = bench.elapsed();
+		if (calls == 0) first = cycles;
+		if (cycles > max) max = cycles;
+		total += cycles;
+	}
+	sei();
+
+	bench.report(F("i2c/launch_get_datetime"), launch);
+	bench.report(F("i2c/isr_first"), first);
+	bench.report(F("i2c/isr_max"), max);
+	bench.report(F("i2c/isr_total"), total);
+
+	manager.end();
+	bench.end();
+}
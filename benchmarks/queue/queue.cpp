@@ -0,0 +1,57 @@
+//   Copyright 2016-2023 Jean-Francois Poilpret
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+/*
+ * Benchmarks of containers::Queue push and pull operations.
+ */
+
+#include <fastarduino/queue.h>
+#include <benchmark.h>
+
+REGISTER_BENCHMARK_ISR()
+
+static constexpr const uint8_t QUEUE_SIZE = 32;
+static char char_buffer[QUEUE_SIZE];
+static uint32_t long_buffer[QUEUE_SIZE];
+
+int main() __attribute__((OS_main));
+int main()
+{
+	board::init();
+	benchmark::Benchmark bench;
+	bench.begin();
+
+	containers::Queue<char> chars{char_buffer};
+	containers::Queue<uint32_t> longs{long_buffer};
+	char c = 'A';
+	uint32_t l = 0x12345678UL;
+
+	BENCHMARK(bench, "queue/push_char", chars.push_(c))
+	BENCHMARK(bench, "queue/pull_char", chars.pull_(c))
+	BENCHMARK(bench, "queue/pull_char_empty", chars.pull_(c))
+	BENCHMARK(bench, "queue/push_char_sync", chars.push(c))
+	BENCHMARK(bench, "queue/pull_char_sync", chars.pull(c))
+	BENCHMARK(bench, "queue/push_long", longs.push_(l))
+	BENCHMARK(bench, "queue/peek_long", longs.peek_(l))
+	BENCHMARK(bench, "queue/pull_long", longs.pull_(l))
+	// Fill queue until full
+	BENCHMARK(bench, "queue/fill_char", while (chars.push_(c)) ++c)
+	BENCHMARK(bench, "queue/push_char_full", chars.push_(c))
+	BENCHMARK(bench, "queue/items", uint8_t items = chars.items_(); benchmark::keep(items))
+	BENCHMARK(bench, "queue/clear", chars.clear_())
+	benchmark::keep(c);
+	benchmark::keep(l);
+
+	bench.end();
+}
@@ -0,0 +1,72 @@
+//   Copyright 2016-2023 Jean-Francois Poilpret
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+/*
+ * Benchmarks of SPI transfers, as performed by SPI devices drivers.
+ * This benchmark does not need any SPI device.
+ */
+
+#include <fastarduino/spi.h>
+#include <benchmark.h>
+
+REGISTER_BENCHMARK_ISR()
+
+class Device : public spi::SPIDevice<board::DigitalPin::D10_PB2, spi::ChipSelect::ACTIVE_LOW, spi::ClockRate::CLOCK_DIV_2>
+{
+public:
+	uint8_t transfer_byte(uint8_t data)
+	{
+		start_transfer();
+		data = transfer(data);
+		end_transfer();
+		return data;
+	}
+
+	uint8_t retransfer_byte(uint8_t data)
+	{
+		restart_transfer();
+		data = transfer(data);
+		end_transfer();
+		return data;
+	}
+
+	void transfer_buffer(uint8_t* data, uint16_t size)
+	{
+		start_transfer();
+		transfer(data, size);
+		end_transfer();
+	}
+};
+
+static constexpr const uint8_t BUFFER_SIZE = 16;
+static uint8_t buffer[BUFFER_SIZE];
+
+int main() __attribute__((OS_main));
+int main()
+{
+	board::init();
+	benchmark::Benchmark bench;
+	bench.begin();
+
+	spi::init();
+	Device device;
+	uint8_t data = 0x55;
+
+	BENCHMARK(bench, "spi/transfer_byte", data = device.transfer_byte(data))
+	BENCHMARK(bench, "spi/retransfer_byte", data = device.retransfer_byte(data))
+	BENCHMARK(bench, "spi/transfer_16_bytes", device.transfer_buffer(buffer, BUFFER_SIZE))
+	benchmark::keep(data);
+
+	bench.end();
+}
@@ -0,0 +1,64 @@
+//   Copyright 2016-2023 Jean-Francois Poilpret
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+/*
+ * Benchmarks of streams::ostream formatting (to a buffer without consumer).
+ */
+
+#include <fastarduino/streams.h>
+#include <fastarduino/iomanip.h>
+#include <benchmark.h>
+
+REGISTER_BENCHMARK_ISR()
+
+static constexpr const uint8_t BUFFER_SIZE = 64;
+static char buffer[BUFFER_SIZE];
+
+int main() __attribute__((OS_main));
+int main()
+{
+	board::init();
+	benchmark::Benchmark bench;
+	bench.begin();
+
+	streams::ostreambuf buf{buffer};
+	buf.queue().unlock();
+	streams::ostream out{buf};
+	const uint16_t u16 = 54321U;
+	const int16_t i16 = -12345;
+	const uint32_t u32 = 1234567890UL;
+	const double d = 3.14159;
+
+	BENCHMARK(bench, "streams/char", out << 'A')
+	buf.queue().clear();
+	BENCHMARK(bench, "streams/string", out << "Hello, World!")
+	buf.queue().clear();
+	BENCHMARK(bench, "streams/flash_string", out << F("Hello, World!"))
+	buf.queue().clear();
+	BENCHMARK(bench, "streams/uint16_dec", out << u16)
+	buf.queue().clear();
+	BENCHMARK(bench, "streams/int16_dec", out << i16)
+	buf.queue().clear();
+	BENCHMARK(bench, "streams/uint32_dec", out << u32)
+	buf.queue().clear();
+	BENCHMARK(bench, "streams/uint16_hex", out << streams::hex << u16)
+	out << streams::dec;
+	buf.queue().clear();
+	BENCHMARK(bench, "streams/uint16_setw", out << streams::setw(8) << u16)
+	buf.queue().clear();
+	BENCHMARK(bench, "streams/double", out << d)
+	buf.queue().clear();
+
+	bench.end();
+}
@@ -0,0 +1,98 @@
+//   Copyright 2016-2023 Jean-Francois Poilpret
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+/*
+ * Benchmarks of hardware UART: putting characters to its output stream, and
+ * its ISR (UDRE and RX).
+ * Each ISR is called directly, with interrupts disabled, once the hardware
+ * is ready; this gives the exact cost of each ISR call, including its
+ * prologue and epilogue.
+ * This benchmark uses USART0, which is also used to output results; it only
+ * transmits 2 new lines.
+ */
+
+#include <benchmark.h>
+
+REGISTER_BENCHMARK_ISR()
+
+extern "C" void USART_UDRE_vect();
+extern "C" void USART_RX_vect();
+
+// Maximum loops waiting for UDRE before giving up
+static constexpr const uint16_t MAX_WAIT_LOOPS = 10000;
+
+static bool wait_udre()
+{
+	for (uint16_t loops = 0; loops < MAX_WAIT_LOOPS; ++loops)
+		if (UCSR0A & _BV(UDRE0)) return true;
+	return false;
+}
+
+int main() __attribute__((OS_main));
+int main()
+{
+	board::init();
+	benchmark::Benchmark bench;
+	bench.begin();
+
+	streams::ostream out = bench.out();
+	// Ensure UART is idle
+	out.flush();
+
+	// Put while UART is idle: first character is immediately written to UDR
+	bench.start();
+	out.put('\n');
+	const uint16_t put_idle = bench.elapsed();
+
+	// Put while UART is transmitting: character is only queued
+	bench.start();
+	out.put('\n');
+	const uint16_t put_busy = bench.elapsed();
+
+	// UDRE ISR with one character to transmit
+	uint16_t isr_udre_send = 0;
+	if (wait_udre())
+	{
+		bench.start();
+		// ISR returns with interrupts enabled, disable them immediately
+		USART_UDRE_vect();
+		cli();
+		isr_udre_send = bench.elapsed();
+	}
+
+	// UDRE ISR with empty queue: UDRE interrupt gets disabled
+	uint16_t isr_udre_empty = 0;
+	if (wait_udre())
+	{
+		bench.start();
+		USART_UDRE_vect();
+		cli();
+		isr_udre_empty = bench.elapsed();
+	}
+
+	// RX ISR: received character is pushed to input queue
+	bench.start();
+	USART_RX_vect();
+	cli();
+	const uint16_t isr_rx = bench.elapsed();
+	sei();
+
+	bench.report(F("uart/put_idle"), put_idle);
+	bench.report(F("uart/put_busy"), put_busy);
+	bench.report(F("uart/isr_udre_send"), isr_udre_send);
+	bench.report(F("uart/isr_udre_empty"), isr_udre_empty);
+	bench.report(F("uart/isr_rx"), isr_rx);
+
+	bench.end();
+}
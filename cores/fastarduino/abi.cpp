@@ -14,6 +14,9 @@
 
 #include "defines.h"
 
+// Host-native builds (CONF=HOST) use the host C++ ABI library
+#ifndef FASTARDUINO_HOST
+
 // Interesting and complete description here (C++ wise, not AVR specific)
 // https://itanium-cxx-abi.github.io/cxx-abi/abi.html
 // Default GCC 11.1.0 ABI header
@@ -49,3 +52,5 @@ namespace __cxxabiv1
 		void __cxa_finalize(void* f UNUSED) {}
 	}
 }
+
+#endif
@@ -40,64 +40,101 @@ namespace board_traits
 		}
 		void operator=(int value) const INLINE
 		{
-			*((volatile T*) addr_) = (T) value;
+			ref_() = (T) value;
+			written_();
 		}
 		void operator|=(int value) const INLINE
 		{
-			*((volatile T*) addr_) |= (T) value;
+			reading_();
+			ref_() |= (T) value;
+			written_();
 		}
 		void operator&=(int value) const INLINE
 		{
-			*((volatile T*) addr_) &= (T) value;
+			reading_();
+			ref_() &= (T) value;
+			written_();
 		}
 		void operator^=(int value) const INLINE
 		{
-			*((volatile T*) addr_) ^= (T) value;
+			reading_();
+			ref_() ^= (T) value;
+			written_();
 		}
 		T operator~() const INLINE
 		{
-			return ~(*((volatile T*) addr_));
+			return ~(read_());
 		}
 		void loop_until_bit_set(uint8_t bit) const INLINE
 		{
-			while ((*((volatile T*) addr_) & bits::BV8(bit)) == 0)
+			while ((read_() & bits::BV8(bit)) == 0)
 				;
 		}
 		void loop_until_bit_clear(uint8_t bit) const INLINE
 		{
-			while (*((volatile T*) addr_) & bits::BV8(bit))
+			while (read_() & bits::BV8(bit))
 				;
 		}
 		bool operator==(int value) const INLINE
 		{
-			return *((volatile T*) addr_) == (T) value;
+			return read_() == (T) value;
 		}
 		bool operator!=(int value) const INLINE
 		{
-			return *((volatile T*) addr_) != (T) value;
+			return read_() != (T) value;
 		}
 		bool operator>(int value) const INLINE
 		{
-			return *((volatile T*) addr_) > (T) value;
+			return read_() > (T) value;
 		}
 		bool operator>=(int value) const INLINE
 		{
-			return *((volatile T*) addr_) >= (T) value;
+			return read_() >= (T) value;
 		}
 		bool operator<(int value) const INLINE
 		{
-			return *((volatile T*) addr_) < (T) value;
+			return read_() < (T) value;
 		}
 		bool operator<=(int value) const INLINE
 		{
-			return *((volatile T*) addr_) <= (T) value;
+			return read_() <= (T) value;
 		}
 		operator volatile T&() const INLINE
 		{
-			return *((volatile T*) addr_);
+			reading_();
+			return ref_();
 		}
 
 	private:
+#ifdef FASTARDUINO_HOST
+		// Host build: registers are simulated, with hooks (see host_registers.h)
+		volatile T& ref_() const INLINE
+		{
+			return host::reference<T>(addr_);
+		}
+		void reading_() const INLINE
+		{
+			host::on_read(addr_);
+		}
+		void written_() const INLINE
+		{
+			host::on_write(addr_);
+		}
+#else
+		volatile T& ref_() const INLINE
+		{
+			return *((volatile T*) addr_);
+		}
+		void reading_() const INLINE {}
+		void written_() const INLINE {}
+#endif
+
+		T read_() const INLINE
+		{
+			reading_();
+			return ref_();
+		}
+
 		const uint16_t addr_;
 	};
 
@@ -41,6 +41,14 @@
 #endif
 #define _SFR_MEM16(x) (x)
 
+#ifdef FASTARDUINO_HOST
+// Host build: SREG is simulated (see host_registers.h)
+#ifdef SREG
+#undef SREG
+#define SREG (host::registers[0x3F + __SFR_OFFSET])
+#endif
+
+#else
 // Force RAMPZ which is used by pgmspace.h
 #ifdef RAMPZ
 #undef RAMPZ
@@ -52,5 +60,6 @@
 #undef SREG
 #define SREG (*((volatile uint8_t*) (0x3F + __SFR_OFFSET)))
 #endif
+#endif
 
 #endif /* BOARDS_IO_HH */
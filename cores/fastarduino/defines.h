@@ -112,5 +112,17 @@
  */
 #define WEAK __attribute__((weak))
 
+/// @cond notdocumented
+#ifdef FASTARDUINO_HOST
+// Host-native build (CONF=HOST): no AVR specific instructions or attributes
+#undef NOP
+#define NOP()
+#undef SIGNAL_HANDLER
+#define SIGNAL_HANDLER
+#undef NAKED_SIGNAL
+#define NAKED_SIGNAL __attribute__((__INTR_ATTRS))
+#endif
+/// @endcond
+
 #endif /* DEFINES_HH */
 /// @endcond
@@ -0,0 +1,323 @@
+//   Copyright 2016-2023 Jean-Francois Poilpret
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+/// @cond api
+
+/**
+ * @file
+ * API to get current date and time from a DS1307 RTC chip, without any I2C
+ * transaction, by extrapolating from an RTT synchronized on the chip SQW output.
+ */
+#ifndef DS1307_CLOCK_HH
+#define DS1307_CLOCK_HH
+
+#include "ds1307.h"
+#include "../errors.h"
+#include "../int.h"
+#include "../interrupts.h"
+#include "../realtime_timer.h"
+#include "../time.h"
+
+/**
+ * Register the necessary ISR (Interrupt Service Routine) for a
+ * `devices::rtc::DS1307Clock` to be notified of DS1307 SQW/OUT falling edges.
+ * @param INT_NUM the number of the `INT` vector for the
+ * `board::ExternalInterruptPin` connected to the DS1307 SQW/OUT pin
+ * @param CLOCK the `devices::rtc::DS1307Clock` type used
+ *
+ * @sa devices::rtc::DS1307Clock
+ */
+#define REGISTER_DS1307_CLOCK_INT_ISR(INT_NUM, CLOCK)                      \
+	ISR(CAT3(INT, INT_NUM, _vect))                                         \
+	{                                                                      \
+		devices::rtc::isr_handler_ds1307_clock::sqw<INT_NUM, CLOCK>();     \
+	}
+
+namespace devices::rtc
+{
+	/// @cond notdocumented
+	struct isr_handler_ds1307_clock;
+	/// @endcond
+
+	/**
+	 * Clock service providing current date and time, as read from a DS1307
+	 * RTC chip, but without any I2C transaction for each timestamp.
+	 *
+	 * The DS1307 is read only once, at `begin()`; then the DS1307 SQW/OUT
+	 * pin, configured to 1Hz and connected to an external interrupt pin, marks
+	 * the start of every new second (DS1307 time registers are incremented
+	 * on SQW/OUT falling edge), while milliseconds within the current second
+	 * are extrapolated from a `timer::RTT`. Hence the clock never drifts from
+	 * the DS1307 time, and getting a timestamp with `epoch()` takes only a few
+	 * hundred cycles, instead of a full I2C transaction and BCD conversions.
+	 *
+	 * Edges can be missed if interrupts are disabled for more than one second,
+	 * or if SQW/OUT is disconnected; in the latter case, seconds are still
+	 * extrapolated from the RTT. Periodic calls to `sync()` (e.g. every hour)
+	 * re-read the DS1307 and correct any such drift.
+	 *
+	 * Times are expressed as "epoch" seconds elapsed since 2000-01-01 00:00:00,
+	 * which is the origin of DS1307 dates.
+	 *
+	 * @code
+	 * using RTC = devices::rtc::DS1307<MANAGER>;
+	 * using CLOCK = devices::rtc::DS1307Clock<MANAGER, board::Timer::TIMER0, board::ExternalInterruptPin::D2_PD2_EXT0>;
+	 * REGISTER_DS1307_CLOCK_INT_ISR(0, CLOCK)
+	 * REGISTER_RTT_ISR(0)
+	 * ...
+	 * timer::RTT<board::Timer::TIMER0> rtt;
+	 * rtt.begin();
+	 * RTC rtc{manager};
+	 * CLOCK clock{rtc, rtt};
+	 * clock.begin();
+	 * ...
+	 * uint32_t now = clock.epoch();
+	 * @endcode
+	 *
+	 * @tparam MANAGER one of FastArduino available I2C Manager
+	 * @tparam NRTT_ the timer used by the `timer::RTT` used for extrapolation
+	 * @tparam SQW_ the `board::ExternalInterruptPin` connected to DS1307 SQW/OUT
+	 *
+	 * @sa REGISTER_DS1307_CLOCK_INT_ISR()
+	 * @sa DS1307
+	 */
+	template<typename MANAGER, board::Timer NRTT_, board::ExternalInterruptPin SQW_>
+	class DS1307Clock
+	{
+	public:
+		/** The type of DS1307 device used by this clock. */
+		using RTC = DS1307<MANAGER>;
+		/** The type of RTT used by this clock. */
+		using RTT = timer::RTT<NRTT_>;
+		/** The external interrupt pin connected to DS1307 SQW/OUT. */
+		static constexpr const board::ExternalInterruptPin SQW = SQW_;
+
+		DS1307Clock(const DS1307Clock&) = delete;
+		DS1307Clock& operator=(const DS1307Clock&) = delete;
+
+		/**
+		 * Create a new clock service.
+		 * @param rtc the DS1307 device to read date and time from
+		 * @param rtt the RTT used to extrapolate time between SQW/OUT edges;
+		 * it must be started before `begin()` is called.
+		 */
+		DS1307Clock(RTC& rtc, const RTT& rtt)
+			:	rtc_{rtc}, rtt_{rtt}, signal_{interrupt::InterruptTrigger::FALLING_EDGE}
+		{
+			interrupt::register_handler(*this);
+		}
+
+		/**
+		 * Start this clock: enable DS1307 SQW/OUT at 1Hz, wait for its next
+		 * falling edge, then read current date and time from DS1307.
+		 * @warning Blocking API! This may block for up to 2 seconds.
+		 * @retval 0 if the clock was properly started
+		 * @retval errors::EIO if the DS1307 could not be accessed
+		 * @retval errors::ETIME if no SQW/OUT edge was detected within 2 seconds;
+		 * the clock is still started but with a precision of 1 second only
+		 * @sa end()
+		 */
+		int begin()
+		{
+			if (!rtc_.enable_output(SquareWaveFrequency::FREQ_1HZ)) return errors::EIO;
+			signal_.enable();
+			return sync();
+		}
+
+		/**
+		 * Stop listening to DS1307 SQW/OUT edges; from now on, time is
+		 * extrapolated from the RTT only.
+		 * @sa begin()
+		 */
+		void end()
+		{
+			signal_.disable();
+		}
+
+		/**
+		 * Re-read current date and time from DS1307, just after the next
+		 * SQW/OUT falling edge, in order to correct any drift.
+		 * @warning Blocking API! This may block for up to 2 seconds.
+		 * @retval 0 if the clock was properly synchronized
+		 * @retval errors::EIO if the DS1307 could not be accessed
+		 * @retval errors::ETIME if no SQW/OUT edge was detected within 2 seconds;
+		 * the clock is still synchronized but with a precision of 1 second only
+		 */
+		int sync()
+		{
+			// Wait for next edge so that DS1307 is read at the start of a second
+			const uint8_t edges = edges_;
+			const uint32_t start = rtt_.millis();
+			bool timeout = false;
+			while (edges == edges_ && !timeout)
+			{
+				timeout = (rtt_.millis() - start > SYNC_TIMEOUT_MS);
+				time::yield();
+			}
+			tm datetime;
+			if (!rtc_.get_datetime(datetime)) return errors::EIO;
+			synchronized
+			{
+				ref_epoch_ = to_epoch(datetime);
+				// Without edge, the start of current second is unknown
+				if (timeout) ref_millis_ = rtt_.millis_();
+			}
+			return (timeout ? errors::ETIME : 0);
+		}
+
+		/**
+		 * Get current time, as seconds elapsed since 2000-01-01 00:00:00.
+		 * @sa epoch(uint16_t&)
+		 */
+		uint32_t epoch() const
+		{
+			uint16_t millis;
+			return epoch(millis);
+		}
+
+		/**
+		 * Get current time, as seconds elapsed since 2000-01-01 00:00:00, and
+		 * milliseconds elapsed since the start of the current second.
+		 * @param millis set to the milliseconds, from `0` to `999`, elapsed
+		 * since the start of the returned second
+		 * @sa epoch()
+		 */
+		uint32_t epoch(uint16_t& millis) const
+		{
+			uint32_t ref_epoch;
+			uint32_t elapsed;
+			synchronized
+			{
+				ref_epoch = ref_epoch_;
+				elapsed = rtt_.millis_() - ref_millis_;
+			}
+			// Avoid 32 bits division in the normal case (SQW/OUT edge less than 1s ago)
+			if (elapsed < ONE_SECOND_MS)
+			{
+				millis = uint16_t(elapsed);
+				return ref_epoch;
+			}
+			millis = uint16_t(elapsed % ONE_SECOND_MS);
+			return ref_epoch + elapsed / ONE_SECOND_MS;
+		}
+
+		/**
+		 * Get current date and time.
+		 * @param datetime set to current date and time
+		 */
+		void now(tm& datetime) const
+		{
+			to_tm(epoch(), datetime);
+		}
+
+		/**
+		 * Convert @p datetime to seconds elapsed since 2000-01-01 00:00:00.
+		 * @param datetime date and time, between years 2000 and 2099
+		 * @sa to_tm()
+		 */
+		static uint32_t to_epoch(const tm& datetime)
+		{
+			const uint8_t year = datetime.tm_year;
+			// All years multiple of 4 are leap years between 2000 and 2099
+			uint16_t days = 365U * year + (year + 3U) / 4U;
+			days += days_before_month(datetime.tm_mon, is_leap(year)) + datetime.tm_mday - 1U;
+			return days * ONE_DAY_S
+				+ (datetime.tm_hour * 60UL + datetime.tm_min) * 60UL + datetime.tm_sec;
+		}
+
+		/**
+		 * Convert @p epoch (seconds elapsed since 2000-01-01 00:00:00) to
+		 * a date and time.
+		 * @param epoch seconds elapsed since 2000-01-01 00:00:00, up to
+		 * 2099-12-31 23:59:59
+		 * @param datetime set to the date and time matching @p epoch
+		 * @sa to_epoch()
+		 */
+		static void to_tm(uint32_t epoch, tm& datetime)
+		{
+			uint16_t days = uint16_t(epoch / ONE_DAY_S);
+			uint32_t seconds = epoch % ONE_DAY_S;
+			datetime.tm_hour = uint8_t(seconds / 3600U);
+			const uint16_t rest = uint16_t(seconds % 3600U);
+			datetime.tm_min = uint8_t(rest / 60U);
+			datetime.tm_sec = uint8_t(rest % 60U);
+			// 2000-01-01 was a Saturday
+			datetime.tm_wday = WeekDay((days + uint8_t(WeekDay::SATURDAY) - 1U) % 7U + 1U);
+
+			// 4 years cycles start with a leap year
+			uint8_t year = uint8_t(days / DAYS_PER_4_YEARS) * 4U;
+			days %= DAYS_PER_4_YEARS;
+			if (days >= 366U)
+			{
+				days -= 366U;
+				year += 1U + days / 365U;
+				days %= 365U;
+			}
+			datetime.tm_year = year;
+			const bool leap = is_leap(year);
+			uint8_t month = 12;
+			while (days < days_before_month(month, leap)) --month;
+			datetime.tm_mon = month;
+			datetime.tm_mday = uint8_t(days - days_before_month(month, leap) + 1U);
+		}
+
+	private:
+		static constexpr const uint32_t ONE_SECOND_MS = 1000UL;
+		static constexpr const uint32_t ONE_DAY_S = 24UL * 3600UL;
+		static constexpr const uint16_t DAYS_PER_4_YEARS = 4U * 365U + 1U;
+		static constexpr const uint32_t SYNC_TIMEOUT_MS = 2000UL;
+
+		static bool is_leap(uint8_t year)
+		{
+			return (year % 4U) == 0;
+		}
+
+		// month is 1 to 12
+		static uint16_t days_before_month(uint8_t month, bool leap)
+		{
+			static const uint16_t DAYS[] PROGMEM = {0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334};
+			return pgm_read_word(&DAYS[month - 1]) + ((leap && month > 2) ? 1U : 0U);
+		}
+
+		void on_sqw()
+		{
+			ref_millis_ = rtt_.millis_();
+			++ref_epoch_;
+			++edges_;
+		}
+
+		RTC& rtc_;
+		const RTT& rtt_;
+		interrupt::INTSignal<SQW_> signal_;
+		uint32_t ref_epoch_ = 0UL;
+		uint32_t ref_millis_ = 0UL;
+		volatile uint8_t edges_ = 0;
+
+		friend struct isr_handler_ds1307_clock;
+	};
+
+	/// @cond notdocumented
+	struct isr_handler_ds1307_clock
+	{
+		template<uint8_t INT_NUM_, typename CLOCK_> static void sqw()
+		{
+			interrupt::isr_handler_int::check_int_pin<INT_NUM_, CLOCK_::SQW>();
+			interrupt::HandlerHolder<CLOCK_>::handler()->on_sqw();
+		}
+	};
+	/// @endcond
+}
+
+#endif /* DS1307_CLOCK_HH */
+/// @endcond
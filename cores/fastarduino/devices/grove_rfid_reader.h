@@ -32,6 +32,10 @@
 #include "../uart_commons.h"
 #include "wiegand.h"
 
+// <stdio.h> defines EOF as a macro, which would clash with istreambuf::EOF
+#pragma push_macro("EOF")
+#undef EOF
+
 /**
  * Register the necessary ISR (Interrupt Service Routine) for a 
  * devices::rfid::Grove125KHzRFIDReaderWiegandEXT to work correctly.
@@ -605,5 +609,7 @@ namespace devices::rfid
 	/// @endcond
 }
 
+#pragma pop_macro("EOF")
+
 #endif /* GROVE_RFID_READER_HH */
 /// @endcond
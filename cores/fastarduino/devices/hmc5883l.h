@@ -25,6 +25,7 @@
 #include <math.h>
 #include "common_magneto.h"
 #include "../bits.h"
+#include "../fixmath.h"
 #include "../functors.h"
 #include "../i2c_device.h"
 #include "../i2c_device_utilities.h"
@@ -42,6 +43,54 @@ namespace devices::magneto
 		return theta;
 	}
 
+	/**
+	 * Calculate the magnetic heading (heading measured clockwise from magnetic
+	 * north) from X and Y magnetic fields, with fixed-point math only.
+	 * This assumes the device is level.
+	 * @param x the magnetic field on X axis (raw or calibrated)
+	 * @param y the magnetic field on Y axis (raw or calibrated)
+	 * @return the heading in tenths of degrees, in range [0, 3600[
+	 * @sa tilt_compensated_heading()
+	 */
+	inline uint16_t magnetic_heading_deci_degrees(int16_t x, int16_t y)
+	{
+		const int16_t heading = fixmath::to_deci_degrees(fixmath::atan2(y, x));
+		return uint16_t(heading < 0 ? heading + 3600 : heading);
+	}
+
+	/**
+	 * Calculate the magnetic heading (heading measured clockwise from magnetic
+	 * north) from magnetic fields, compensated for device tilt as measured by
+	 * an accelerometer, with fixed-point math only.
+	 *
+	 * The horizontal plane is computed from the gravity vector measured by the
+	 * accelerometer, which must hence be at rest (or moving at constant speed);
+	 * accelerometer and magnetometer axes must be aligned (e.g. GY-86 modules
+	 * combining HMC5883L and MPU6050 chips).
+	 *
+	 * @param fields the magnetic fields (raw or calibrated)
+	 * @param accel the raw accelerometer measurements
+	 * @return the heading of device X axis in tenths of degrees, in range [0, 3600[
+	 * @sa magnetic_heading_deci_degrees()
+	 */
+	inline uint16_t tilt_compensated_heading(const Sensor3D& fields, const Sensor3D& accel)
+	{
+		const int32_t inverse = fixmath::inverse_norm(accel.x, accel.y, accel.z);
+		if (inverse == 0) return magnetic_heading_deci_degrees(fields.x, fields.y);
+		// Down direction, as a Q15 unit vector (accelerometer at rest measures upwards)
+		const int16_t dx = fixmath::saturate_q15(-((accel.x * inverse) >> 15));
+		const int16_t dy = fixmath::saturate_q15(-((accel.y * inverse) >> 15));
+		const int16_t dz = fixmath::saturate_q15(-((accel.z * inverse) >> 15));
+		// East = Down x Field, North = East x Down (only X components are needed)
+		// East is scaled by 4 to keep precision (fields are 12 bits at most)
+		const int16_t ex = int16_t((int32_t(dy) * fields.z - int32_t(dz) * fields.y) >> 13);
+		const int16_t ey = int16_t((int32_t(dz) * fields.x - int32_t(dx) * fields.z) >> 13);
+		const int16_t ez = int16_t((int32_t(dx) * fields.y - int32_t(dy) * fields.x) >> 13);
+		const int16_t nx = int16_t((int32_t(ey) * dz - int32_t(ez) * dy) >> 15);
+		const int16_t heading = fixmath::to_deci_degrees(fixmath::atan2(ex, nx));
+		return uint16_t(heading < 0 ? heading + 3600 : heading);
+	}
+
 	/**
 	 * The number of samples to average every time a measurement is required from
 	 * the HMC5883L chip (datasheet p12).
@@ -0,0 +1,250 @@
+//   Copyright 2016-2023 Jean-Francois Poilpret
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+/// @cond api
+
+/**
+ * @file
+ * API to calibrate magnetometers (e.g. HMC5883L) against hard-iron and
+ * soft-iron distortions, and store calibration to EEPROM.
+ */
+#ifndef MAGNETO_CALIBRATION_H
+#define MAGNETO_CALIBRATION_H
+
+#include "common_magneto.h"
+#include "../eeprom.h"
+
+namespace devices::magneto
+{
+	/**
+	 * Calibration of a 3-axis magnetometer, as computed by `MagnetoCalibrator`.
+	 * Calibration is applied to raw magnetic fields with `apply()`:
+	 * - hard-iron distortion (constant magnetic fields of the device itself)
+	 * is compensated by subtracting `offset` from raw fields
+	 * - soft-iron distortion (magnetic field deformation by the device) is
+	 * approximated by an ellipsoid aligned on device axes, which is brought
+	 * back to a sphere by multiplying each axis by `scale`
+	 *
+	 * This structure can be stored as is in EEPROM, with `save()` and `load()`.
+	 * @sa MagnetoCalibrator
+	 */
+	struct MagnetoCalibration
+	{
+		/** The value of `scale` for a factor of 1.0 (Q12 fixed-point). */
+		static constexpr const int16_t SCALE_ONE = 4096;
+
+		/** Hard-iron offset of each axis. */
+		Sensor3D offset = Sensor3D{0, 0, 0};
+		/** Soft-iron scale factor of each axis, as Q12 fixed-point values. */
+		Sensor3D scale = Sensor3D{SCALE_ONE, SCALE_ONE, SCALE_ONE};
+		/** Checksum used to check validity of calibration read from EEPROM. */
+		uint8_t checksum = 0;
+
+		/**
+		 * Apply this calibration to magnetic @p fields.
+		 * @param fields the raw fields, which will be replaced by calibrated fields
+		 */
+		void apply(Sensor3D& fields) const
+		{
+			fields.x = apply(fields.x, offset.x, scale.x);
+			fields.y = apply(fields.y, offset.y, scale.y);
+			fields.z = apply(fields.z, offset.z, scale.z);
+		}
+
+		/**
+		 * Read calibration from EEPROM at @p address.
+		 * If the content of EEPROM is invalid (e.g. EEPROM was never written),
+		 * this calibration is left unchanged.
+		 * @param address the location of calibration in EEPROM, typically
+		 * obtained as `&variable` where `variable` was declared with `EEMEM`
+		 * @retval true if a valid calibration was read
+		 * @retval false if EEPROM content was invalid or @p address was outside
+		 * EEPROM bounds
+		 */
+		bool load(const MagnetoCalibration* address)
+		{
+			MagnetoCalibration calibration;
+			if (!eeprom::EEPROM::read(address, calibration)) return false;
+			if (calibration.checksum != calibration.compute_checksum()) return false;
+			*this = calibration;
+			return true;
+		}
+
+		/**
+		 * Write this calibration to EEPROM at @p address.
+		 * @param address the location of calibration in EEPROM, typically
+		 * obtained as `&variable` where `variable` was declared with `EEMEM`
+		 * @retval true if the calibration was written
+		 * @retval false if @p address was outside EEPROM bounds
+		 */
+		bool save(const MagnetoCalibration* address)
+		{
+			checksum = compute_checksum();
+			return eeprom::EEPROM::write(address, *this);
+		}
+
+	private:
+		static int16_t apply(int16_t value, int16_t offset, int16_t scale)
+		{
+			return int16_t(((int32_t(value) - offset) * scale) / SCALE_ONE);
+		}
+
+		uint8_t compute_checksum() const
+		{
+			// Never matches erased (all 0xFF) or blank (all 0x00) EEPROM
+			const uint8_t* content = reinterpret_cast<const uint8_t*>(this);
+			uint8_t sum = 0;
+			for (uint8_t i = 0; i < sizeof(Sensor3D) * 2; ++i) sum += content[i];
+			return sum ^ 0xA5;
+		}
+	};
+
+	/**
+	 * Online calibration of a 3-axis magnetometer, based on minimum and maximum
+	 * magnetic fields measured on each axis.
+	 *
+	 * During calibration, the device must be rotated in all directions while its
+	 * magnetic fields are continuously measured and passed to `add()`. Once
+	 * enough samples have been accumulated, `compute()` produces the
+	 * `MagnetoCalibration` to be used by the program and saved to EEPROM:
+	 * @code
+	 * static devices::magneto::MagnetoCalibration calibration_eeprom EEMEM;
+	 * ...
+	 * devices::magneto::MagnetoCalibrator calibrator;
+	 * // Rotate device in all directions for a few seconds
+	 * while (...) {
+	 *     compass.magnetic_fields(fields);
+	 *     calibrator.add(fields);
+	 * }
+	 * devices::magneto::MagnetoCalibration calibration;
+	 * if (calibrator.compute(calibration))
+	 *     calibration.save(&calibration_eeprom);
+	 * @endcode
+	 *
+	 * @sa MagnetoCalibration
+	 */
+	class MagnetoCalibrator
+	{
+	public:
+		/**
+		 * Raw value output by HMC5883L chip when the magnetic field on an axis
+		 * overflows the range of the selected `Gain`. Samples containing this
+		 * value are ignored.
+		 */
+		static constexpr const int16_t OVERFLOW_VALUE = -4096;
+
+		/// @cond notdocumented
+		MagnetoCalibrator(const MagnetoCalibrator&) = delete;
+		MagnetoCalibrator& operator=(const MagnetoCalibrator&) = delete;
+		/// @endcond
+
+		/**
+		 * Create a new calibrator, with no samples.
+		 */
+		MagnetoCalibrator()
+		{
+			reset();
+		}
+
+		/**
+		 * Clear all samples accumulated so far.
+		 */
+		void reset()
+		{
+			min_ = Sensor3D{INT16_MAX, INT16_MAX, INT16_MAX};
+			max_ = Sensor3D{INT16_MIN, INT16_MIN, INT16_MIN};
+			samples_ = 0;
+		}
+
+		/**
+		 * Accumulate one sample of raw magnetic fields.
+		 * @retval true if the sample was used
+		 * @retval false if the sample was ignored, due to overflow on one axis
+		 */
+		bool add(const Sensor3D& fields)
+		{
+			if (fields.x == OVERFLOW_VALUE || fields.y == OVERFLOW_VALUE || fields.z == OVERFLOW_VALUE) return false;
+			update(min_.x, max_.x, fields.x);
+			update(min_.y, max_.y, fields.y);
+			update(min_.z, max_.z, fields.z);
+			if (samples_ != UINT16_MAX) ++samples_;
+			return true;
+		}
+
+		/**
+		 * The number of samples accumulated so far.
+		 */
+		uint16_t samples() const
+		{
+			return samples_;
+		}
+
+		/**
+		 * The range (difference between maximum and minimum) of samples
+		 * accumulated so far, for each axis. This can be used to check that the
+		 * device has been rotated enough in all directions.
+		 */
+		Sensor3D span() const
+		{
+			if (samples_ == 0) return Sensor3D{0, 0, 0};
+			return Sensor3D{
+				int16_t(max_.x - min_.x), int16_t(max_.y - min_.y), int16_t(max_.z - min_.z)};
+		}
+
+		/**
+		 * Compute the calibration from all samples accumulated so far.
+		 * @param calibration the calibration to compute; it is left unchanged
+		 * if there are not enough samples
+		 * @param min_span the minimum range of samples required on each axis
+		 * @retval true if @p calibration was computed
+		 * @retval false if the range of samples on one axis is lower than
+		 * @p min_span
+		 */
+		bool compute(MagnetoCalibration& calibration, int16_t min_span = 100) const
+		{
+			const Sensor3D range = span();
+			if (range.x < min_span || range.y < min_span || range.z < min_span) return false;
+			calibration.offset = Sensor3D{
+				center(min_.x, max_.x), center(min_.y, max_.y), center(min_.z, max_.z)};
+			const int32_t average = (int32_t(range.x) + range.y + range.z) / 3;
+			calibration.scale = Sensor3D{
+				scale(average, range.x), scale(average, range.y), scale(average, range.z)};
+			return true;
+		}
+
+	private:
+		static void update(int16_t& min, int16_t& max, int16_t value)
+		{
+			if (value < min) min = value;
+			if (value > max) max = value;
+		}
+
+		static int16_t center(int16_t min, int16_t max)
+		{
+			return int16_t((int32_t(min) + max) / 2);
+		}
+
+		static int16_t scale(int32_t average, int16_t range)
+		{
+			return int16_t((average * MagnetoCalibration::SCALE_ONE + range / 2) / range);
+		}
+
+		Sensor3D min_;
+		Sensor3D max_;
+		uint16_t samples_;
+	};
+}
+
+#endif /* MAGNETO_CALIBRATION_H */
+/// @endcond
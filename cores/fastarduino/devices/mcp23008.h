@@ -273,6 +273,8 @@ namespace devices::mcp230xx
 		 */
 		int values(SetValuesFuture& future)
 		{
+			// Output latch shadow cannot follow asynchronous writes
+			latch_valid_ = false;
 			return this->async_write(future);
 		}
 
@@ -378,6 +380,45 @@ namespace devices::mcp230xx
 			return this->async_read(future);
 		}
 
+		/**
+		 * Create a future to be used by asynchronous method 
+		 * interrupt_snapshot(InterruptSnapshotFuture&).
+		 * This is used by `interrupt_snapshot()` to asynchronously launch the I2C 
+		 * transaction, and it shall be used by the caller to determine when the I2C
+		 * transaction is finished.
+		 * 
+		 * This future reads INTF, INTCAP and GPIO registers in one sequential read.
+		 * 
+		 * @sa interrupt_snapshot(InterruptSnapshotFuture&)
+		 */
+		using InterruptSnapshotFuture = TReadRegisterFuture<INTF, InterruptSnapshot<uint8_t>>;
+
+		/**
+		 * Get, in one I2C transaction, the pins that generated the latest interrupt,
+		 * their levels captured at interrupt time and their current levels, on
+		 * the port of the MCP23008 chip.
+		 * This replaces successive calls to `interrupt_flags()`, `captured_values()`
+		 * and `values()`.
+		 * @warning Asynchronous API!
+		 * 
+		 * @param future an `InterruptSnapshotFuture` passed by the caller, that will be 
+		 * updated once the current I2C action is finished.
+		 * @retval 0 if no problem occurred during the preparation of I2C transaction
+		 * @return an error code if something bad happened; for an asynchronous
+		 * I2C Manager, this typically happens when its queue of I2CCommand is full;
+		 * for a synchronous I2C Manager, any error on the I2C bus or on the 
+		 * target device will trigger an error here. the list of possible errors
+		 * is in namespace `errors`.
+		 * 
+		 * @sa InterruptSnapshotFuture
+		 * @sa InterruptSnapshot<uint8_t> interrupt_snapshot()
+		 * @sa errors
+		 */
+		int interrupt_snapshot(InterruptSnapshotFuture& future)
+		{
+			return this->async_read(future);
+		}
+
 		// Synchronous API
 		//=================
 		/**
@@ -446,6 +487,8 @@ namespace devices::mcp230xx
 
 		/**
 		 * Set output levels of output pins on the port of this MCP23008 chip.
+		 * The last value written is cached, hence no I2C transaction occurs
+		 * if @p value is the same as the current content of the output latch.
 		 * @warning Blocking API!
 		 * 
 		 * @param value each bit indicates the new level of the matching output pin
@@ -457,7 +500,11 @@ namespace devices::mcp230xx
 		 */
 		bool values(uint8_t value)
 		{
-			return this->template sync_write<SetValuesFuture>(value);
+			// Skip I2C transaction if output latch already holds the same value
+			if (latch_valid_ && latch_ == value) return true;
+			latch_valid_ = this->template sync_write<SetValuesFuture>(value);
+			latch_ = value;
+			return latch_valid_;
 		}
 
 		/**
@@ -506,6 +553,35 @@ namespace devices::mcp230xx
 			return get_value<CapturedValuesFuture>();
 		}
 
+		/**
+		 * Get, in one I2C transaction, the pins that generated the latest interrupt,
+		 * their levels captured at interrupt time and their current levels, on
+		 * the port of the MCP23008 chip.
+		 * Note that reading captured values clears the interrupt condition.
+		 * @warning Blocking API!
+		 * 
+		 * @return the snapshot of interrupt flags, captured values and current 
+		 * values; all fields are `0` if the I2C transaction failed.
+		 * 
+		 * @sa interrupt_snapshot(InterruptSnapshotFuture&)
+		 */
+		InterruptSnapshot<uint8_t> interrupt_snapshot()
+		{
+			InterruptSnapshot<uint8_t> snapshot{};
+			this->template sync_read<InterruptSnapshotFuture>(snapshot);
+			return snapshot;
+		}
+
+		/**
+		 * Invalidate the cache of output latch value, used by `values(uint8_t)`.
+		 * This must be called if the chip output latch may have been modified
+		 * outside of this driver, e.g. after a chip reset.
+		 */
+		void invalidate_values_cache()
+		{
+			latch_valid_ = false;
+		}
+
 	private:
 		template<typename F> uint8_t get_value()
 		{
@@ -518,6 +594,10 @@ namespace devices::mcp230xx
 		{
 			return this->write(byte_count, false, true);
 		}
+
+		// Shadow of OLAT register
+		uint8_t latch_ = 0;
+		bool latch_valid_ = false;
 	};
 }
 
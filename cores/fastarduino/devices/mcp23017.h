@@ -57,38 +57,79 @@ namespace devices::mcp230xx
 		template<MCP23017Port PORT_> struct Port_trait
 		{
 			using TYPE = uint8_t;
+			static constexpr uint16_t MASK = 0x00FF;
 			static constexpr uint8_t shift(uint8_t reg)
 			{
 				return reg;
 			}
+			static constexpr uint16_t widen(TYPE value)
+			{
+				return value;
+			}
+			static constexpr TYPE narrow(uint16_t value)
+			{
+				return TYPE(value);
+			}
 		};
 
 		template<> struct Port_trait<MCP23017Port::PORT_A>
 		{
 			using TYPE = uint8_t;
+			static constexpr uint16_t MASK = 0x00FF;
 			static constexpr uint8_t shift(uint8_t reg)
 			{
 				return reg;
 			}
+			static constexpr uint16_t widen(TYPE value)
+			{
+				return value;
+			}
+			static constexpr TYPE narrow(uint16_t value)
+			{
+				return TYPE(value);
+			}
 		};
 
 		template<> struct Port_trait<MCP23017Port::PORT_B>
 		{
 			using TYPE = uint8_t;
+			static constexpr uint16_t MASK = 0xFF00;
 			static constexpr uint8_t shift(uint8_t reg)
 			{
 				return reg + 1;
 			}
+			static constexpr uint16_t widen(TYPE value)
+			{
+				return uint16_t(value << 8);
+			}
+			static constexpr TYPE narrow(uint16_t value)
+			{
+				return TYPE(value >> 8);
+			}
 		};
 
 		template<> struct Port_trait<MCP23017Port::PORT_AB>
 		{
 			using TYPE = uint16_t;
+			static constexpr uint16_t MASK = 0xFFFF;
 			static constexpr uint8_t shift(uint8_t reg)
 			{
 				return reg;
 			}
+			static constexpr uint16_t widen(TYPE value)
+			{
+				return value;
+			}
+			static constexpr TYPE narrow(uint16_t value)
+			{
+				return value;
+			}
 		};
+
+		// Registers shadowed by the driver (BANK 0 mode): all configuration registers
+		// and output latches; INTF, INTCAP and GPIO are changed by the chip itself,
+		// 0x0B is IOCON again (changed by writing IOCON at 0x0A)
+		using REGISTER_MAP = i2c::RegisterMap<0x00, 0x16, 0x0B, 0x0E, 0x0F, 0x10, 0x11, 0x12, 0x13>;
 	}
 	/// @endcond
 
@@ -96,13 +137,18 @@ namespace devices::mcp230xx
 	 * I2C device driver for Microchip MCP23017 support.
 	 * The MCP23017 chip is a 16-Bit I/O Expander with I2C interface.
 	 * 
+	 * This driver keeps a shadow of the chip configuration registers and output
+	 * latches, hence writing them with their current value does not generate
+	 * any I2C transaction.
+	 * 
 	 * @tparam MANAGER one of FastArduino available I2C Manager
+	 * @sa i2c::CachedI2CDevice
 	 */
 	template<typename MANAGER>
-	class MCP23017 : public i2c::I2CDevice<MANAGER>
+	class MCP23017 : public i2c::CachedI2CDevice<MANAGER, mcp23017_traits::REGISTER_MAP>
 	{
 	private:
-		using PARENT = i2c::I2CDevice<MANAGER>;
+		using PARENT = i2c::CachedI2CDevice<MANAGER, mcp23017_traits::REGISTER_MAP>;
 		template<typename OUT, typename IN> using FUTURE = typename PARENT::template FUTURE<OUT, IN>;
 
 		template<MCP23017Port P> using TRAIT = mcp23017_traits::Port_trait<P>;
@@ -112,7 +158,7 @@ namespace devices::mcp230xx
 		template<MCP23017Port P, uint8_t REGISTER>
 		using TReadRegisterFuture = i2c::TReadRegisterFuture<MANAGER, TRAIT<P>::shift(REGISTER), T<P>>;
 		template<MCP23017Port P, uint8_t REGISTER>
-		using TWriteRegisterFuture = i2c::TWriteRegisterFuture<MANAGER, TRAIT<P>::shift(REGISTER), T<P>>;
+		using TCachedWriteRegisterFuture = i2c::TCachedWriteRegisterFuture<MANAGER, TRAIT<P>::shift(REGISTER), T<P>>;
 		template<MCP23017Port P, uint8_t... REGISTERS>
 		using TWriteMultiRegisterFuture = i2c::TWriteMultiRegisterFuture<MANAGER, T<P>, TRAIT<P>::shift(REGISTERS)...>;
 
@@ -189,9 +235,9 @@ namespace devices::mcp230xx
 		 * 
 		 * @sa begin(BeginFuture&)
 		 */
-		class BeginFuture : public TWriteRegisterFuture<MCP23017Port::PORT_A, IOCON>
+		class BeginFuture : public TCachedWriteRegisterFuture<MCP23017Port::PORT_A, IOCON>
 		{
-			using PARENT = TWriteRegisterFuture<MCP23017Port::PORT_A, IOCON>;
+			using PARENT = TCachedWriteRegisterFuture<MCP23017Port::PORT_A, IOCON>;
 		public:
 			/// @cond notdocumented
 			explicit BeginFuture(
@@ -221,7 +267,7 @@ namespace devices::mcp230xx
 		 */
 		int begin(BeginFuture& future)
 		{
-			return this->async_write(future);
+			return this->cached_async_write(future);
 		}
 
 		/**
@@ -278,6 +324,7 @@ namespace devices::mcp230xx
 		 */
 		template<MCP23017Port P_> int configure_gpio(ConfigureGPIOFuture<P_>& future)
 		{
+			invalidate_registers<P_, IODIR_A, IPOL_A, GPPU_A>();
 			return this->async_multi_write(future);
 		}
 
@@ -337,6 +384,7 @@ namespace devices::mcp230xx
 		template<MCP23017Port P_>
 		int configure_interrupts(ConfigureInterruptsFuture<P_>& future)
 		{
+			invalidate_registers<P_, GPINTEN_A, DEFVAL_A, INTCON_A>();
 			return this->async_multi_write(future);
 		}
 
@@ -352,10 +400,13 @@ namespace devices::mcp230xx
 		 * @param value each bit indicates the new level of the matching output pin
 		 * of the selected port
 		 * 
+		 * @note this future writes the output latches (OLAT), which is the same as
+		 * writing GPIO registers.
+		 * 
 		 * @sa values(SetValuesFuture<P_>&)
 		 */
 		template<MCP23017Port P_>
-		using SetValuesFuture = TWriteRegisterFuture<P_, GPIO_A>;
+		using SetValuesFuture = TCachedWriteRegisterFuture<P_, OLAT_A>;
 
 		/**
 		 * Set output levels of output pins on one or both ports of this MCP23017 chip.
@@ -380,7 +431,7 @@ namespace devices::mcp230xx
 		 */
 		template<MCP23017Port P_> int values(SetValuesFuture<P_>& future)
 		{
-			return this->async_write(future);
+			return this->cached_async_write(future);
 		}
 
 		/**
@@ -511,6 +562,46 @@ namespace devices::mcp230xx
 			return this->async_read(future);
 		}
 
+		/**
+		 * Create a future to be used by asynchronous method 
+		 * interrupt_snapshot(InterruptSnapshotFuture&).
+		 * This is used by `interrupt_snapshot()` to asynchronously launch the I2C 
+		 * transaction, and it shall be used by the caller to determine when the I2C
+		 * transaction is finished.
+		 * 
+		 * This future reads INTF, INTCAP and GPIO registers of both ports in one
+		 * sequential read; result low bytes map to port A, high bytes to port B.
+		 * 
+		 * @sa interrupt_snapshot(InterruptSnapshotFuture&)
+		 */
+		using InterruptSnapshotFuture = i2c::TReadRegisterFuture<MANAGER, INTF_A, InterruptSnapshot<uint16_t>>;
+
+		/**
+		 * Get, in one I2C transaction, the pins that generated the latest interrupt,
+		 * their levels captured at interrupt time and their current levels, for
+		 * both ports of the MCP23017 chip.
+		 * This replaces successive calls to `interrupt_flags()`, `captured_values()`
+		 * and `values()`.
+		 * @warning Asynchronous API!
+		 * 
+		 * @param future an `InterruptSnapshotFuture` passed by the caller, that will be 
+		 * updated once the current I2C action is finished.
+		 * @retval 0 if no problem occurred during the preparation of I2C transaction
+		 * @return an error code if something bad happened; for an asynchronous
+		 * I2C Manager, this typically happens when its queue of I2CCommand is full;
+		 * for a synchronous I2C Manager, any error on the I2C bus or on the 
+		 * target device will trigger an error here. the list of possible errors
+		 * is in namespace `errors`.
+		 * 
+		 * @sa InterruptSnapshotFuture
+		 * @sa InterruptSnapshot<T<P_>> interrupt_snapshot()
+		 * @sa errors
+		 */
+		int interrupt_snapshot(InterruptSnapshotFuture& future)
+		{
+			return this->async_read(future);
+		}
+
 		// Synchronous API
 		//=================
 		/**
@@ -538,6 +629,7 @@ namespace devices::mcp230xx
 
 		/**
 		 * Configure GPIO on one or both ports of this MCP23017 chip.
+		 * Only registers whose value has changed are written to the chip.
 		 * @warning Blocking API!
 		 * 
 		 * @tparam P_ which port to configure, may be A, B or both; if both, then
@@ -558,13 +650,16 @@ namespace devices::mcp230xx
 		 */
 		template<MCP23017Port P_> bool configure_gpio(T<P_> direction, T<P_> pullup = T<P_>{}, T<P_> polarity = T<P_>{})
 		{
-			ConfigureGPIOFuture<P_> future{direction, pullup, polarity};
-			if (configure_gpio(future) != 0) return false;
-			return (future.await() == future::FutureStatus::READY);
+			// Only write registers that have changed
+			this->template deferred_write<TCachedWriteRegisterFuture<P_, IODIR_A>>(direction);
+			this->template deferred_write<TCachedWriteRegisterFuture<P_, IPOL_A>>(polarity);
+			this->template deferred_write<TCachedWriteRegisterFuture<P_, GPPU_A>>(pullup);
+			return this->flush();
 		}
 
 		/**
 		 * Configure interrupts on one or both ports of this MCP23017 chip.
+		 * Only registers whose value has changed are written to the chip.
 		 * @warning Blocking API!
 		 * 
 		 * @tparam P_ which port to configure, may be A, B or both; if both, then
@@ -586,13 +681,17 @@ namespace devices::mcp230xx
 		template<MCP23017Port P_>
 		bool configure_interrupts(T<P_> int_pins, T<P_> ref = T<P_>{}, T<P_> compare_ref = T<P_>{})
 		{
-			ConfigureInterruptsFuture<P_> future{int_pins, ref, compare_ref};
-			if (configure_interrupts(future) != 0) return false;
-			return (future.await() == future::FutureStatus::READY);
+			// Only write registers that have changed
+			this->template deferred_write<TCachedWriteRegisterFuture<P_, GPINTEN_A>>(int_pins);
+			this->template deferred_write<TCachedWriteRegisterFuture<P_, DEFVAL_A>>(ref);
+			this->template deferred_write<TCachedWriteRegisterFuture<P_, INTCON_A>>(compare_ref);
+			return this->flush();
 		}
 
 		/**
 		 * Set output levels of output pins on one or both ports of this MCP23017 chip.
+		 * The last value written is cached, hence no I2C transaction occurs
+		 * if @p value is the same as the current content of the output latch.
 		 * @warning Blocking API!
 		 * 
 		 * @tparam P_ which port to write to, may be A, B or both; if both, then
@@ -607,7 +706,7 @@ namespace devices::mcp230xx
 		 */
 		template<MCP23017Port P_> bool values(T<P_> value)
 		{
-			return this->template sync_write<SetValuesFuture<P_>>(value);
+			return this->template cached_sync_write<SetValuesFuture<P_>>(value);
 		}
 
 		/**
@@ -665,6 +764,41 @@ namespace devices::mcp230xx
 			return get_value<CapturedValuesFuture<P_>, T<P_>>();
 		}
 
+		/**
+		 * Get, in one I2C transaction, the pins that generated the latest interrupt,
+		 * their levels captured at interrupt time and their current levels, for
+		 * one or both ports of the MCP23017 chip.
+		 * Note that reading captured values clears the interrupt condition.
+		 * @warning Blocking API!
+		 * 
+		 * @tparam P_ which port to read from, may be A, B or both; if both, then
+		 * all snapshot fields will be `uint16_t`, with low byte for port A,
+		 * and high byte for port B.
+		 * @return the snapshot of interrupt flags, captured values and current 
+		 * values; all fields are `0` if the I2C transaction failed.
+		 * 
+		 * @sa interrupt_snapshot(InterruptSnapshotFuture&)
+		 */
+		template<MCP23017Port P_> InterruptSnapshot<T<P_>> interrupt_snapshot()
+		{
+			using TRAIT_ = TRAIT<P_>;
+			const auto snapshot = get_value<InterruptSnapshotFuture, InterruptSnapshot<uint16_t>>();
+			return InterruptSnapshot<T<P_>>{
+				TRAIT_::narrow(snapshot.flags),
+				TRAIT_::narrow(snapshot.captured),
+				TRAIT_::narrow(snapshot.values)};
+		}
+
+		/**
+		 * Invalidate the cache of output latch values and configuration registers.
+		 * This must be called if the chip registers may have been modified
+		 * outside of this driver, e.g. after a chip reset.
+		 */
+		void invalidate_values_cache()
+		{
+			this->invalidate_cache();
+		}
+
 	private:
 		template<typename F, typename T> T get_value()
 		{
@@ -684,6 +818,12 @@ namespace devices::mcp230xx
 		{
 			return bits::ORIF8(mirror, IOCON_MIRROR, int_polarity, IOCON_INTPOL);
 		}
+
+		// Registers written by a TWriteMultiRegisterFuture are not known anymore
+		template<MCP23017Port P_, uint8_t... REGISTERS> void invalidate_registers()
+		{
+			(this->invalidate_cache(TRAIT<P_>::shift(REGISTERS), uint8_t(sizeof(T<P_>))), ...);
+		}
 	};
 }
 
@@ -53,6 +53,25 @@ namespace devices::mcp230xx
 		 */
 		ACTIVE_HIGH = 1
 	};
+
+	/**
+	 * The state of MCP23008/MCP23017 port(s) when an interrupt occurred, as read
+	 * in one single I2C transaction by `interrupt_snapshot()` API.
+	 * Its layout matches the device registers order (INTF, INTCAP, GPIO), hence
+	 * it can be directly read from the device with sequential addressing.
+	 * 
+	 * @tparam T `uint8_t` for one port, `uint16_t` for both ports of MCP23017
+	 * (low byte for port A, high byte for port B)
+	 */
+	template<typename T> struct InterruptSnapshot
+	{
+		/** Each bit indicates if the matching pin generated the interrupt. */
+		T flags;
+		/** Level of each pin, captured at the time the interrupt occurred. */
+		T captured;
+		/** Current level of each pin, at the time the snapshot was read. */
+		T values;
+	};
 }
 
 #endif /* MCP230XX_H */
@@ -100,10 +100,21 @@ namespace devices::mcp3x0x
 		 * (typically 10, 12 or 13 bits).
 		 */
 		TYPE read_channel(CHANNEL channel)
+		{
+			this->start_transfer();
+			const TYPE value = transfer_channel(channel);
+			this->end_transfer();
+			return value;
+		}
+
+	protected:
+		/// @cond notdocumented
+		// Perform the SPI exchange reading one channel, within an already
+		// started transfer; this is reused by MCP3x0xScanner
+		TYPE transfer_channel(CHANNEL channel)
 		{
 			uint8_t result1;
 			uint8_t result2;
-			this->start_transfer();
 			if (sizeof(CHANNEL) == sizeof(uint16_t))
 			{
 				this->transfer(utils::high_byte(uint16_t(channel)));
@@ -112,7 +123,6 @@ namespace devices::mcp3x0x
 			else
 				result1 = this->transfer(uint8_t(channel));
 			result2 = this->transfer(0x00);
-			this->end_transfer();
 			// Convert bytes pair to N-bits result
 			uint16_t value = (utils::as_uint16_t(result1, result2) & MASK) >> RSHIFT;
 			if (IS_SIGNED)
@@ -127,6 +137,7 @@ namespace devices::mcp3x0x
 			else
 				return value;
 		}
+		/// @endcond
 	};
 }
 
@@ -0,0 +1,251 @@
+//   Copyright 2016-2023 Jean-Francois Poilpret
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+/// @cond api
+
+/**
+ * @file
+ * API to scan several channels of SPI-based MicroChip ADC chips (MCP3001-2-4-8,
+ * MCP3201-2-4-8, MCP3301-2-4) at a fixed rate, from a timer ISR.
+ */
+#ifndef MCP3X0X_SCANNER_HH
+#define MCP3X0X_SCANNER_HH
+
+#include "mcp3x0x.h"
+#include "../interrupts.h"
+#include "../realtime_timer.h"
+#include "../timer.h"
+#include "../utilities.h"
+
+/**
+ * Register the necessary ISR (Interrupt Service Routine) for a
+ * `devices::mcp3x0x::MCP3x0xScanner` to work properly.
+ * @param TIMER_NUM the number of the TIMER feature for the target MCU, used by
+ * @p SCANNER to trigger scans
+ * @param SCANNER the `devices::mcp3x0x::MCP3x0xScanner` type used
+ *
+ * @sa devices::mcp3x0x::MCP3x0xScanner
+ */
+#define REGISTER_MCP3X0X_SCANNER_ISR(TIMER_NUM, SCANNER)                     \
+	ISR(CAT3(TIMER, TIMER_NUM, _COMPA_vect))                                 \
+	{                                                                        \
+		devices::mcp3x0x::isr_handler_scanner::scan<TIMER_NUM, SCANNER>();   \
+	}
+
+namespace devices::mcp3x0x
+{
+	/// @cond notdocumented
+	struct isr_handler_scanner;
+	/// @endcond
+
+	/**
+	 * Scanning of a list of channels of an MCP3x0x ADC chip, at a fixed rate
+	 * driven by a timer.
+	 *
+	 * At every timer tick, all configured channels are sampled in a row from
+	 * the timer ISR, and stored, along with a timestamp taken from a
+	 * `timer::RTT`, into a double buffer: one buffer is filled by the ISR while
+	 * the other holds the last complete scan, which can be obtained by the
+	 * program with `get()`.
+	 *
+	 * Each scan configures SPI only once (first channel), then only toggles
+	 * the chip CS pin between channels, as MCP3x0x chips need CS to be
+	 * deactivated between successive conversions.
+	 *
+	 * For an MCP3208 with 8 channels and a 16MHz MCU (2MHz SPI clock), one scan
+	 * takes about 110us.
+	 *
+	 * @code
+	 * using MCP = devices::mcp3x0x::MCP3208<board::DigitalPin::D10_PB2>;
+	 * using SCANNER = devices::mcp3x0x::MCP3x0xScanner<MCP, 8, board::Timer::TIMER2, 1000, board::Timer::TIMER0>;
+	 * REGISTER_MCP3X0X_SCANNER_ISR(2, SCANNER)
+	 * REGISTER_RTT_ISR(0)
+	 * ...
+	 * timer::RTT<board::Timer::TIMER0> rtt;
+	 * rtt.begin();
+	 * SCANNER scanner{rtt};
+	 * static const MCP::CHANNEL CHANNELS[] = {MCP3208Channel::CH0, MCP3208Channel::CH1, ...};
+	 * scanner.begin(CHANNELS);
+	 * SCANNER::SCAN scan;
+	 * while (true)
+	 *     if (scanner.get(scan))
+	 *         ...
+	 * @endcode
+	 *
+	 * @warning As the SPI bus is used from an ISR, other SPI devices on the
+	 * same bus must not be used while the scanner is running, unless accesses
+	 * to these devices are performed with interrupts disabled or with the
+	 * scanner suspended (`end()`).
+	 *
+	 * @tparam MCP_ the MCP3x0x device type (e.g. `MCP3208<CS>`)
+	 * @tparam MAX_CHANNELS_ the maximum number of channels in one scan
+	 * @tparam NTIMER_ the timer used to trigger scans
+	 * @tparam PERIOD_US_ the period between 2 scans, in microseconds
+	 * @tparam NRTT_ the timer used by the `timer::RTT` providing timestamps
+	 *
+	 * @sa REGISTER_MCP3X0X_SCANNER_ISR()
+	 */
+	template<typename MCP_, uint8_t MAX_CHANNELS_, board::Timer NTIMER_, uint32_t PERIOD_US_, board::Timer NRTT_>
+	class MCP3x0xScanner : public MCP_
+	{
+		static_assert(MAX_CHANNELS_ > 0, "MAX_CHANNELS_ must be at least 1");
+
+		using CALCULATOR = timer::Calculator<NTIMER_>;
+		using PRESCALER = typename CALCULATOR::PRESCALER;
+		using TIMER_TYPE = typename CALCULATOR::TYPE;
+		static constexpr const PRESCALER PRESCALER_ = CALCULATOR::CTC_prescaler(PERIOD_US_);
+		static constexpr const TIMER_TYPE COUNTER_ = CALCULATOR::CTC_counter(PRESCALER_, PERIOD_US_);
+		static_assert(CALCULATOR::is_adequate_for_CTC(PRESCALER_, PERIOD_US_),
+			"PERIOD_US_ is not adequate for NTIMER_");
+
+	public:
+		/** The timer used to trigger scans. */
+		static constexpr const board::Timer NTIMER = NTIMER_;
+		/** The maximum number of channels in one scan. */
+		static constexpr const uint8_t MAX_CHANNELS = MAX_CHANNELS_;
+		/** The type of channels of the MCP3x0x device. */
+		using CHANNEL = typename MCP_::CHANNEL;
+		/** The type of analog values of the MCP3x0x device. */
+		using TYPE = typename MCP_::TYPE;
+		/** The type of RTT used for timestamps. */
+		using RTT = timer::RTT<NRTT_>;
+
+		/**
+		 * The result of one scan of all channels.
+		 */
+		struct SCAN
+		{
+			/**
+			 * The time at which the scan started; use `time.as_real_time()`
+			 * to convert it to a `time::RTTTime`.
+			 */
+			typename RTT::RAW_TIME time = RTT::RAW_TIME::EMPTY_TIME;
+			/**
+			 * The analog values read for each channel, in the order of the
+			 * list of channels passed to `begin()`.
+			 */
+			TYPE values[MAX_CHANNELS_] = {};
+		};
+
+		/**
+		 * Create a new scanner for an MCP3x0x device.
+		 * @param rtt the RTT used to timestamp each scan; it must have been
+		 * started for timestamps to be meaningful.
+		 */
+		explicit MCP3x0xScanner(const RTT& rtt)
+			:	rtt_{rtt}, timer_{timer::TimerMode::CTC, PRESCALER_, timer::TimerInterrupt::OUTPUT_COMPARE_A}
+		{
+			interrupt::register_handler(*this);
+		}
+
+		/**
+		 * Start scanning the given list of @p channels at a fixed rate.
+		 * @param channels the list of channels to scan; it is copied
+		 *
+		 * @sa end()
+		 */
+		template<uint8_t N> void begin(const CHANNEL (&channels)[N])
+		{
+			static_assert(N <= MAX_CHANNELS_, "Too many channels for this MCP3x0xScanner");
+			synchronized
+			{
+				for (uint8_t i = 0; i < N; ++i) channels_[i] = channels[i];
+				count_ = N;
+				ready_ = false;
+				overruns_ = 0;
+			}
+			timer_.begin(COUNTER_);
+		}
+
+		/**
+		 * Stop scanning.
+		 * @sa begin()
+		 */
+		void end()
+		{
+			timer_.end();
+		}
+
+		/**
+		 * Get the last complete scan, if not already got.
+		 * @param scan the scan to fill
+		 * @retval true if @p scan was filled with a new scan
+		 * @retval false if no new scan is available since last call
+		 */
+		bool get(SCAN& scan)
+		{
+			synchronized
+			{
+				if (!ready_) return false;
+				scan = scans_[1 - current_];
+				ready_ = false;
+			}
+			return true;
+		}
+
+		/**
+		 * The number of complete scans that were lost, because `get()` was not
+		 * called soon enough, since `begin()` was called.
+		 */
+		uint16_t overruns() const
+		{
+			synchronized return overruns_;
+		}
+
+	private:
+		void on_timer()
+		{
+			SCAN& scan = scans_[current_];
+			scan.time = rtt_.raw_time_();
+			// Configure SPI once, then only toggle CS between conversions
+			this->start_transfer();
+			for (uint8_t i = 0; i < count_; ++i)
+			{
+				if (i) this->restart_transfer();
+				scan.values[i] = this->transfer_channel(channels_[i]);
+				this->end_transfer();
+			}
+			if (ready_ && overruns_ != UINT16_MAX) ++overruns_;
+			current_ = 1 - current_;
+			ready_ = true;
+		}
+
+		const RTT& rtt_;
+		timer::Timer<NTIMER_> timer_;
+		CHANNEL channels_[MAX_CHANNELS_];
+		uint8_t count_ = 0;
+
+		SCAN scans_[2];
+		volatile uint8_t current_ = 0;
+		volatile bool ready_ = false;
+		uint16_t overruns_ = 0;
+
+		friend struct isr_handler_scanner;
+	};
+
+	/// @cond notdocumented
+	struct isr_handler_scanner
+	{
+		template<uint8_t TIMER_NUM_, typename SCANNER_> static void scan()
+		{
+			static constexpr board::Timer NTIMER = timer::isr_handler::check_timer<TIMER_NUM_>();
+			static_assert(NTIMER == SCANNER_::NTIMER, "TIMER_NUM must match SCANNER timer");
+			interrupt::HandlerHolder<SCANNER_>::handler()->on_timer();
+		}
+	};
+	/// @endcond
+}
+
+#endif /* MCP3X0X_SCANNER_HH */
+/// @endcond
@@ -840,6 +840,95 @@ namespace devices::magneto
 			return this->async_read(future);
 		}
 
+		/**
+		 * Future to be used by asynchronous method fifo_read(FifoReadFuture&).
+		 * Contrarily to other futures, this future does not hold its own output
+		 * value but reads FIFO content directly into a caller buffer, set by
+		 * `reset_()` before each use; this allows reading several samples at once,
+		 * e.g. into a ring buffer.
+		 * 
+		 * Note that samples are read as is from the FIFO buffer, i.e. in 
+		 * big-endian order; they must be converted with 
+		 * `fifo_change_endianness()` before use.
+		 * 
+		 * @sa fifo_read(FifoReadFuture&)
+		 */
+		class FifoReadFuture : public PARENT::ABSTRACT_FUTURE
+		{
+			using ABSTRACT_FUTURE = typename PARENT::ABSTRACT_FUTURE;
+
+		public:
+			/**
+			 * Create a FifoReadFuture; `reset_()` must be called before it is 
+			 * passed to `fifo_read()`.
+			 * @param notification determines if and which notifications should be
+			 * dispatched by this future; default is none.
+			 */
+			explicit FifoReadFuture(future::FutureNotification notification = future::FutureNotification::NONE)
+				: ABSTRACT_FUTURE{nullptr, 0, &register_, 1, notification} {}
+
+			/**
+			 * Prepare this future to read @p size bytes from the FIFO buffer 
+			 * to @p buffer.
+			 * @param buffer the buffer that will receive FIFO content
+			 * @param size the number of bytes to read; this should be a multiple
+			 * of the size of one FIFO sample, and must not exceed 255.
+			 */
+			void reset_(uint8_t* buffer, uint8_t size)
+			{
+				register_ = FIFO_R_W;
+				ABSTRACT_FUTURE::reset_(buffer, size, &register_, 1);
+			}
+
+		private:
+			uint8_t register_ = FIFO_R_W;
+		};
+
+		/**
+		 * Get several samples at once out of the FIFO buffer (register map §4.31),
+		 * in one I2C transaction.
+		 * @warning You should first call `fifo_count()` to ensure the MPU6050
+		 * FIFO queue contains enough samples! Otherwise this method will not 
+		 * return any error but set arbitrary values to the future buffer!
+		 * @warning Asynchronous API!
+		 * 
+		 * @param future a `FifoReadFuture` passed by the caller, that will be 
+		 * updated once the current I2C action is finished.
+		 * @retval 0 if no problem occurred during the preparation of I2C transaction
+		 * @return an error code if something bad happened; for an asynchronous
+		 * I2C Manager, this typically happens when its queue of I2CCommand is full;
+		 * for a synchronous I2C Manager, any error on the I2C bus or on the 
+		 * target device will trigger an error here. the list of possible errors
+		 * is in namespace `errors`.
+		 * 
+		 * @sa fifo_count()
+		 * @sa fifo_read(T*, uint8_t)
+		 * @sa fifo_change_endianness()
+		 * @sa errors
+		 */
+		int fifo_read(FifoReadFuture& future)
+		{
+			return this->async_read(future);
+		}
+
+		/**
+		 * Convert, in place, samples read with `fifo_read(FifoReadFuture&)` from
+		 * the device big-endian order to MCU order.
+		 * All samples types (`Sensor3D`, `int16_t`, `AllSensors`...) are made of
+		 * 16-bit integers, hence this conversion needs not know the actual type
+		 * of samples.
+		 * 
+		 * @param buffer the buffer containing samples
+		 * @param size the size of @p buffer in bytes
+		 */
+		static void fifo_change_endianness(uint8_t* buffer, uint16_t size)
+		{
+			int16_t* ptr = reinterpret_cast<int16_t*>(buffer);
+			int16_t* last = ptr + size / sizeof(int16_t);
+			while (ptr < last)
+				utils::swap_bytes(*ptr++);
+		}
+
 		/**
 		 * Create a future to be used by asynchronous method fifo_push(FifoPushFuture&).
 		 * This is used by `fifo_push(FifoPushFuture&)` to asynchronously launch the 
@@ -1123,6 +1212,40 @@ namespace devices::magneto
 			return this->template sync_read<FifoPopFuture<T>>(output);
 		}
 
+		/**
+		 * Get all available samples, up to @p count, out of the FIFO buffer 
+		 * (register map §4.31). This is performed with only 2 I2C transactions,
+		 * one to read FIFO count, another to read all samples at once.
+		 * @warning Blocking API!
+		 * 
+		 * @tparam T the type of samples to get from the FIFO buffer; must be one
+		 * of `Sensor3D`, `int16_t` or `AllSensors`, based on the sensor samples
+		 * selected by `FIFOEnable` in
+		 * `begin(FIFOEnable, INTEnable, uint8_t, GyroRange, AccelRange, DLPF, ClockSelect)`.
+		 * @param output an array of at least @p count `T`-type samples that will
+		 * be filled with samples read from the FIFO buffer
+		 * @param count the maximum number of samples to read
+		 * @return the number of samples actually read into @p output
+		 * @retval 0 if the FIFO buffer is empty or if the operation failed
+		 * 
+		 * @sa fifo_count()
+		 * @sa fifo_read(FifoReadFuture&)
+		 */
+		template<typename T> uint8_t fifo_read(T* output, uint8_t count)
+		{
+			constexpr uint8_t MAX_COUNT = UINT8_MAX / sizeof(T);
+			const uint16_t available = fifo_count() / sizeof(T);
+			if (count > available) count = available;
+			if (count > MAX_COUNT) count = MAX_COUNT;
+			if (count == 0) return 0;
+			FifoReadFuture future;
+			future.reset_(reinterpret_cast<uint8_t*>(output), count * sizeof(T));
+			if (fifo_read(future) != 0) return 0;
+			if (future.await() != future::FutureStatus::READY) return 0;
+			fifo_change_endianness(reinterpret_cast<uint8_t*>(output), count * sizeof(T));
+			return count;
+		}
+
 		/**
 		 * Push one byte to the FIFO buffer (register map §4.31).
 		 * @warning Blocking API!
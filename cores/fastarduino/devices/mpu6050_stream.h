@@ -0,0 +1,321 @@
+//   Copyright 2016-2023 Jean-Francois Poilpret
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+/// @cond api
+
+/**
+ * @file
+ * API to continuously stream MPU6050 FIFO samples to a ring buffer, driven by
+ * MPU6050 INT pin and asynchronous I2C transactions.
+ */
+#ifndef MPU6050_STREAM_H
+#define MPU6050_STREAM_H
+
+#include "mpu6050.h"
+#include "../future.h"
+#include "../int.h"
+#include "../interrupts.h"
+#include "../utilities.h"
+
+/**
+ * Register the necessary ISR (Interrupt Service Routine) for the INT pin
+ * of an MPU6050 used by a `devices::magneto::MPU6050FifoStream`.
+ * @param INT_NUM the number of the `INT` vector for the `board::ExternalInterruptPin`
+ * connected to the MPU6050 INT pin
+ * @param STREAM the `devices::magneto::MPU6050FifoStream` type used
+ *
+ * @sa devices::magneto::MPU6050FifoStream
+ */
+#define REGISTER_MPU6050_FIFO_STREAM_ISR(INT_NUM, STREAM)                         \
+	ISR(CAT3(INT, INT_NUM, _vect))                                                \
+	{                                                                             \
+		devices::magneto::isr_handler_mpu6050::fifo_stream<INT_NUM, STREAM>();    \
+	}
+
+namespace devices::magneto
+{
+	/// @cond notdocumented
+	struct isr_handler_mpu6050;
+	/// @endcond
+
+	/**
+	 * Continuous streaming of MPU6050 FIFO samples into a ring buffer.
+	 *
+	 * Every time MPU6050 INT pin is triggered (typically when new data is
+	 * ready, as set by `INTEnable` in `MPU6050::begin(FIFOEnable, INTEnable, ...)`),
+	 * this class reads FIFO count and then all available samples (as much as
+	 * ring buffer can hold) with as few I2C transactions as possible: one
+	 * transaction reads as many samples as fit in 255 bytes. Samples are read
+	 * directly into the ring buffer and their endianness is converted in bulk.
+	 *
+	 * Everything happens in ISR (INT pin ISR, then I2C ISR), hence your program
+	 * only needs to `pull()` samples from the ring buffer.
+	 *
+	 * This class requires an asynchronous I2C Manager and needs the following
+	 * registrations in your program:
+	 * @code
+	 * using MANAGER = i2c::I2CAsyncManager<...>;
+	 * using STREAM = devices::magneto::MPU6050FifoStream<
+	 *     MANAGER, board::ExternalInterruptPin::D2_PD2_EXT0, devices::magneto::AllSensors>;
+	 * REGISTER_I2C_ISR(MANAGER)
+	 * REGISTER_MPU6050_FIFO_STREAM_ISR(0, STREAM)
+	 * REGISTER_FUTURE_STATUS_LISTENERS(MANAGER_FUTURE(MANAGER), STREAM)
+	 * REGISTER_FUTURE_OUTPUT_NO_LISTENERS()
+	 * @endcode
+	 *
+	 * @tparam MANAGER one of FastArduino available asynchronous I2C Manager
+	 * @tparam INT_PIN_ the external interrupt pin connected to MPU6050 INT pin
+	 * @tparam T_ the type of samples stored in MPU6050 FIFO; must be one of
+	 * `Sensor3D`, `int16_t` or `AllSensors`, based on the sensor samples selected
+	 * by `FIFOEnable`
+	 *
+	 * @sa MPU6050
+	 * @sa REGISTER_MPU6050_FIFO_STREAM_ISR()
+	 */
+	template<typename MANAGER, board::ExternalInterruptPin INT_PIN_, typename T_>
+	class MPU6050FifoStream
+	{
+		static_assert(i2c::I2CManager_trait<MANAGER>::IS_ASYNC, "MANAGER must be an asynchronous I2C Manager");
+		static_assert(sizeof(T_) % sizeof(int16_t) == 0, "T_ must be made of 16-bit samples");
+
+		using DEVICE = MPU6050<MANAGER>;
+		using ABSTRACT_FUTURE = typename MANAGER::ABSTRACT_FUTURE;
+		using COUNT_FUTURE = typename DEVICE::FifoCountFuture;
+		using READ_FUTURE = typename DEVICE::FifoReadFuture;
+
+		// Maximum number of samples read in one I2C transaction
+		static constexpr uint8_t MAX_BURST = UINT8_MAX / sizeof(T_);
+
+	public:
+		/** The external interrupt pin connected to MPU6050 INT pin. */
+		static constexpr const board::ExternalInterruptPin INT_PIN = INT_PIN_;
+		/** The type of samples read from MPU6050 FIFO. */
+		using T = T_;
+
+		/// @cond notdocumented
+		MPU6050FifoStream(const MPU6050FifoStream&) = delete;
+		MPU6050FifoStream& operator=(const MPU6050FifoStream&) = delete;
+		/// @endcond
+
+		/**
+		 * Create a new FIFO stream for @p device.
+		 * The MPU6050 device must be started in FIFO mode, with INT pin
+		 * generating interrupts, by calling
+		 * `MPU6050::begin(FIFOEnable, INTEnable, ...)`.
+		 *
+		 * @tparam SIZE the number of samples in @p buffer; one sample is always
+		 * kept unused in order to distinguish full and empty ring buffer.
+		 * @param device the MPU6050 device to read samples from
+		 * @param buffer the ring buffer where samples are stored until pulled
+		 */
+		template<uint8_t SIZE>
+		MPU6050FifoStream(DEVICE& device, T (&buffer)[SIZE])
+			: device_{device}, buffer_{buffer}, size_{SIZE}
+		{
+			static_assert(SIZE > 1, "SIZE must be at least 2");
+			interrupt::register_handler(*this);
+		}
+
+		/**
+		 * Start streaming: enable INT pin interrupts and perform a first
+		 * FIFO read.
+		 * MPU6050 must have been started before calling this method.
+		 */
+		void begin()
+		{
+			synchronized
+			{
+				signal_.enable_();
+				if (state_ == State::IDLE) start_count();
+			}
+		}
+
+		/**
+		 * Stop streaming: disable INT pin interrupts. A pending I2C transaction
+		 * will still complete.
+		 */
+		void end()
+		{
+			signal_.disable();
+		}
+
+		/**
+		 * Get the oldest sample from the ring buffer.
+		 * @param sample the sample pulled out of the ring buffer
+		 * @retval true if a sample was available
+		 * @retval false if the ring buffer is empty
+		 */
+		bool pull(T& sample)
+		{
+			synchronized
+			{
+				if (tail_ == head_) return false;
+				sample = buffer_[tail_];
+				if (++tail_ == size_) tail_ = 0;
+			}
+			if (stalled_) restart();
+			return true;
+		}
+
+		/**
+		 * Get the number of samples currently available in the ring buffer.
+		 */
+		uint8_t items() const
+		{
+			synchronized
+			{
+				return (head_ >= tail_) ? head_ - tail_ : size_ - tail_ + head_;
+			}
+		}
+
+		/**
+		 * Get the number of I2C errors that occurred since streaming started.
+		 * After an error, streaming resumes at next INT pin interrupt.
+		 */
+		uint16_t errors() const
+		{
+			synchronized return errors_;
+		}
+
+	private:
+		enum class State : uint8_t
+		{
+			IDLE = 0,
+			COUNTING,
+			READING
+		};
+
+		// Called from INT pin ISR
+		void on_interrupt()
+		{
+			if (state_ == State::IDLE)
+				start_count();
+			else
+				pending_ = true;
+		}
+
+		// Called from I2C ISR
+		void on_status_change(const ABSTRACT_FUTURE& future, future::FutureStatus status)
+		{
+			if (&future == &count_future_)
+			{
+				uint16_t count = 0;
+				if (status != future::FutureStatus::READY || !count_future_.get(count))
+					return on_error();
+				remaining_ = count / sizeof(T);
+				read_next();
+			}
+			else if (&future == &read_future_)
+			{
+				if (status != future::FutureStatus::READY)
+					return on_error();
+				DEVICE::fifo_change_endianness(
+					reinterpret_cast<uint8_t*>(buffer_ + head_), burst_ * sizeof(T));
+				head_ += burst_;
+				if (head_ == size_) head_ = 0;
+				remaining_ -= burst_;
+				read_next();
+			}
+		}
+
+		void start_count()
+		{
+			pending_ = false;
+			stalled_ = false;
+			state_ = State::COUNTING;
+			count_future_.reset_();
+			if (device_.fifo_count(count_future_) != 0) on_error();
+		}
+
+		void read_next()
+		{
+			if (remaining_ == 0)
+			{
+				state_ = State::IDLE;
+				// Samples may have been added to MPU6050 FIFO since it was counted
+				if (pending_) start_count();
+				return;
+			}
+			burst_ = free_contiguous();
+			if (burst_ == 0)
+			{
+				// Ring buffer is full: keep remaining samples in MPU6050 FIFO
+				// until some samples get pulled
+				state_ = State::IDLE;
+				stalled_ = true;
+				return;
+			}
+			if (burst_ > remaining_) burst_ = remaining_;
+			if (burst_ > MAX_BURST) burst_ = MAX_BURST;
+			state_ = State::READING;
+			read_future_.reset_(reinterpret_cast<uint8_t*>(buffer_ + head_), burst_ * sizeof(T));
+			if (device_.fifo_read(read_future_) != 0) on_error();
+		}
+
+		// Number of free slots from head_ without wrapping
+		uint8_t free_contiguous() const
+		{
+			if (tail_ > head_) return tail_ - head_ - 1;
+			return size_ - head_ - (tail_ == 0 ? 1 : 0);
+		}
+
+		void restart()
+		{
+			synchronized
+			{
+				if (stalled_ && state_ == State::IDLE) start_count();
+			}
+		}
+
+		void on_error()
+		{
+			++errors_;
+			state_ = State::IDLE;
+		}
+
+		DEVICE& device_;
+		T* buffer_;
+		const uint8_t size_;
+		volatile uint8_t head_ = 0;
+		volatile uint8_t tail_ = 0;
+
+		volatile State state_ = State::IDLE;
+		volatile bool pending_ = false;
+		volatile bool stalled_ = false;
+		uint16_t remaining_ = 0;
+		uint8_t burst_ = 0;
+		uint16_t errors_ = 0;
+
+		COUNT_FUTURE count_future_{future::FutureNotification::STATUS};
+		READ_FUTURE read_future_{future::FutureNotification::STATUS};
+		interrupt::INTSignal<INT_PIN_> signal_{interrupt::InterruptTrigger::RISING_EDGE};
+
+		DECL_FUTURE_LISTENERS_FRIEND
+		friend struct isr_handler_mpu6050;
+	};
+
+	/// @cond notdocumented
+	struct isr_handler_mpu6050
+	{
+		template<uint8_t INT_NUM_, typename STREAM_> static void fifo_stream()
+		{
+			interrupt::isr_handler_int::check_int_pin<INT_NUM_, STREAM_::INT_PIN>();
+			interrupt::HandlerHolder<STREAM_>::handler()->on_interrupt();
+		}
+	};
+	/// @endcond
+}
+
+#endif /* MPU6050_STREAM_H */
+/// @endcond
@@ -0,0 +1,387 @@
+//   Copyright 2016-2023 Jean-Francois Poilpret
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+/// @cond api
+
+/**
+ * @file
+ * API to handle many servomotors, connected to any digital pins, with only
+ * one 16-bit timer.
+ */
+#ifndef MULTI_SERVO_H
+#define MULTI_SERVO_H
+
+#include "../gpio.h"
+#include "../interrupts.h"
+#include "../timer.h"
+#include "../utilities.h"
+
+/**
+ * Register the necessary ISR (Interrupt Service Routines) for a
+ * `devices::servo::MultiServo` to work properly.
+ * This registers both Compare Match A and Compare Match B ISR of the timer.
+ * @param TIMER_NUM the number of the TIMER feature for the target MCU, used by
+ * @p MULTI_SERVO
+ * @param MULTI_SERVO the `devices::servo::MultiServo` type used
+ *
+ * @sa devices::servo::MultiServo
+ */
+#define REGISTER_MULTI_SERVO_ISR(TIMER_NUM, MULTI_SERVO)                          \
+	ISR(CAT3(TIMER, TIMER_NUM, _COMPA_vect))                                      \
+	{                                                                             \
+		devices::servo::isr_handler_multi_servo::frame<TIMER_NUM, MULTI_SERVO>(); \
+	}                                                                             \
+	ISR(CAT3(TIMER, TIMER_NUM, _COMPB_vect))                                      \
+	{                                                                             \
+		devices::servo::isr_handler_multi_servo::pulse<TIMER_NUM, MULTI_SERVO>(); \
+	}
+
+namespace devices::servo
+{
+	/// @cond notdocumented
+	struct isr_handler_multi_servo;
+	/// @endcond
+
+	/**
+	 * This template class supports up to 16 servomotors connected to any
+	 * digital pins, all driven by a single 16-bit timer.
+	 *
+	 * The timer runs in CTC mode with a period of @p FRAME_US_ (typically 20ms):
+	 * - at the beginning of each frame (Compare Match A), all attached servos
+	 * pins are set high at once
+	 * - then Compare Match B is programmed to each distinct pulse end, in
+	 * ascending order, and clears, at once, the pins of all servos whose pulse
+	 * ends at that time
+	 *
+	 * Pulse ends are sorted and grouped into a table, computed by `update()`
+	 * outside any ISR; 2 tables are used, so that new positions of all servos
+	 * are applied at once, at the beginning of next frame. Hence each ISR only
+	 * performs a few pins writes (one per port involved) and one compare
+	 * register update.
+	 *
+	 * Servos positions are first set, individually, with `set_counter()`,
+	 * `set_pulse()`, `rotate()` or `detach()`, then applied all at once with
+	 * `update()`:
+	 * @code
+	 * using SERVOS = devices::servo::MultiServo<board::Timer::TIMER1, 20000,
+	 *     board::DigitalPin::D2_PD2, board::DigitalPin::D3_PD3, board::DigitalPin::D4_PD4>;
+	 * REGISTER_MULTI_SERVO_ISR(1, SERVOS)
+	 * ...
+	 * SERVOS servos{1000, 2000};
+	 * servos.begin();
+	 * servos.rotate(0, 45);
+	 * servos.rotate(2, -30);
+	 * servos.update();
+	 * @endcode
+	 *
+	 * @tparam NTIMER_ the 16-bit timer used to generate pulses for all servos
+	 * @tparam FRAME_US_ the period of pulses, in microseconds, typically `20000`
+	 * @tparam PINS_ the digital pins connected to servos; in all methods,
+	 * servos are identified by their index in this list
+	 *
+	 * @sa REGISTER_MULTI_SERVO_ISR()
+	 * @sa Servo
+	 */
+	template<board::Timer NTIMER_, uint16_t FRAME_US_, board::DigitalPin... PINS_> class MultiServo
+	{
+		using CALC = timer::Calculator<NTIMER_>;
+		using TRAIT = board_traits::Timer_trait<NTIMER_>;
+		using OCRB_TRAIT = board_traits::Timer_COM_trait<NTIMER_, 1>;
+		using TPRESCALER = typename CALC::PRESCALER;
+		using PINS = gpio::FastPinGroup<PINS_...>;
+		using MASK = typename PINS::VALUE;
+
+		static_assert(TRAIT::IS_16BITS, "NTIMER_ must be a 16 bits timer");
+		static_assert(sizeof...(PINS_) <= 16, "MultiServo can handle at most 16 servos");
+
+		static constexpr const TPRESCALER PRESCALER = CALC::CTC_prescaler(FRAME_US_);
+		static_assert(CALC::is_adequate_for_CTC(PRESCALER, FRAME_US_), "FRAME_US_ is not adequate for NTIMER_");
+
+	public:
+		/** The number of servos handled. */
+		static constexpr const uint8_t SIZE = sizeof...(PINS_);
+		/** The timer used to generate pulses. */
+		static constexpr const board::Timer NTIMER = NTIMER_;
+		/** The type of counter for @p NTIMER_ */
+		using TYPE = typename CALC::TYPE;
+
+	private:
+		static constexpr const TYPE FRAME_COUNTER = CALC::CTC_counter(PRESCALER, FRAME_US_);
+		// Pulses ending less than this number of ticks apart are handled by
+		// the same ISR call, in order to never miss a compare match
+		static constexpr const TYPE MIN_TICKS = CALC::us_to_ticks(PRESCALER, 8) + 1;
+		// Compare match B value that never occurs in CTC mode
+		static constexpr const TYPE NO_PULSE = 0xFFFF;
+
+	public:
+		/// @cond notdocument
+		MultiServo(const MultiServo&) = delete;
+		MultiServo& operator=(const MultiServo&) = delete;
+		/// @endcond
+
+		/**
+		 * Create a new handler for all servos, with the same pulse widths
+		 * calibration for all servos. All servos are initially detached.
+		 *
+		 * @param us_minimum the minimal pulse width in microseconds; this matches
+		 * the minimal angle of the servos.
+		 * @param us_maximum the maximal pulse width in microseconds: this matches
+		 * the maximal angle of the servos.
+		 * @param us_neutral the pulse width, in microseconds, that matches the
+		 * 0 angle; when not provided (or `0`), it will be calculated as the
+		 * average of @p us_minimum and @p us_maximum.
+		 */
+		MultiServo(uint16_t us_minimum, uint16_t us_maximum, uint16_t us_neutral = 0)
+			:	timer_{timer::TimerMode::CTC, PRESCALER,
+					timer::TimerInterrupt::OUTPUT_COMPARE_A | timer::TimerInterrupt::OUTPUT_COMPARE_B},
+				US_MINIMUM_{us_minimum}, US_MAXIMUM_{us_maximum},
+				COUNTER_MINIMUM_{counter(us_minimum)}, COUNTER_MAXIMUM_{counter(us_maximum)},
+				COUNTER_NEUTRAL_{counter(us_neutral ? us_neutral : ((us_maximum + us_minimum) / 2))}
+		{
+			interrupt::register_handler(*this);
+		}
+
+		/**
+		 * Start generating pulses for all attached servos.
+		 * @sa end()
+		 */
+		void begin()
+		{
+			synchronized
+			{
+				OCRB_TRAIT::OCR = NO_PULSE;
+				timer_.begin_(FRAME_COUNTER);
+			}
+		}
+
+		/**
+		 * Stop generating pulses for all servos; all servos pins are cleared.
+		 * @sa begin()
+		 */
+		void end()
+		{
+			synchronized
+			{
+				timer_.end_();
+				pins_.set(0);
+			}
+		}
+
+		/**
+		 * Set the Timer counter that will define the pulse width, hence the
+		 * angle, of @p servo.
+		 * This method is the most optimized way to change a servo angle.
+		 * Calculation can be performed by `calculate_counter()`.
+		 * The new angle is effective only after `update()` is called.
+		 *
+		 * @param servo the index of the servo in @p PINS_
+		 * @param value the new counter value to use for fixing pulse width
+		 *
+		 * @sa calculate_counter()
+		 * @sa update()
+		 */
+		void set_counter(uint8_t servo, TYPE value)
+		{
+			if (servo < SIZE) counters_[servo] = utils::constrain(value, COUNTER_MINIMUM_, COUNTER_MAXIMUM_);
+		}
+
+		/**
+		 * Set the pulse width in microsecond, hence the angle, of @p servo.
+		 * The new angle is effective only after `update()` is called.
+		 *
+		 * @param servo the index of the servo in @p PINS_
+		 * @param pulse_us the new pulse width in microseconds
+		 *
+		 * @sa update()
+		 */
+		void set_pulse(uint8_t servo, uint16_t pulse_us)
+		{
+			if (servo < SIZE) counters_[servo] = calculate_counter(pulse_us);
+		}
+
+		/**
+		 * Rotate @p servo at the given @p angle position.
+		 * The new angle is effective only after `update()` is called.
+		 *
+		 * @param servo the index of the servo in @p PINS_
+		 * @param angle the new angle, in degrees, to rotate the servo to; it must
+		 * be between `-90` and `+90`.
+		 *
+		 * @sa update()
+		 */
+		void rotate(uint8_t servo, int8_t angle)
+		{
+			if (servo >= SIZE) return;
+			angle = utils::constrain(angle, MIN, MAX);
+			counters_[servo] =
+				(angle >= 0 ? utils::map(int32_t(angle), int32_t(0), int32_t(MAX), COUNTER_NEUTRAL_, COUNTER_MAXIMUM_) :
+								utils::map(int32_t(angle), int32_t(MIN), int32_t(0), COUNTER_MINIMUM_, COUNTER_NEUTRAL_));
+		}
+
+		/**
+		 * Detach @p servo: no pulse will be generated for it anymore, i.e. the
+		 * servo will not be able to hold its position anymore.
+		 * This is effective only after `update()` is called.
+		 *
+		 * @param servo the index of the servo in @p PINS_
+		 *
+		 * @sa update()
+		 */
+		void detach(uint8_t servo)
+		{
+			if (servo < SIZE) counters_[servo] = 0;
+		}
+
+		/**
+		 * Apply all positions set since last call, for all servos at once,
+		 * starting at next frame.
+		 * This computes the sorted table of pulses ends, used by the ISR.
+		 */
+		void update()
+		{
+			// Cancel any pending table, so that ISR cannot use it while it is computed
+			synchronized pending_ = false;
+			Table& table = tables_[1 - current_];
+			uint8_t count = 0;
+			MASK active = 0;
+			for (uint8_t servo = 0; servo < SIZE; ++servo)
+			{
+				const TYPE value = counters_[servo];
+				if (!value) continue;
+				const MASK mask = MASK(MASK(1) << servo);
+				active |= mask;
+				// Insert value into sorted table, merging identical values
+				uint8_t index = 0;
+				while (index < count && table.counters[index] < value) ++index;
+				if (index < count && table.counters[index] == value)
+					table.masks[index] |= mask;
+				else
+				{
+					for (uint8_t i = count; i > index; --i)
+					{
+						table.counters[i] = table.counters[i - 1];
+						table.masks[i] = table.masks[i - 1];
+					}
+					table.counters[index] = value;
+					table.masks[index] = mask;
+					++count;
+				}
+			}
+			table.count = count;
+			table.active = active;
+			synchronized pending_ = true;
+		}
+
+		/**
+		 * Calculate the counter value to use with `set_counter()` in order to
+		 * generate a pulse of the given width.
+		 *
+		 * @param pulse_us the pulse width, in microseconds, for which to compute
+		 * the counter value
+		 * @return the counter value to use for a @p pulse_us width
+		 *
+		 * @sa set_counter()
+		 */
+		constexpr TYPE calculate_counter(uint16_t pulse_us) const
+		{
+			return counter(utils::constrain(pulse_us, US_MINIMUM_, US_MAXIMUM_));
+		}
+
+	private:
+		struct Table
+		{
+			TYPE counters[SIZE];
+			MASK masks[SIZE];
+			MASK active;
+			uint8_t count;
+		};
+
+		static constexpr TYPE counter(uint16_t pulse_us)
+		{
+			return CALC::us_to_ticks(PRESCALER, pulse_us);
+		}
+
+		void on_frame()
+		{
+			if (pending_)
+			{
+				current_ = 1 - current_;
+				pending_ = false;
+			}
+			const Table& table = tables_[current_];
+			pins_.set(table.active);
+			next_ = 0;
+			OCRB_TRAIT::OCR = (table.count ? table.counters[0] : NO_PULSE);
+		}
+
+		void on_pulse()
+		{
+			const Table& table = tables_[current_];
+			uint8_t next = next_;
+			MASK mask = table.masks[next++];
+			// Group all pulses ending too close (or already past) to be handled
+			// by another ISR call
+			const TYPE limit = TYPE(TRAIT::TCNT) + MIN_TICKS;
+			while (next < table.count && table.counters[next] <= limit)
+				mask |= table.masks[next++];
+			pins_.toggle(mask);
+			next_ = next;
+			OCRB_TRAIT::OCR = (next < table.count ? table.counters[next] : NO_PULSE);
+		}
+
+		static const int8_t MAX = +90;
+		static const int8_t MIN = -90;
+
+		timer::Timer<NTIMER_> timer_;
+		PINS pins_{gpio::PinMode::OUTPUT};
+
+		const uint16_t US_MINIMUM_;
+		const uint16_t US_MAXIMUM_;
+		const TYPE COUNTER_MINIMUM_;
+		const TYPE COUNTER_MAXIMUM_;
+		const TYPE COUNTER_NEUTRAL_;
+
+		// Positions set but not yet applied by update()
+		TYPE counters_[SIZE] = {};
+		// Tables of pulses: one used by ISR, the other computed by update()
+		Table tables_[2] = {};
+		volatile uint8_t current_ = 0;
+		volatile bool pending_ = false;
+		uint8_t next_ = 0;
+
+		friend struct isr_handler_multi_servo;
+	};
+
+	/// @cond notdocumented
+	struct isr_handler_multi_servo
+	{
+		template<uint8_t TIMER_NUM_, typename MULTI_SERVO_> static void frame()
+		{
+			static constexpr board::Timer NTIMER = timer::isr_handler::check_timer<TIMER_NUM_>();
+			static_assert(NTIMER == MULTI_SERVO_::NTIMER, "TIMER_NUM must match MULTI_SERVO timer");
+			interrupt::HandlerHolder<MULTI_SERVO_>::handler()->on_frame();
+		}
+
+		template<uint8_t TIMER_NUM_, typename MULTI_SERVO_> static void pulse()
+		{
+			static constexpr board::Timer NTIMER = timer::isr_handler::check_timer<TIMER_NUM_>();
+			static_assert(NTIMER == MULTI_SERVO_::NTIMER, "TIMER_NUM must match MULTI_SERVO timer");
+			interrupt::HandlerHolder<MULTI_SERVO_>::handler()->on_pulse();
+		}
+	};
+	/// @endcond
+}
+
+#endif /* MULTI_SERVO_H */
+/// @endcond
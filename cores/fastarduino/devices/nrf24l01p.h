@@ -33,13 +33,34 @@
 #define NRF24L01_HH
 
 #include <stddef.h>
+#include <string.h>
 #include "../utilities.h"
 #include "../errors.h"
 #include "../time.h"
 #include "../spi.h"
 #include "../int.h"
+#include "../queue.h"
+#include "../events.h"
 #include "nrf24l01p_internals.h"
 
+/**
+ * Register the necessary ISR (Interrupt Service Routine) for an
+ * `devices::rf::AsyncNRF24L01` to be notified of all events (payload received,
+ * payload sent, transmission failure) signaled by the chip IRQ pin.
+ * 
+ * @param INT_NUM the number of the `INT` vector for the `board::ExternalInterruptPin`
+ * connected to the IRQ pin of the nRF24L01+
+ * @param RADIO the actual type of the `devices::rf::AsyncNRF24L01` for which
+ * this ISR is registered
+ * 
+ * @sa devices::rf::AsyncNRF24L01
+ */
+#define REGISTER_ASYNC_NRF24L01_ISR(INT_NUM, RADIO)                 \
+	ISR(CAT3(INT, INT_NUM, _vect))                                  \
+	{                                                               \
+		devices::rf::isr_handler::async_nrf24l01<INT_NUM, RADIO>(); \
+	}
+
 namespace devices
 {
 	/**
@@ -56,6 +77,47 @@ namespace devices
 
 namespace devices::rf
 {
+	/// @cond notdocumented
+	struct isr_handler;
+	/// @endcond
+
+	/**
+	 * A packet received by `AsyncNRF24L01` and pushed to its packets queue.
+	 * 
+	 * @sa AsyncNRF24L01
+	 */
+	struct Packet
+	{
+		/** Maximum size of payload in one packet. */
+		static constexpr const uint8_t PAYLOAD_MAX =
+			nrf24l01p_internals::DEVICE_PAYLOAD_MAX - nrf24l01p_internals::HEADER_SIZE;
+
+		/** Source device address of this packet. */
+		uint8_t src;
+		/** Device port (or message type) of this packet. */
+		uint8_t port;
+		/** `true` if this packet has been broadcast. */
+		bool broadcast;
+		/** Actual size, in bytes, of this packet payload. */
+		uint8_t size;
+		/** Packet payload; only the first @p size bytes are meaningful. */
+		uint8_t payload[PAYLOAD_MAX];
+
+		/**
+		 * Copy the payload of this packet to @p value.
+		 * @tparam T the type of @p value
+		 * @param value reference to the object to fill with this packet payload
+		 * @retval true if @p value has been copied from payload
+		 * @retval false if this packet payload size does not match `sizeof(T)`
+		 */
+		template<typename T> bool get(T& value) const
+		{
+			if (size != sizeof(T)) return false;
+			memcpy(&value, payload, sizeof(T));
+			return true;
+		}
+	};
+
 	/**
 	 * SPI device driver for Nordic Semiconductor nRF24L01+ support, without IRQ support.
 	 * nRF24L01+ is a cheap 2.4GHz RX/TX chip.
@@ -91,13 +153,13 @@ namespace devices::rf
 		/**
 		 * Maximum size of payload on device.
 		 */
-		static const size_t DEVICE_PAYLOAD_MAX = 32;
+		static const size_t DEVICE_PAYLOAD_MAX = nrf24l01p_internals::DEVICE_PAYLOAD_MAX;
 
 		/**
 		 * Maximum size of payload. The device allows 32 bytes payload.
 		 * The source address one byte and port one byte as header.
 		 */
-		static const size_t PAYLOAD_MAX = DEVICE_PAYLOAD_MAX - 2;
+		static const size_t PAYLOAD_MAX = DEVICE_PAYLOAD_MAX - nrf24l01p_internals::HEADER_SIZE;
 
 		/**
 		 * Construct NRF transceiver with given channel and pin numbers
@@ -563,8 +625,73 @@ namespace devices::rf
 			return status_;
 		}
 
-		void transmit_mode(uint8_t dest);
-		void receive_mode();
+		// If wait is false, do not wait for the chip to settle (Tstby2a) when
+		// leaving standby mode (the chip waits by itself before sending/receiving)
+		void transmit_mode(uint8_t dest, bool wait = true);
+		void receive_mode(bool wait = true);
+
+		void write_tx_payload(uint8_t dest, uint8_t port, const uint8_t* buf, size_t len)
+		{
+			Command command = ((dest != BROADCAST) ? Command::W_TX_PAYLOAD : Command::W_TX_PAYLOAD_NO_ACK);
+			this->start_transfer();
+			status_ = status_t{this->transfer(uint8_t(command))};
+			this->transfer(addr_.device);
+			this->transfer(port);
+			this->transfer(buf, len);
+			this->end_transfer();
+			trans_ += 1;
+		}
+		void enable_ack_pipe(uint8_t dest)
+		{
+			using namespace nrf24l01p_internals;
+			addr_t tx_addr(addr_.network, dest);
+			write_register(Register::RX_ADDR_P0, (const uint8_t*) &tx_addr, sizeof(tx_addr));
+			write_register(Register::EN_RXADDR, bits::BV8(ERX_P2, ERX_P1, ERX_P0));
+		}
+		void disable_ack_pipe()
+		{
+			using namespace nrf24l01p_internals;
+			write_register(Register::EN_RXADDR, bits::BV8(ERX_P2, ERX_P1));
+		}
+		void count_retransmissions()
+		{
+			retrans_ += read_observe_tx().arc_cnt;
+		}
+		void count_drops(uint8_t drops = 1)
+		{
+			drops_ += drops;
+		}
+
+		// Read ACK payload received (on pipe 0) after latest transmission, if any
+		int read_ack_payload(uint8_t* buf, size_t size)
+		{
+			using namespace nrf24l01p_internals;
+			if (read_status().rx_p_no != 0) return 0;
+			uint8_t count = read_command(Command::R_RX_PL_WID);
+			if (count > size)
+			{
+				write_command(Command::FLUSH_RX);
+				return errors::EMSGSIZE;
+			}
+			this->start_transfer();
+			status_ = status_t{this->transfer(uint8_t(Command::R_RX_PAYLOAD))};
+			this->transfer(buf, count, uint8_t(Command::NOP));
+			this->end_transfer();
+			write_register(Register::STATUS, bits::BV8(RX_DR));
+			return count;
+		}
+		// Discard all payloads (including ACK payloads) pending in TX FIFO
+		void flush_tx()
+		{
+			write_command(Command::FLUSH_TX);
+		}
+		// Replace ACK payload to be sent along next acknowledgements on unicast pipe
+		void write_ack_payload(const uint8_t* buf, size_t len, uint8_t copies = 1)
+		{
+			write_command(Command::FLUSH_TX);
+			const uint8_t command = uint8_t(Command::W_ACK_PAYLOAD) | uint8_t(uint8_t(Command::PIPE_MASK) & UNICAST_PIPE);
+			while (copies--) write(command, buf, len);
+		}
 
 		bool available();
 		int read_fifo_payload(uint8_t& src, uint8_t& port, uint8_t* buf, size_t count);
@@ -580,6 +707,7 @@ namespace devices::rf
 
 	private:
 		static const uint8_t DEFAULT_CHANNEL = 64;
+		static const uint8_t UNICAST_PIPE = 1;
 
 		gpio::FAST_PIN<CE> ce_ = gpio::FAST_PIN<CE>{gpio::PinMode::OUTPUT, false};
 
@@ -593,6 +721,8 @@ namespace devices::rf
 		uint16_t trans_ = 0;   //!< Send count.
 		uint16_t retrans_ = 0; //!< Retransmittion count.
 		uint16_t drops_ = 0;   //!< Dropped messages.
+
+		template<typename RADIO, uint8_t WINDOW> friend class Transport;
 	};
 
 	/**
@@ -665,6 +795,321 @@ namespace devices::rf
 		interrupt::INTSignal<IRQ> irq_signal_ = interrupt::INTSignal<IRQ>{interrupt::InterruptTrigger::FALLING_EDGE};
 	};
 
+	/**
+	 * SPI device driver for Nordic Semiconductor nRF24L01+ support, fully
+	 * driven by its IRQ pin.
+	 * 
+	 * Contrarily to `NRF24L01` and `IRQ_NRF24L01`, this driver never blocks
+	 * while sending or receiving payloads:
+	 * - `send()` only pushes a payload to the chip TX FIFO (up to 3 payloads
+	 * can be pipelined that way) and returns immediately
+	 * - the ISR, triggered by the chip IRQ pin, reads all received payloads 
+	 * and pushes them, as `Packet`s, to a queue provided at construction time
+	 * - the ISR also tracks completion (or failure) of pending transmissions
+	 * 
+	 * For each of these situations, an event is pushed to an events queue, with
+	 * one of the following types: `events::Type::RF_RECEIVED`, 
+	 * `events::Type::RF_SENT` or `events::Type::RF_SEND_FAILED`.
+	 * 
+	 * The chip is kept in receive mode as long as no payload is pending 
+	 * transmission; it is switched to transmit mode when `send()` is called and 
+	 * switched back to receive mode once the TX FIFO is empty. Note that, as the
+	 * chip is half-duplex, nothing can be received while payloads are pending.
+	 * 
+	 * All payloads pending in the TX FIFO must have the same destination; if
+	 * `send()` is called with another destination while payloads are still
+	 * pending, it will return `errors::EAGAIN`.
+	 * 
+	 * For this driver to work, you need to register the proper ISR with
+	 * `REGISTER_ASYNC_NRF24L01_ISR()`.
+	 * 
+	 * @warning the ISR performs SPI transfers; if other devices share the same SPI
+	 * bus, your program must ensure their transfers cannot be interrupted by this
+	 * ISR (e.g. by performing them inside a `synchronized` block).
+	 * 
+	 * Wiring is the same as for `IRQ_NRF24L01`.
+	 * 
+	 * @tparam CSN the `board::DigitalPin` connected to the CSN pin
+	 * @tparam CE the `board::DigitalPin` connected to the CE pin
+	 * @tparam IRQ the `board::ExternalInterruptPin` connected to the IRQ pin
+	 * @tparam EVENT_ the `events::Event<T>` type pushed to the events queue
+	 * 
+	 * @sa NRF24L01
+	 * @sa IRQ_NRF24L01
+	 * @sa REGISTER_ASYNC_NRF24L01_ISR()
+	 */
+	template<board::DigitalPin CSN, board::DigitalPin CE, board::ExternalInterruptPin IRQ_,
+			 typename EVENT_ = events::Event<void>>
+	class AsyncNRF24L01 : public NRF24L01<CSN, CE>
+	{
+		static_assert(events::Event_trait<EVENT_>::IS_EVENT, "EVENT_ type must be an events::Event<T>");
+		using BASE = NRF24L01<CSN, CE>;
+		static_assert(Packet::PAYLOAD_MAX == BASE::PAYLOAD_MAX, "Packet::PAYLOAD_MAX must match NRF24L01::PAYLOAD_MAX");
+		using Command = typename BASE::Command;
+		using Register = typename BASE::Register;
+		using status_t = typename BASE::status_t;
+		using fifo_status_t = typename BASE::fifo_status_t;
+
+	public:
+		/** The `board::ExternalInterruptPin` connected to the IRQ pin. */
+		static constexpr const board::ExternalInterruptPin IRQ = IRQ_;
+		/** The type of events pushed by this driver to its events queue. */
+		using EVENT = EVENT_;
+
+		/** The maximum number of payloads that can be pending transmission. */
+		static constexpr const uint8_t TX_FIFO_SIZE = 3;
+
+		/**
+		 * Construct NRF transceiver with given network and device address.
+		 * @param net network address
+		 * @param dev device address
+		 * @param packets the queue to which all received packets will be pushed
+		 * @param events the queue to which all events will be pushed
+		 */
+		AsyncNRF24L01(uint16_t net, uint8_t dev, containers::Queue<Packet>& packets, containers::Queue<EVENT>& events)
+			: BASE{net, dev}, packets_{packets}, events_{events}
+		{
+			gpio::FastPinType<board::EXT_PIN<IRQ>()>::set_mode(gpio::PinMode::INPUT_PULLUP);
+			interrupt::register_handler(*this);
+		}
+
+		/**
+		 * Start up the device driver and set it to receive mode. 
+		 * This must be called before any transmission or reception can take place.
+		 */
+		void begin()
+		{
+			BASE::begin();
+			this->receive_mode();
+			irq_signal_.enable();
+		}
+
+		/**
+		 * Shut down the device driver.
+		 * All pending payloads are lost.
+		 */
+		void end()
+		{
+			irq_signal_.disable();
+			pending_ = 0;
+			BASE::end();
+		}
+
+		/**
+		 * Set output power level (-30..10 dBm)
+		 * @param[in] dBm
+		 */
+		void set_output_power_level(int8_t dBm)
+		{
+			synchronized BASE::set_output_power_level(dBm);
+		}
+
+		/**
+		 * Push a message with given object reference to the TX FIFO.
+		 * This method returns immediately, completion of transmission is notified
+		 * through an `events::Type::RF_SENT` or `events::Type::RF_SEND_FAILED` event.
+		 * 
+		 * @tparam T the type of @p buf (the object to transfer)
+		 * @tparam TREF the type passed for @p buf, typically a const reference 
+		 * to type @p T
+		 * 
+		 * @param[in] dest destination network address
+		 * @param[in] port device port (or message type)
+		 * @param[in] buf reference of object to transmit
+		 * @return number of bytes pushed or negative error code
+		 * @retval errors::EMSGSIZE if `sizeof(T)` > `PAYLOAD_MAX`
+		 * @retval errors::EAGAIN if the TX FIFO is full or if pending payloads
+		 * have a different destination than @p dest
+		 */
+		template<typename T, typename TREF = const T&>
+		int send(uint8_t dest, uint8_t port, TREF buf)
+		{
+			return send_(dest, port, (const uint8_t*) &buf, sizeof(T));
+		}
+
+		/**
+		 * Push an empty message to the TX FIFO.
+		 * This method returns immediately, completion of transmission is notified
+		 * through an `events::Type::RF_SENT` or `events::Type::RF_SEND_FAILED` event.
+		 * 
+		 * @param[in] dest destination network address
+		 * @param[in] port device port (or message type)
+		 * @return number of bytes pushed or negative error code
+		 * @retval errors::EAGAIN if the TX FIFO is full or if pending payloads
+		 * have a different destination than @p dest
+		 */
+		int send(uint8_t dest, uint8_t port)
+		{
+			return send_(dest, port, nullptr, 0);
+		}
+
+		/**
+		 * Push a message with given object reference to the TX FIFO, for 
+		 * broadcast to all devices on the network.
+		 * 
+		 * @tparam T the type of @p buf (the object to transfer)
+		 * @tparam TREF the type passed for @p buf, typically a const reference 
+		 * to type @p T
+		 * 
+		 * @param[in] port device port (or message type)
+		 * @param[in] buf reference of object to transmit
+		 * @return number of bytes pushed or negative error code
+		 */
+		template<typename T, typename TREF = const T&>
+		int broadcast(uint8_t port, TREF buf)
+		{
+			return send<T, TREF>(BASE::BROADCAST, port, buf);
+		}
+
+		/**
+		 * Get the oldest received packet, if any.
+		 * This method does not block.
+		 * 
+		 * @param packet reference to the packet to fill
+		 * @retval true if a packet has been pulled from the packets queue
+		 * @retval false if no packet was received
+		 */
+		bool recv(Packet& packet)
+		{
+			return packets_.pull(packet);
+		}
+
+		/**
+		 * Return the number of payloads still pending transmission.
+		 */
+		uint8_t pending() const
+		{
+			return pending_;
+		}
+
+		/**
+		 * Return number of received packets that were lost because the packets
+		 * queue was full.
+		 */
+		uint16_t get_rx_drops() const
+		{
+			synchronized return rx_drops_;
+		}
+
+	protected:
+		/// @cond notdocumented
+		int send_(uint8_t dest, uint8_t port, const uint8_t* buf, size_t len)
+		{
+			// Note buf == 0 and len == 0 is perfectly acceptable
+			if ((buf == nullptr) && (len > 0)) return errors::EINVAL;
+			if (len > BASE::PAYLOAD_MAX) return errors::EMSGSIZE;
+			synchronized
+			{
+				if (pending_ == 0)
+				{
+					// Do not wait for chip settling here, the chip will send
+					// payloads by itself once ready
+					this->transmit_mode(dest, false);
+					if (dest != BASE::BROADCAST) this->enable_ack_pipe(dest);
+					tx_dest_ = dest;
+				}
+				else if ((pending_ == TX_FIFO_SIZE) || (dest != tx_dest_))
+					return errors::EAGAIN;
+				this->write_tx_payload(dest, port, buf, len);
+				++pending_;
+			}
+			return len;
+		}
+		/// @endcond
+
+	private:
+		void on_irq()
+		{
+			using namespace nrf24l01p_internals;
+			status_t status = this->read_status();
+			// Clear all interrupt flags at once
+			this->write_register(Register::STATUS, status.as_byte & bits::BV8(RX_DR, TX_DS, MAX_RT));
+			if (status.rx_dr) on_receive();
+			if (status.tx_ds || status.max_rt) on_transmit(status.tx_ds);
+		}
+
+		void on_receive()
+		{
+			Packet packet;
+			// Drain RX FIFO
+			while (!this->read_fifo_status().rx_empty)
+			{
+				int count = this->read_fifo_payload(packet.src, packet.port, packet.payload, Packet::PAYLOAD_MAX);
+				if (count < 0) continue;
+				packet.size = uint8_t(count);
+				packet.broadcast = this->is_broadcast();
+				if (packets_.push_(packet))
+					events_.push_(EVENT{events::Type::RF_RECEIVED});
+				else
+					++rx_drops_;
+			}
+		}
+
+		void on_transmit(bool sent)
+		{
+			if (pending_ == 0) return;
+			this->count_retransmissions();
+			if (sent)
+			{
+				// TX_DS may cover several payloads sent before this ISR is called,
+				// hence recompute pending_ from TX FIFO state; when TX FIFO is
+				// neither empty nor full, remaining payloads cannot be known
+				// exactly, then we assume only one was sent, next TX_DS will
+				// account for the others
+				fifo_status_t fifo = this->read_fifo_status();
+				uint8_t remaining;
+				if (fifo.tx_empty)
+					remaining = 0;
+				else if (fifo.tx_full)
+					remaining = TX_FIFO_SIZE;
+				else
+					remaining = (pending_ > 1 ? pending_ - 1 : 1);
+				if (remaining > pending_) remaining = pending_;
+				// Push one event per payload sent
+				for (uint8_t sent_count = pending_ - remaining; sent_count; --sent_count)
+					events_.push_(EVENT{events::Type::RF_SENT});
+				pending_ = remaining;
+			}
+			else
+			{
+				// Failing payload remains in TX FIFO and all other pending payloads
+				// have the same destination, hence drop them all
+				this->write_command(Command::FLUSH_TX);
+				this->count_drops(pending_);
+				pending_ = 0;
+				events_.push_(EVENT{events::Type::RF_SEND_FAILED});
+			}
+			// Switch back to receive mode once all pending payloads are done
+			if (pending_ == 0)
+			{
+				if (tx_dest_ != BASE::BROADCAST) this->disable_ack_pipe();
+				this->receive_mode(false);
+			}
+		}
+
+		containers::Queue<Packet>& packets_;
+		containers::Queue<EVENT>& events_;
+		volatile uint8_t pending_ = 0;
+		uint8_t tx_dest_ = 0;
+		volatile uint16_t rx_drops_ = 0;
+		interrupt::INTSignal<IRQ> irq_signal_ = interrupt::INTSignal<IRQ>{interrupt::InterruptTrigger::FALLING_EDGE};
+
+		friend struct isr_handler;
+	};
+
+	/// @cond notdocumented
+	// All nRF24L01+ related methods called by pre-defined ISR are defined here
+	struct isr_handler
+	{
+		template<uint8_t INT_NUM_, typename RADIO_> static void async_nrf24l01()
+		{
+			static_assert(board_traits::ExternalInterruptPin_trait<RADIO_::IRQ>::INT == INT_NUM_,
+						  "IRQ INT number must match INT_NUM");
+			interrupt::HandlerHolder<RADIO_>::handler()->on_irq();
+		}
+	};
+	/// @endcond
+
 	template<board::DigitalPin CSN, board::DigitalPin CE>
 	NRF24L01<CSN, CE>::NRF24L01(uint16_t net, uint8_t dev) : addr_{net, dev} {}
 
@@ -739,23 +1184,10 @@ namespace devices::rf
 		transmit_mode(dest);
 
 		// Write source address and payload to the transmit fifo
-		Command command = ((dest != BROADCAST) ? Command::W_TX_PAYLOAD : Command::W_TX_PAYLOAD_NO_ACK);
-		this->start_transfer();
-		status_ = status_t{this->transfer(uint8_t(command))};
-		this->transfer(addr_.device);
-		this->transfer(port);
-		this->transfer(buf, len);
-		this->end_transfer();
-
-		trans_ += 1;
+		write_tx_payload(dest, port, buf, len);
 
 		// Check for auto-acknowledge pipe(0), and address setup and enable
-		if (dest != BROADCAST)
-		{
-			addr_t tx_addr(addr_.network, dest);
-			write_register(Register::RX_ADDR_P0, (const uint8_t*) &tx_addr, sizeof(tx_addr));
-			write_register(Register::EN_RXADDR, bits::BV8(ERX_P2, ERX_P1, ERX_P0));
-		}
+		if (dest != BROADCAST) enable_ack_pipe(dest);
 
 		// Wait for transmission
 		status_t status = status_t{0};
@@ -769,21 +1201,20 @@ namespace devices::rf
 		bool data_sent = status.tx_ds;
 
 		// Check for auto-acknowledge pipe(0) disable
-		if (dest != BROADCAST) write_register(Register::EN_RXADDR, bits::BV8(ERX_P2, ERX_P1));
+		if (dest != BROADCAST) disable_ack_pipe();
 
 		// Reset status bits
 		write_register(Register::STATUS, bits::BV8(TX_DS, MAX_RT));
 
 		// Read retransmission counter and update
-		observe_tx_t observe = read_observe_tx();
-		retrans_ += observe.arc_cnt;
+		count_retransmissions();
 
 		// Check that the message was delivered
 		if (data_sent) return len;
 
 		// Failed to deliver
 		write_command(Command::FLUSH_TX);
-		drops_ += 1;
+		count_drops();
 
 		return errors::EIO;
 	}
@@ -823,7 +1254,7 @@ namespace devices::rf
 	}
 
 	/// @cond notdocumented
-	template<board::DigitalPin CSN, board::DigitalPin CE> void NRF24L01<CSN, CE>::transmit_mode(uint8_t dest)
+	template<board::DigitalPin CSN, board::DigitalPin CE> void NRF24L01<CSN, CE>::transmit_mode(uint8_t dest, bool wait)
 	{
 		using namespace nrf24l01p_internals;
 		// Setup primary transmit address
@@ -839,11 +1270,11 @@ namespace devices::rf
 		}
 
 		// Wait for the transmitter to become active
-		if (state_ == State::STANDBY_STATE) time::delay_us(Tstby2a_us);
+		if (wait && state_ == State::STANDBY_STATE) time::delay_us(Tstby2a_us);
 		state_ = State::TX_STATE;
 	}
 
-	template<board::DigitalPin CSN, board::DigitalPin CE> void NRF24L01<CSN, CE>::receive_mode()
+	template<board::DigitalPin CSN, board::DigitalPin CE> void NRF24L01<CSN, CE>::receive_mode(bool wait)
 	{
 		using namespace nrf24l01p_internals;
 		// Check already in receive mode
@@ -852,7 +1283,7 @@ namespace devices::rf
 		// Configure primary receiver mode
 		write_register(Register::CONFIG, bits::BV8(EN_CRC, CRCO, PWR_UP, PRIM_RX));
 		ce_.set();
-		if (state_ == State::STANDBY_STATE) time::delay_us(Tstby2a_us);
+		if (wait && state_ == State::STANDBY_STATE) time::delay_us(Tstby2a_us);
 		state_ = State::RX_STATE;
 	}
 
@@ -160,6 +160,12 @@ namespace devices::rf::nrf24l01p_internals
 	 */
 	const uint8_t AW_MAX = 5;   //!< Max address width in bytes.
 	const uint8_t PIPE_MAX = 6; //!< Max number of pipes.
+
+	/**
+	 * Payload sizes.
+	 */
+	const uint8_t DEVICE_PAYLOAD_MAX = 32; //!< Max payload size on device.
+	const uint8_t HEADER_SIZE = 2;		   //!< Size of header (source address and port) of each payload.
 }
 #endif /* NRF24L01_INTERNALS_HH */
 /// @endcond
@@ -0,0 +1,383 @@
+//   Copyright 2016-2023 Jean-Francois Poilpret
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+/// @cond api
+
+/**
+ * @file
+ * API to transfer messages larger than one nRF24L01+ payload, through
+ * fragmentation and reassembly.
+ */
+#ifndef NRF24L01_TRANSPORT_HH
+#define NRF24L01_TRANSPORT_HH
+
+#include <stddef.h>
+#include <string.h>
+#include "../errors.h"
+#include "../time.h"
+#include "nrf24l01p.h"
+
+namespace devices::rf
+{
+	/**
+	 * Transport layer on top of `NRF24L01` (or `IRQ_NRF24L01`) allowing
+	 * transfer of messages larger than `NRF24L01::PAYLOAD_MAX`, up to
+	 * `MESSAGE_MAX` bytes.
+	 *
+	 * Messages are split into fragments of `FRAGMENT_MAX` bytes, each with
+	 * a small header (message id, fragment index and fragments count).
+	 * The sender transmits a whole window of `WINDOW` fragments without waiting
+	 * for any reply from the receiver; each fragment is still acknowledged
+	 * by the receiver chip.
+	 * The receiver keeps track of all fragments received so far and preloads its
+	 * chip with an ACK payload containing its current state (lowest missing
+	 * fragment and bitmap of fragments received after it); that ACK payload is
+	 * thus sent back with the next acknowledgement, and read by the sender which
+	 * then only retransmits missing fragments before sliding its window forward.
+	 *
+	 * Broadcast messages are not supported, as they are never acknowledged.
+	 *
+	 * Once a message is complete, the receiver keeps answering late fragments
+	 * (or polls) of that message with its final state, as long as `recv()` is
+	 * called, in case the sender missed all preloaded final ACK payloads.
+	 *
+	 * @note this layer uses the chip TX FIFO of the receiver for ACK payloads,
+	 * and the RX FIFO of the sender for received ACK payloads; hence the sender
+	 * should not have pending received payloads when calling `send()`, and the
+	 * receiver should not send anything while receiving a message. ACK payloads
+	 * still pending in TX FIFO are discarded by `send()`.
+	 *
+	 * @tparam RADIO the type of radio driver, one of `NRF24L01` or `IRQ_NRF24L01`
+	 * @tparam WINDOW the number of fragments sent in one go before checking
+	 * receiver state; this must be between 1 and 16.
+	 *
+	 * @sa NRF24L01
+	 * @sa IRQ_NRF24L01
+	 */
+	template<typename RADIO, uint8_t WINDOW = 16> class Transport
+	{
+		static_assert(WINDOW > 0 && WINDOW <= 16, "WINDOW must be between 1 and 16");
+
+	public:
+		/** Maximum size of data held by one fragment. */
+		static constexpr const uint8_t FRAGMENT_MAX = RADIO::PAYLOAD_MAX - 3;
+
+		/** Maximum number of fragments in one message. */
+		static constexpr const uint8_t FRAGMENTS_MAX = 255;
+
+		/** Maximum size of one message. */
+		static constexpr const uint16_t MESSAGE_MAX = FRAGMENT_MAX * FRAGMENTS_MAX;
+
+		/**
+		 * Maximum number of consecutive windows without any progress before
+		 * `send()` gives up.
+		 */
+		static constexpr const uint8_t MAX_STALLS = 4;
+
+		/**
+		 * Create a new transport layer on top of @p radio.
+		 * @param radio the radio driver used to actually send and receive fragments;
+		 * it must have been started with `begin()` before any transfer.
+		 */
+		explicit Transport(RADIO& radio) : radio_{radio} {}
+
+		Transport(const Transport&) = delete;
+		Transport& operator=(const Transport&) = delete;
+
+		/**
+		 * Send a message to @p dest device.
+		 * This method blocks until the whole message has been received by @p dest,
+		 * or the transfer has failed.
+		 *
+		 * @param dest destination network address
+		 * @param port device port (or message type)
+		 * @param data pointer to the message content
+		 * @param size size, in bytes, of the message content
+		 * @return @p size or negative error code
+		 * @retval errors::EINVAL if @p dest is broadcast address
+		 * @retval errors::EMSGSIZE if @p size > `MESSAGE_MAX`
+		 * @retval errors::EIO if the receiver did not acknowledge any new fragment
+		 * during `MAX_STALLS` consecutive windows
+		 */
+		int send(uint8_t dest, uint8_t port, const uint8_t* data, uint16_t size);
+
+		/**
+		 * Receive a message and store it into @p buffer.
+		 * This method blocks until a whole message has been received or @p ms
+		 * milliseconds have elapsed.
+		 *
+		 * If this method times out while a message is partially received, the
+		 * next call resumes that message, provided it is passed the same
+		 * @p buffer and @p size; otherwise the partial message is dropped.
+		 *
+		 * @param src source network address
+		 * @param port device port (or message type)
+		 * @param buffer pointer to the buffer receiving the message content
+		 * @param size size, in bytes, of @p buffer
+		 * @param ms maximum time out period; `0` means wait forever
+		 * @return size of received message or negative error code
+		 * @retval errors::ETIME if no complete message was received before
+		 * @p ms elapsed
+		 * @retval errors::EMSGSIZE if a received message does not fit into
+		 * @p buffer
+		 */
+		int recv(uint8_t& src, uint8_t& port, uint8_t* buffer, uint16_t size, uint32_t ms = 0L);
+
+		/**
+		 * Return number of fragments retransmitted by `send()` since this
+		 * transport was created.
+		 */
+		uint16_t get_retransmissions() const
+		{
+			return retransmissions_;
+		}
+
+	private:
+		static constexpr const uint8_t BITMAP_SIZE = (FRAGMENTS_MAX + 8) / 8;
+		static constexpr const uint8_t POLL_MAX = 3;
+		static constexpr const uint8_t ACK_PAYLOADS_MAX = 3;
+
+		// Header of each fragment; index == count means "poll" (no data)
+		struct Header
+		{
+			uint8_t msg_id;
+			uint8_t index;
+			uint8_t count;
+		};
+
+		// Content of receiver ACK payload
+		struct Ack
+		{
+			uint8_t msg_id;
+			uint8_t base;
+			uint16_t bitmap;
+		};
+
+		struct Fragment
+		{
+			Header header;
+			uint8_t data[FRAGMENT_MAX];
+		};
+
+		static bool is_set(const uint8_t* bitmap, uint8_t index)
+		{
+			return bitmap[index / 8] & bits::BV8(index % 8);
+		}
+		static void set(uint8_t* bitmap, uint8_t index)
+		{
+			bitmap[index / 8] |= bits::BV8(index % 8);
+		}
+
+		void read_ack(uint8_t msg_id, uint8_t count, uint8_t* acked);
+		void write_ack(uint8_t count);
+		void write_final_ack(uint8_t msg_id, uint8_t count);
+
+		RADIO& radio_;
+		uint8_t tx_msg_id_ = 0;
+		uint16_t retransmissions_ = 0;
+
+		// Receiver state
+		uint8_t rx_src_ = 0;
+		uint8_t rx_msg_id_ = 0;
+		// Last message completely received, identified by source and message id
+		uint8_t rx_last_src_ = 0;
+		uint8_t rx_last_msg_id_ = 0;
+		uint8_t rx_base_ = 0;
+		uint8_t rx_bitmap_[BITMAP_SIZE];
+		// Size of message being received, known once its last fragment is received
+		uint16_t rx_total_ = 0;
+		// Buffer receiving current message, in case it is resumed after a timeout
+		uint8_t* rx_buffer_ = nullptr;
+		uint16_t rx_size_ = 0;
+	};
+
+	template<typename RADIO, uint8_t WINDOW>
+	int Transport<RADIO, WINDOW>::send(uint8_t dest, uint8_t port, const uint8_t* data, uint16_t size)
+	{
+		if (dest == RADIO::BROADCAST) return errors::EINVAL;
+		if ((data == nullptr) && (size > 0)) return errors::EINVAL;
+		if (size > MESSAGE_MAX) return errors::EMSGSIZE;
+
+		const uint8_t count = (size == 0 ? 1 : uint8_t((size + FRAGMENT_MAX - 1) / FRAGMENT_MAX));
+		// Message id 0 is reserved to mean "no message"
+		if (++tx_msg_id_ == 0) ++tx_msg_id_;
+		const uint8_t msg_id = tx_msg_id_;
+		uint8_t acked[BITMAP_SIZE];
+		memset(acked, 0, sizeof acked);
+		// Discard ACK payloads left in TX FIFO by previous recv(), they would
+		// otherwise be transmitted before our fragments
+		radio_.flush_tx();
+
+		Fragment fragment;
+		fragment.header.msg_id = msg_id;
+		fragment.header.count = count;
+		uint8_t base = 0;
+		uint8_t sent_end = 0;
+		uint8_t stalls = 0;
+		while (base < count)
+		{
+			const uint8_t end = (count - base > WINDOW ? base + WINDOW : count);
+			// Send all fragments of current window that have not been acknowledged yet
+			for (uint8_t index = base; index < end; ++index)
+			{
+				if (is_set(acked, index)) continue;
+				const uint16_t offset = uint16_t(index) * FRAGMENT_MAX;
+				const uint8_t length = (size - offset > FRAGMENT_MAX ? FRAGMENT_MAX : uint8_t(size - offset));
+				fragment.header.index = index;
+				memcpy(fragment.data, data + offset, length);
+				if (index < sent_end)
+					++retransmissions_;
+				else
+					sent_end = index + 1;
+				if (radio_.send_(dest, port, (const uint8_t*) &fragment, sizeof(Header) + length) >= 0)
+					read_ack(msg_id, count, acked);
+			}
+
+			// Poll receiver until its latest state has been received
+			fragment.header.index = count;
+			for (uint8_t poll = 0; poll < POLL_MAX; ++poll)
+			{
+				if (radio_.send_(dest, port, (const uint8_t*) &fragment, sizeof(Header)) >= 0)
+					read_ack(msg_id, count, acked);
+				uint8_t index = base;
+				while (index < end && is_set(acked, index)) ++index;
+				if (index == end) break;
+			}
+
+			// Slide window forward to the first missing fragment
+			uint8_t next = base;
+			while (next < count && is_set(acked, next)) ++next;
+			if (next == base)
+			{
+				if (++stalls >= MAX_STALLS) return errors::EIO;
+			}
+			else
+				stalls = 0;
+			base = next;
+		}
+		return size;
+	}
+
+	template<typename RADIO, uint8_t WINDOW>
+	int Transport<RADIO, WINDOW>::recv(uint8_t& src, uint8_t& port, uint8_t* buffer, uint16_t size, uint32_t ms)
+	{
+		uint32_t start = time::millis();
+		Fragment fragment;
+		// Fragments already received were copied to another buffer
+		if ((buffer != rx_buffer_) || (size != rx_size_)) rx_msg_id_ = 0;
+		rx_buffer_ = buffer;
+		rx_size_ = size;
+		while (true)
+		{
+			uint32_t timeout = 0;
+			if (ms != 0)
+			{
+				uint32_t elapsed = time::since(start);
+				if (elapsed >= ms) return errors::ETIME;
+				timeout = ms - elapsed;
+			}
+			int result = radio_.recv_(src, port, (uint8_t*) &fragment, sizeof fragment, timeout);
+			if (result == errors::ETIME) return result;
+			if (result < int(sizeof(Header))) continue;
+
+			const Header& header = fragment.header;
+			// Invalid header: a message always has at least one fragment
+			if (header.count == 0) continue;
+			// Late fragments (or polls) of a message already completely received
+			if ((header.msg_id == rx_last_msg_id_) && (src == rx_last_src_))
+			{
+				// Sender missed final state: preload it again, unless another
+				// message is being received
+				if (rx_msg_id_ == 0) write_final_ack(header.msg_id, header.count);
+				continue;
+			}
+			// Detect new message
+			if ((header.msg_id != rx_msg_id_) || (src != rx_src_))
+			{
+				rx_src_ = src;
+				rx_msg_id_ = header.msg_id;
+				rx_base_ = 0;
+				memset(rx_bitmap_, 0, sizeof rx_bitmap_);
+				rx_total_ = 0;
+			}
+			if (header.index < header.count && !is_set(rx_bitmap_, header.index))
+			{
+				const uint8_t length = uint8_t(result - sizeof(Header));
+				const uint16_t offset = uint16_t(header.index) * FRAGMENT_MAX;
+				if (offset + length > size)
+				{
+					rx_msg_id_ = 0;
+					return errors::EMSGSIZE;
+				}
+				memcpy(buffer + offset, fragment.data, length);
+				set(rx_bitmap_, header.index);
+				// Last fragment determines total message size
+				if (header.index == header.count - 1) rx_total_ = offset + length;
+				while (rx_base_ < header.count && is_set(rx_bitmap_, rx_base_)) ++rx_base_;
+			}
+			if (rx_base_ == header.count)
+			{
+				// Preload final state for all next acknowledgements, in case the
+				// sender misses the first one
+				write_final_ack(rx_msg_id_, header.count);
+				rx_last_src_ = rx_src_;
+				rx_last_msg_id_ = rx_msg_id_;
+				rx_msg_id_ = 0;
+				return rx_total_;
+			}
+			write_ack(header.count);
+		}
+	}
+
+	/// @cond notdocumented
+	template<typename RADIO, uint8_t WINDOW>
+	void Transport<RADIO, WINDOW>::read_ack(uint8_t msg_id, uint8_t count, uint8_t* acked)
+	{
+		Ack ack;
+		if (radio_.read_ack_payload((uint8_t*) &ack, sizeof ack) != sizeof ack) return;
+		if (ack.msg_id != msg_id) return;
+		for (uint8_t index = 0; index < ack.base && index < count; ++index) set(acked, index);
+		for (uint8_t bit = 0; bit < 16; ++bit)
+		{
+			uint16_t index = ack.base + 1 + bit;
+			if (index >= count) break;
+			if (ack.bitmap & (1U << bit)) set(acked, uint8_t(index));
+		}
+	}
+
+	template<typename RADIO, uint8_t WINDOW> void Transport<RADIO, WINDOW>::write_ack(uint8_t count)
+	{
+		// Bitmap covers the 16 fragments following the lowest missing one
+		Ack ack{rx_msg_id_, rx_base_, 0};
+		for (uint8_t bit = 0; bit < 16; ++bit)
+		{
+			uint16_t index = rx_base_ + 1 + bit;
+			if (index >= count) break;
+			if (is_set(rx_bitmap_, uint8_t(index))) ack.bitmap |= (1U << bit);
+		}
+		radio_.write_ack_payload((const uint8_t*) &ack, sizeof ack);
+	}
+
+	template<typename RADIO, uint8_t WINDOW>
+	void Transport<RADIO, WINDOW>::write_final_ack(uint8_t msg_id, uint8_t count)
+	{
+		// All fragments received: lowest missing fragment is past the last one
+		Ack ack{msg_id, count, 0};
+		radio_.write_ack_payload((const uint8_t*) &ack, sizeof ack, ACK_PAYLOADS_MAX);
+	}
+	/// @endcond
+}
+
+#endif /* NRF24L01_TRANSPORT_HH */
+/// @endcond
@@ -0,0 +1,433 @@
+//   Copyright 2016-2023 Jean-Francois Poilpret
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+/// @cond api
+
+/**
+ * @file
+ * API to play queued melodies in background, fully driven by a timer ISR.
+ */
+#ifndef QUEUED_TONE_PLAYER_HH
+#define QUEUED_TONE_PLAYER_HH
+
+#include "../interrupts.h"
+#include "../queue.h"
+#include "../timer.h"
+#include "../utilities.h"
+#include "tones.h"
+#include "tone_player.h"
+#include "rtttl.h"
+
+/**
+ * Register the necessary ISR (Interrupt Service Routine) for a
+ * `devices::audio::QueuedTonePlayer` to work properly.
+ * @param TIMER_NUM the number of the TIMER feature for the target MCU, used by
+ * @p PLAYER as its time base (this is NOT the timer used to generate tones)
+ * @param PLAYER the `devices::audio::QueuedTonePlayer` type used
+ *
+ * @sa devices::audio::QueuedTonePlayer
+ */
+#define REGISTER_QUEUED_TONE_PLAYER_ISR(TIMER_NUM, PLAYER)                           \
+	ISR(CAT3(TIMER, TIMER_NUM, _COMPA_vect))                                         \
+	{                                                                                \
+		devices::audio::isr_handler_queued_tone_player::tick<TIMER_NUM, PLAYER>();   \
+	}
+
+namespace devices::audio
+{
+	/// @cond notdocumented
+	struct isr_handler_queued_tone_player;
+	/// @endcond
+
+	/**
+	 * This API defines a player of melodies that works fully in background:
+	 * melodies are queued and then played one after the other, from the ISR
+	 * of a timer ticking every millisecond, with no need for the program to
+	 * call any method while playing (contrarily to `AsyncTonePlayer::update()`).
+	 *
+	 * Melodies can be:
+	 * - sequences of `TONE_PLAY`s stored in SRAM, EEPROM or Flash, exactly
+	 * like for `TonePlayer` and `AsyncTonePlayer`
+	 * - `TONE_PLAY`s pushed by the program (or another ISR) to a
+	 * `containers::Queue`, as they are produced; the melody ends when it
+	 * contains `SpecialTone::END` or when the queue gets empty
+	 * - RTTTL strings stored in SRAM or Flash, which are decoded note after note
+	 * from the ISR by an `RTTTLDecoder`
+	 *
+	 * @code
+	 * using GENERATOR = devices::audio::ToneGenerator<board::Timer::TIMER1, board::PWMPin::D9_PB1_OC1A>;
+	 * using PLAYER = devices::audio::QueuedTonePlayer<board::Timer::TIMER1, board::PWMPin::D9_PB1_OC1A, board::Timer::TIMER2>;
+	 * REGISTER_QUEUED_TONE_PLAYER_ISR(2, PLAYER)
+	 * ...
+	 * GENERATOR generator;
+	 * PLAYER player{generator};
+	 * player.play_rtttl(F("Beep:d=4,o=5,b=120:8c,8e,8g,2c6"));
+	 * player.play_flash(MELODY, devices::audio::Beat{120});
+	 * @endcode
+	 *
+	 * @warning Every note start is performed from the ISR, including the
+	 * calculation of timer settings for the note frequency when it is not known
+	 * at compile-time (i.e. for `TonePlay` and RTTTL melodies), which may take
+	 * up to ~200us; melodies in EEPROM should not be played while EEPROM is
+	 * being written, as reading EEPROM waits for the end of any pending write.
+	 *
+	 * @tparam NTIMER the AVR timer to use for the underlying `ToneGenerator`
+	 * @tparam OUTPUT the `board::PWMPin` connected to the buzzer;
+	 * this must be the pin OCnA, where n is the AVR Timer number
+	 * @tparam NTICK_ the AVR timer used as a 1ms time base for playing
+	 * @tparam MAX_MELODIES_ the maximum number of melodies waiting to be played,
+	 * in addition to the melody currently playing
+	 * @tparam TONEPLAY the type used to store melody data, `QTonePlay` by default
+	 *
+	 * @sa REGISTER_QUEUED_TONE_PLAYER_ISR()
+	 * @sa RTTTLDecoder
+	 * @sa AsyncTonePlayer
+	 */
+	template<board::Timer NTIMER, board::PWMPin OUTPUT, board::Timer NTICK_, uint8_t MAX_MELODIES_ = 4,
+			 typename TONEPLAY = QTonePlay<NTIMER, OUTPUT>>
+	class QueuedTonePlayer : public AbstractTonePlayer<NTIMER, OUTPUT, TONEPLAY>
+	{
+		using BASE = AbstractTonePlayer<NTIMER, OUTPUT, TONEPLAY>;
+		using THIS = QueuedTonePlayer<NTIMER, OUTPUT, NTICK_, MAX_MELODIES_, TONEPLAY>;
+
+		static constexpr const uint32_t TICK_US = 1000UL;
+		using CALCULATOR = timer::Calculator<NTICK_>;
+		using PRESCALER = typename CALCULATOR::PRESCALER;
+		using TIMER_TYPE = typename CALCULATOR::TYPE;
+		static constexpr const PRESCALER PRESCALER_ = CALCULATOR::CTC_prescaler(TICK_US);
+		static constexpr const TIMER_TYPE COUNTER_ = CALCULATOR::CTC_counter(PRESCALER_, TICK_US);
+		static_assert(CALCULATOR::is_adequate_for_CTC(PRESCALER_, TICK_US), "NTICK_ cannot tick every 1ms");
+		static_assert(NTICK_ != NTIMER, "NTICK_ must be different from NTIMER");
+
+		// Maximum number of zero-duration steps (instructions) handled in one tick
+		static constexpr const uint8_t MAX_STEPS_PER_TICK = 8;
+
+	public:
+		/** The type of `ToneGenerator` to use as constructor's argument. */
+		using GENERATOR = typename BASE::GENERATOR;
+		/** The type that holds unit of information of a melody. */
+		using TONE_PLAY = typename BASE::TONE_PLAY;
+		/** The type of queue that can be played with `play_queue()`. */
+		using QUEUE = containers::Queue<TONE_PLAY>;
+		/** The AVR timer used as a time base for playing. */
+		static constexpr const board::Timer NTICK = NTICK_;
+
+		/**
+		 * Create a new queued tone player, based on an existing `ToneGenerator`.
+		 * @param tone_generator the `ToneGenerator` used to actually produce
+		 * tones.
+		 */
+		explicit QueuedTonePlayer(GENERATOR& tone_generator)
+			:	BASE{tone_generator}, generator_{tone_generator},
+				timer_{timer::TimerMode::CTC, PRESCALER_, timer::TimerInterrupt::OUTPUT_COMPARE_A}
+		{
+			interrupt::register_handler(*this);
+		}
+
+		/**
+		 * Queue a melody, defined by a sequence of `TONE_PLAY`s stored in SRAM,
+		 * for playing after all melodies already queued.
+		 * @param melody a pointer, in SRAM, to the sequence of `TONE_PLAY` to be
+		 * played; the sequence MUST finish with a `SpecialTone::END`.
+		 * @param beat the tempo (beats per minute) at which the melody shall be
+		 * played; one beat is the duration of a quarter note.
+		 * @retval true if @p melody was queued
+		 * @retval false if the queue of melodies is full
+		 */
+		bool play_sram(const TONE_PLAY* melody, const Beat& beat)
+		{
+			return queue_(Source::SRAM, melody, beat.duration());
+		}
+
+		/**
+		 * Queue a melody, defined by a sequence of `TONE_PLAY`s stored in EEPROM,
+		 * for playing after all melodies already queued.
+		 * @param melody a pointer, in EEPROM, to the sequence of `TONE_PLAY` to be
+		 * played; the sequence MUST finish with a `SpecialTone::END`.
+		 * @param beat the tempo (beats per minute) at which the melody shall be
+		 * played; one beat is the duration of a quarter note.
+		 * @retval true if @p melody was queued
+		 * @retval false if the queue of melodies is full
+		 */
+		bool play_eeprom(const TONE_PLAY* melody, const Beat& beat)
+		{
+			return queue_(Source::EEPROM, melody, beat.duration());
+		}
+
+		/**
+		 * Queue a melody, defined by a sequence of `TONE_PLAY`s stored in Flash,
+		 * for playing after all melodies already queued.
+		 * @param melody a pointer, in Flash, to the sequence of `TONE_PLAY` to be
+		 * played; the sequence MUST finish with a `SpecialTone::END`.
+		 * @param beat the tempo (beats per minute) at which the melody shall be
+		 * played; one beat is the duration of a quarter note.
+		 * @retval true if @p melody was queued
+		 * @retval false if the queue of melodies is full
+		 */
+		bool play_flash(const TONE_PLAY* melody, const Beat& beat)
+		{
+			return queue_(Source::FLASH, melody, beat.duration());
+		}
+
+		/**
+		 * Queue a melody, made of `TONE_PLAY`s pulled one by one from @p queue,
+		 * for playing after all melodies already queued.
+		 * The melody ends when `SpecialTone::END` is pulled or when @p queue
+		 * is empty at the time its next `TONE_PLAY` is needed; the producer
+		 * should thus push `TONE_PLAY`s ahead of time.
+		 * `SpecialTone::REPEAT_START` and `SpecialTone::REPEAT_END` are ignored.
+		 * @param queue the queue of `TONE_PLAY`s to be played
+		 * @param beat the tempo (beats per minute) at which the melody shall be
+		 * played; one beat is the duration of a quarter note.
+		 * @retval true if the melody was queued
+		 * @retval false if the queue of melodies is full
+		 */
+		bool play_queue(QUEUE& queue, const Beat& beat)
+		{
+			Melody melody{Source::QUEUE, beat.duration()};
+			melody.queue = &queue;
+			return queue_(melody);
+		}
+
+		/**
+		 * Queue a melody in RTTTL format, stored in SRAM, for playing after all
+		 * melodies already queued. The tempo is defined by the melody itself.
+		 * @param rtttl the RTTTL string, which must remain available until played
+		 * @retval true if the melody was queued
+		 * @retval false if the queue of melodies is full
+		 * @sa RTTTLDecoder
+		 */
+		bool play_rtttl(const char* rtttl)
+		{
+			Melody melody{Source::RTTTL_SRAM};
+			melody.rtttl = rtttl;
+			return queue_(melody);
+		}
+
+		/**
+		 * Queue a melody in RTTTL format, stored in Flash, for playing after all
+		 * melodies already queued. The tempo is defined by the melody itself.
+		 * @param rtttl the RTTTL string in Flash (e.g. with `F()`)
+		 * @retval true if the melody was queued
+		 * @retval false if the queue of melodies is full
+		 * @sa RTTTLDecoder
+		 */
+		bool play_rtttl(const flash::FlashStorage* rtttl)
+		{
+			Melody melody{Source::RTTTL_FLASH};
+			melody.rtttl = (const char*) rtttl;
+			return queue_(melody);
+		}
+
+		/**
+		 * Immediately stop playing current melody, and remove all queued melodies.
+		 */
+		void stop()
+		{
+			synchronized stop_();
+		}
+
+		/**
+		 * Tell if a melody is currently playing.
+		 */
+		bool is_playing() const
+		{
+			return status_ != Status::IDLE;
+		}
+
+	private:
+		enum class Status : uint8_t
+		{
+			IDLE = 0,
+			NEXT_MELODY,
+			PLAYING_NOTE,
+			PLAYING_INTERNOTE
+		};
+
+		enum class Source : uint8_t
+		{
+			SRAM = 0,
+			EEPROM,
+			FLASH,
+			QUEUE,
+			RTTTL_SRAM,
+			RTTTL_FLASH
+		};
+
+		struct Melody
+		{
+			Melody() = default;
+			explicit Melody(Source source, uint16_t min_duration = 0)
+				:	source{source}, min_duration{min_duration} {}
+
+			Source source = Source::SRAM;
+			uint16_t min_duration = 0;
+			union
+			{
+				const TONE_PLAY* tones = nullptr;
+				QUEUE* queue;
+				const char* rtttl;
+			};
+		};
+
+		bool queue_(Source source, const TONE_PLAY* tones, uint16_t min_duration)
+		{
+			Melody melody{source, min_duration};
+			melody.tones = tones;
+			return queue_(melody);
+		}
+
+		bool queue_(const Melody& melody)
+		{
+			synchronized
+			{
+				if (!melodies_.push_(melody)) return false;
+				if (status_ == Status::IDLE)
+				{
+					status_ = Status::NEXT_MELODY;
+					remaining_ms_ = 0;
+					timer_.begin_(COUNTER_);
+				}
+			}
+			return true;
+		}
+
+		void stop_()
+		{
+			timer_.end_();
+			generator_.stop_tone();
+			melodies_.clear_();
+			decoder_.end();
+			status_ = Status::IDLE;
+		}
+
+		bool start_melody_()
+		{
+			Melody melody;
+			while (melodies_.pull_(melody))
+			{
+				switch (melody.source)
+				{
+					case Source::SRAM:
+					this->prepare_sram(melody.tones);
+					break;
+
+					case Source::EEPROM:
+					this->prepare_eeprom(melody.tones);
+					break;
+
+					case Source::FLASH:
+					this->prepare_flash(melody.tones);
+					break;
+
+					case Source::QUEUE:
+					stream_ = melody.queue;
+					this->prepare_stream(load_queue);
+					break;
+
+					case Source::RTTTL_SRAM:
+					case Source::RTTTL_FLASH:
+					if (melody.source == Source::RTTTL_FLASH
+						? !decoder_.begin((const flash::FlashStorage*) melody.rtttl)
+						: !decoder_.begin(melody.rtttl))
+						continue;
+					melody.min_duration = decoder_.min_duration();
+					this->prepare_stream(load_rtttl);
+					break;
+				}
+				this->set_min_duration(melody.min_duration);
+				return true;
+			}
+			return false;
+		}
+
+		void on_tick()
+		{
+			if (remaining_ms_ && --remaining_ms_) return;
+			// Handle all steps that need no delay (instructions, end of melody)
+			for (uint8_t steps = 0; steps < MAX_STEPS_PER_TICK; ++steps)
+			{
+				uint16_t delay;
+				if (status_ == Status::PLAYING_NOTE)
+				{
+					delay = this->stop_current_note();
+					status_ = Status::PLAYING_INTERNOTE;
+				}
+				else
+				{
+					if (status_ == Status::NEXT_MELODY && !start_melody_())
+					{
+						stop_();
+						return;
+					}
+					delay = this->start_next_note();
+					status_ = (this->is_finished() ? Status::NEXT_MELODY : Status::PLAYING_NOTE);
+				}
+				if (delay)
+				{
+					remaining_ms_ = delay;
+					return;
+				}
+			}
+		}
+
+		static const TONE_PLAY* load_queue(const TONE_PLAY* address UNUSED, TONE_PLAY& holder)
+		{
+			THIS* player = interrupt::HandlerHolder<THIS>::handler();
+			if (!player->stream_->pull_(holder)) holder = TONE_PLAY{SpecialTone::END};
+			return &holder;
+		}
+
+		static const TONE_PLAY* load_rtttl(const TONE_PLAY* address UNUSED, TONE_PLAY& holder)
+		{
+			THIS* player = interrupt::HandlerHolder<THIS>::handler();
+			Tone tone;
+			Duration duration;
+			if (player->decoder_.next(tone, duration))
+				holder = TONE_PLAY{tone, duration};
+			else
+				holder = TONE_PLAY{SpecialTone::END};
+			return &holder;
+		}
+
+		GENERATOR& generator_;
+		timer::Timer<NTICK_> timer_;
+
+		// One more slot since Queue can hold only SIZE - 1 items
+		Melody buffer_[MAX_MELODIES_ + 1];
+		containers::Queue<Melody> melodies_{buffer_};
+		QUEUE* stream_ = nullptr;
+		RTTTLDecoder decoder_;
+
+		volatile Status status_ = Status::IDLE;
+		uint16_t remaining_ms_ = 0;
+
+		friend struct isr_handler_queued_tone_player;
+	};
+
+	/// @cond notdocumented
+	struct isr_handler_queued_tone_player
+	{
+		template<uint8_t TIMER_NUM_, typename PLAYER_> static void tick()
+		{
+			static constexpr board::Timer NTIMER = timer::isr_handler::check_timer<TIMER_NUM_>();
+			static_assert(NTIMER == PLAYER_::NTICK, "TIMER_NUM must match PLAYER tick timer");
+			interrupt::HandlerHolder<PLAYER_>::handler()->on_tick();
+		}
+	};
+	/// @endcond
+}
+
+#endif /* QUEUED_TONE_PLAYER_HH */
+/// @endcond
@@ -0,0 +1,282 @@
+//   Copyright 2016-2023 Jean-Francois Poilpret
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+/// @cond api
+
+/**
+ * @file
+ * Incremental decoder of melodies in RTTTL (Ring Tone Text Transfer Language)
+ * format.
+ */
+#ifndef RTTTL_HH
+#define RTTTL_HH
+
+#include "../flash.h"
+#include "tones.h"
+#include "tone_player.h"
+
+namespace devices::audio
+{
+	/**
+	 * Incremental decoder of RTTTL melodies, e.g.
+	 * `"Beep:d=4,o=5,b=120:8c,8e,8g,2c6"`.
+	 *
+	 * The RTTTL string is never copied nor fully parsed: each call to `next()`
+	 * decodes only the next note; this allows playing RTTTL melodies directly
+	 * from an ISR (see `QueuedTonePlayer`), with no more SRAM than this decoder.
+	 *
+	 * RTTTL octaves use scientific pitch notation (`a4` is 440Hz); supported
+	 * octaves are 3 to 7, other octaves are clamped to this range.
+	 *
+	 * @sa QueuedTonePlayer
+	 */
+	class RTTTLDecoder
+	{
+	public:
+		RTTTLDecoder() = default;
+		RTTTLDecoder(const RTTTLDecoder&) = delete;
+		RTTTLDecoder& operator=(const RTTTLDecoder&) = delete;
+
+		/**
+		 * Start decoding @p rtttl melody, stored in SRAM.
+		 * The melody header (name and defaults) is parsed immediately.
+		 * @param rtttl the RTTTL string, it must remain available until
+		 * decoding is finished
+		 * @retval true if the header was successfully parsed
+		 * @retval false if the header is malformed; `next()` will then return
+		 * `false` immediately
+		 */
+		bool begin(const char* rtttl)
+		{
+			return begin_(rtttl, false);
+		}
+
+		/**
+		 * Start decoding @p rtttl melody, stored in Flash (e.g. with `F()`).
+		 * The melody header (name and defaults) is parsed immediately.
+		 * @param rtttl the RTTTL string in Flash
+		 * @retval true if the header was successfully parsed
+		 * @retval false if the header is malformed; `next()` will then return
+		 * `false` immediately
+		 */
+		bool begin(const flash::FlashStorage* rtttl)
+		{
+			return begin_((const char*) rtttl, true);
+		}
+
+		/**
+		 * Stop decoding current melody; `next()` will return `false` from now on.
+		 */
+		void end()
+		{
+			next_ = nullptr;
+		}
+
+		/**
+		 * Indicate if the current melody has been fully decoded.
+		 */
+		bool is_finished() const
+		{
+			return next_ == nullptr;
+		}
+
+		/**
+		 * The duration, in milliseconds, of a 32nd note, as calculated from
+		 * the `b=` (beats per minute) default of the melody header.
+		 * This is the value to use with `AbstractTonePlayer::set_min_duration()`.
+		 */
+		uint16_t min_duration() const
+		{
+			return t32_duration_ms_;
+		}
+
+		/**
+		 * Decode the next note of the current melody.
+		 * @param tone the decoded tone (`Tone::SILENCE` for a pause)
+		 * @param duration the decoded duration
+		 * @retval true if a note was decoded
+		 * @retval false if the melody is finished or a malformed note was met
+		 */
+		bool next(Tone& tone, Duration& duration)
+		{
+			if (next_ == nullptr) return false;
+			skip_separators_();
+			if (peek_() == 0) return finish_();
+
+			uint8_t units = duration_units_(number_());
+			if (units == 0) units = default_units_;
+			const char note = lower_(get_());
+			uint8_t semitone;
+			switch (note)
+			{
+				case 'c': semitone = 0; break;
+				case 'd': semitone = 2; break;
+				case 'e': semitone = 4; break;
+				case 'f': semitone = 5; break;
+				case 'g': semitone = 7; break;
+				case 'a': semitone = 9; break;
+				case 'b': semitone = 11; break;
+				case 'p': semitone = PAUSE; break;
+				default: return finish_();
+			}
+			if (peek_() == '#' || peek_() == '_')
+			{
+				get_();
+				if (semitone != PAUSE) ++semitone;
+			}
+			bool dot = skip_('.');
+			uint8_t octave = default_octave_;
+			if (is_digit_(peek_())) octave = get_() - '0';
+			dot = skip_('.') || dot;
+
+			duration = (dot ? dotted(Duration(units)) : Duration(units));
+			tone = (semitone == PAUSE ? Tone::SILENCE : frequency_(semitone, octave));
+			return true;
+		}
+
+	private:
+		static constexpr const uint8_t PAUSE = 0xFF;
+		static constexpr const uint8_t DEFAULT_UNITS = uint8_t(Duration::QUARTER);
+		static constexpr const uint8_t DEFAULT_OCTAVE = 6;
+		static constexpr const uint16_t DEFAULT_BPM = 63;
+		static constexpr const uint8_t MIN_OCTAVE = 3;
+		static constexpr const uint8_t MAX_OCTAVE = 7;
+
+		bool begin_(const char* rtttl, bool flash)
+		{
+			next_ = rtttl;
+			flash_ = flash;
+			default_units_ = DEFAULT_UNITS;
+			default_octave_ = DEFAULT_OCTAVE;
+			uint16_t bpm = DEFAULT_BPM;
+
+			// Skip name
+			char c;
+			while ((c = get_()) != ':')
+				if (c == 0) return finish_();
+			// Parse defaults
+			while ((c = lower_(get_())) != ':')
+			{
+				if (c == 0) return finish_();
+				if (c == ',' || c == ' ') continue;
+				if (!skip_('=')) return finish_();
+				const uint16_t value = number_();
+				switch (c)
+				{
+					case 'd':
+					if (duration_units_(value)) default_units_ = duration_units_(value);
+					break;
+
+					case 'o':
+					default_octave_ = uint8_t(value);
+					break;
+
+					case 'b':
+					if (value) bpm = value;
+					break;
+
+					default:
+					break;
+				}
+			}
+			// bpm defines the duration of a quarter note; we want a 32nd note
+			t32_duration_ms_ = (60U * 1000U / 8U) / bpm;
+			return true;
+		}
+
+		bool finish_()
+		{
+			next_ = nullptr;
+			return false;
+		}
+
+		char peek_() const
+		{
+			return (flash_ ? char(pgm_read_byte(next_)) : *next_);
+		}
+
+		char get_()
+		{
+			const char c = peek_();
+			// Never move past the end of string
+			if (c) ++next_;
+			return c;
+		}
+
+		bool skip_(char c)
+		{
+			if (peek_() != c) return false;
+			get_();
+			return true;
+		}
+
+		void skip_separators_()
+		{
+			while (peek_() == ',' || peek_() == ' ') get_();
+		}
+
+		uint16_t number_()
+		{
+			uint16_t value = 0;
+			while (is_digit_(peek_())) value = value * 10 + (get_() - '0');
+			return value;
+		}
+
+		static bool is_digit_(char c)
+		{
+			return c >= '0' && c <= '9';
+		}
+
+		static char lower_(char c)
+		{
+			return (c >= 'A' && c <= 'Z') ? char(c - 'A' + 'a') : c;
+		}
+
+		// Convert RTTTL duration (1, 2, 4, 8, 16, 32) to a number of 32nd notes
+		static uint8_t duration_units_(uint16_t value)
+		{
+			uint8_t units = 32;
+			for (uint16_t d = 1; d <= 32; d <<= 1, units >>= 1)
+				if (value == d) return units;
+			return 0;
+		}
+
+		static Tone frequency_(uint8_t semitone, uint8_t octave)
+		{
+			// Frequencies of octave 3 (Tone::C0 to Tone::B0)
+			static const uint16_t FREQUENCIES[] PROGMEM =
+			{
+				131, 139, 147, 156, 165, 175, 185, 196, 208, 220, 233, 247
+			};
+			// Handle B#
+			if (semitone >= 12)
+			{
+				semitone -= 12;
+				++octave;
+			}
+			if (octave < MIN_OCTAVE) octave = MIN_OCTAVE;
+			if (octave > MAX_OCTAVE) octave = MAX_OCTAVE;
+			return Tone(pgm_read_word(&FREQUENCIES[semitone]) << (octave - MIN_OCTAVE));
+		}
+
+		const char* next_ = nullptr;
+		bool flash_ = false;
+		uint8_t default_units_ = DEFAULT_UNITS;
+		uint8_t default_octave_ = DEFAULT_OCTAVE;
+		uint16_t t32_duration_ms_ = 0U;
+	};
+}
+
+#endif /* RTTTL_HH */
+/// @endcond
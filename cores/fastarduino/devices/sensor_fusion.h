@@ -0,0 +1,476 @@
+//   Copyright 2016-2023 Jean-Francois Poilpret
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+/// @cond api
+
+/**
+ * @file
+ * API for orientation estimation (sensor fusion) from MPU6050 accelerometer
+ * and gyroscope measurements, optionally combined with magnetometer (e.g.
+ * HMC5883L) measurements.
+ * All computations use fixed-point math only (see fixmath.h).
+ */
+#ifndef SENSOR_FUSION_HH
+#define SENSOR_FUSION_HH
+
+#include "../fixmath.h"
+#include "common_magneto.h"
+#include "mpu6050.h"
+
+namespace devices::magneto
+{
+	/**
+	 * Orientation of a device as Euler angles (aerospace sequence), each angle
+	 * being a binary angle (`65536` is 360 degrees).
+	 * @sa fixmath
+	 */
+	struct EulerAngles
+	{
+		/** Rotation around X axis, in range [-180, 180[ degrees. */
+		int16_t roll;
+		/** Rotation around Y axis, in range [-90, 90] degrees. */
+		int16_t pitch;
+		/** Rotation around Z axis, in range [-180, 180[ degrees. */
+		int16_t yaw;
+	};
+
+	/**
+	 * Orientation of a device as a unit quaternion, each component being a
+	 * Q30 fixed-point value.
+	 * @sa fixmath
+	 */
+	struct Quaternion
+	{
+		/** Scalar component. */
+		int32_t w;
+		/** X component. */
+		int32_t x;
+		/** Y component. */
+		int32_t y;
+		/** Z component. */
+		int32_t z;
+	};
+
+	/**
+	 * Complementary filter estimating roll and pitch of a device from its
+	 * accelerometer and gyroscope raw measurements.
+	 *
+	 * At each update, gyroscope rates are integrated, then the result is
+	 * slightly pulled towards the angles computed from the gravity vector
+	 * measured by the accelerometer. This is the cheapest orientation filter,
+	 * but it cannot estimate yaw.
+	 *
+	 * @tparam GYRO_RANGE_ the range of the MPU6050 gyroscope, as passed to
+	 * `MPU6050::begin()`
+	 * @tparam RATE_ the rate (in Hz) at which samples are provided to `update()`
+	 * @tparam ALPHA_SHIFT_ the weight of accelerometer angles at each update is
+	 * `1 / 2^ALPHA_SHIFT_`; the higher the value, the less sensitive the filter
+	 * is to linear accelerations, but the slower it corrects gyroscope drift.
+	 *
+	 * @sa MahonyFilter
+	 */
+	template<GyroRange GYRO_RANGE_, uint16_t RATE_, uint8_t ALPHA_SHIFT_ = 6>
+	class ComplementaryFilter
+	{
+		static_assert(RATE_ > 0, "RATE_ must be strictly positive");
+		static_assert(ALPHA_SHIFT_ > 0 && ALPHA_SHIFT_ < 16, "ALPHA_SHIFT_ must be in range [1..15]");
+
+		// Binary angle (Q16, i.e. with 16 more fractional bits) per gyroscope LSB and per update
+		static constexpr double GYRO_STEP_ =
+			GYRO_RANGE_DPS(GYRO_RANGE_) / 32768.0 / RATE_ * 65536.0 / 360.0 * 65536.0;
+		static_assert(GYRO_STEP_ < 65536.0, "RATE_ is too low for GYRO_RANGE_");
+		static constexpr int32_t GYRO_STEP = int32_t(GYRO_STEP_ + 0.5);
+
+	public:
+		/// @cond notdocumented
+		ComplementaryFilter(const ComplementaryFilter&) = delete;
+		ComplementaryFilter& operator=(const ComplementaryFilter&) = delete;
+		/// @endcond
+
+		/**
+		 * Create a new complementary filter, with an initial orientation
+		 * of 0 roll and 0 pitch.
+		 */
+		ComplementaryFilter() = default;
+
+		/**
+		 * Reset the filter with orientation computed from accelerometer
+		 * measurements only.
+		 */
+		void reset(const Sensor3D& accel)
+		{
+			roll_ = uint32_t(accel_roll(accel)) << 16;
+			pitch_ = uint32_t(accel_pitch(accel)) << 16;
+		}
+
+		/**
+		 * Update orientation estimation with new raw measurements.
+		 * @param accel raw accelerometer measurements
+		 * @param gyro raw gyroscope measurements
+		 */
+		void update(const Sensor3D& accel, const Sensor3D& gyro)
+		{
+			roll_ = blend(roll_ + uint32_t(int32_t(gyro.x) * GYRO_STEP), accel_roll(accel));
+			pitch_ = blend(pitch_ + uint32_t(int32_t(gyro.y) * GYRO_STEP), accel_pitch(accel));
+		}
+
+		/**
+		 * Update orientation estimation with new raw measurements.
+		 * @param sample raw accelerometer and gyroscope measurements
+		 */
+		void update(const AllSensors& sample)
+		{
+			update(sample.accel, sample.gyro);
+		}
+
+		/**
+		 * Update orientation estimation with a batch of raw measurements, e.g.
+		 * read at once from MPU6050 FIFO.
+		 * @param samples pointer to the first sample of the batch
+		 * @param count number of samples in the batch
+		 */
+		void update(const AllSensors* samples, uint8_t count)
+		{
+			while (count--) update(*samples++);
+		}
+
+		/**
+		 * Current estimation of roll, as a binary angle.
+		 */
+		int16_t roll() const
+		{
+			return int16_t(roll_ >> 16);
+		}
+
+		/**
+		 * Current estimation of pitch, as a binary angle.
+		 */
+		int16_t pitch() const
+		{
+			return int16_t(pitch_ >> 16);
+		}
+
+	private:
+		static int16_t accel_roll(const Sensor3D& accel)
+		{
+			return fixmath::atan2(accel.y, accel.z);
+		}
+
+		static int16_t accel_pitch(const Sensor3D& accel)
+		{
+			// Halve both values as magnitude of (y, z) may exceed int16_t range
+			const uint16_t yz = fixmath::hypot(accel.y, accel.z);
+			return fixmath::atan2(int16_t(-(accel.x >> 1)), int16_t(yz >> 1));
+		}
+
+		static uint32_t blend(uint32_t angle, int16_t target)
+		{
+			// Difference is computed on binary angles to properly handle wrap around
+			const int16_t delta = int16_t(target - int16_t(angle >> 16));
+			return angle + uint32_t(int32_t(delta) << (16 - ALPHA_SHIFT_));
+		}
+
+		// Binary angles with 16 more fractional bits
+		uint32_t roll_ = 0;
+		uint32_t pitch_ = 0;
+	};
+
+	/**
+	 * Mahony filter estimating full orientation (as a quaternion) of a device
+	 * from its accelerometer and gyroscope raw measurements (IMU), and optionally
+	 * magnetometer raw measurements (MARG).
+	 *
+	 * At each update, the orientation quaternion is rotated by gyroscope rates,
+	 * corrected by a proportional-integral feedback on the error between
+	 * gravity (and magnetic field) directions, as measured and as estimated from
+	 * the current quaternion. The integral term compensates gyroscope bias.
+	 *
+	 * This filter is similar in precision to Madgwick filter but is cheaper to
+	 * compute; all computations use only 16x16 bits multiplications except
+	 * normalization of accelerometer and magnetometer vectors, which needs one
+	 * division each. This makes it suitable for update rates of 200Hz or more
+	 * on an ATmega328 at 16MHz.
+	 *
+	 * @tparam GYRO_RANGE_ the range of the MPU6050 gyroscope, as passed to
+	 * `MPU6050::begin()`
+	 * @tparam RATE_ the rate (in Hz) at which samples are provided to `update()`
+	 * @tparam KP_ the proportional gain, in thousandths
+	 * @tparam KI_ the integral gain, in thousandths; `0` disables gyroscope
+	 * bias compensation.
+	 *
+	 * @sa ComplementaryFilter
+	 */
+	template<GyroRange GYRO_RANGE_, uint16_t RATE_, uint16_t KP_ = 1000, uint16_t KI_ = 0>
+	class MahonyFilter
+	{
+		static_assert(RATE_ >= 16, "RATE_ must be at least 16Hz");
+
+		// Gyroscope LSB in rad/s
+		static constexpr double GYRO_LSB = GYRO_RANGE_DPS(GYRO_RANGE_) * 3.14159265358979 / 180.0 / 32768.0;
+		// Half rotation angle (Q30) per gyroscope LSB and per update
+		static constexpr double GYRO_STEP_ = GYRO_LSB / 2.0 / RATE_ * 1073741824.0;
+		static_assert(GYRO_STEP_ < 65536.0, "RATE_ is too low for GYRO_RANGE_");
+		static constexpr int32_t GYRO_STEP = int32_t(GYRO_STEP_ + 0.5);
+		// Half rotation angle (Q30) per Q15 error, shifted by 4
+		static constexpr double KP_STEP_ = KP_ / 1000.0 / 2.0 / RATE_ * 524288.0;
+		static_assert(KP_STEP_ < 16384.0, "KP_ is too high for RATE_");
+		static constexpr int32_t KP_STEP = int32_t(KP_STEP_ + 0.5);
+		// Integral (Q24 rad/s) per Q15 error, shifted by 16
+		static constexpr double KI_STEP_ = KI_ / 1000.0 / RATE_ * 33554432.0;
+		static_assert(KI_STEP_ < 32768.0, "KI_ is too high for RATE_");
+		static constexpr int32_t KI_STEP = int32_t(KI_STEP_ + 0.5);
+		// Half rotation angle (Q30) per integral (Q24 rad/s), shifted by 8
+		static constexpr int32_t INTEGRAL_STEP = int32_t(8192.0 / RATE_ + 0.5);
+		// Limit of integral term (16 rad/s) to avoid overflows
+		static constexpr int32_t INTEGRAL_LIMIT = 1L << 28;
+
+	public:
+		/// @cond notdocumented
+		MahonyFilter(const MahonyFilter&) = delete;
+		MahonyFilter& operator=(const MahonyFilter&) = delete;
+		/// @endcond
+
+		/**
+		 * Create a new Mahony filter, with an initial orientation matching
+		 * device axes.
+		 */
+		MahonyFilter() = default;
+
+		/**
+		 * Reset the filter to its initial state.
+		 */
+		void reset()
+		{
+			q_ = Quaternion{fixmath::Q30_ONE, 0, 0, 0};
+			integral_ = Integral{};
+		}
+
+		/**
+		 * Update orientation estimation with new raw IMU measurements.
+		 * @param accel raw accelerometer measurements
+		 * @param gyro raw gyroscope measurements
+		 */
+		void update(const Sensor3D& accel, const Sensor3D& gyro)
+		{
+			const Matrix r = rotation();
+			Vector error{};
+			Vector a;
+			if (normalize(accel, a))
+				// Error between measured and estimated directions of gravity
+				add_cross(error, a, Vector{r.m[2][0], r.m[2][1], r.m[2][2]});
+			integrate(gyro, error);
+		}
+
+		/**
+		 * Update orientation estimation with new raw MARG measurements.
+		 * Magnetometer axes must be aligned with accelerometer and gyroscope axes.
+		 * @param accel raw accelerometer measurements
+		 * @param gyro raw gyroscope measurements
+		 * @param magneto raw magnetometer measurements
+		 */
+		void update(const Sensor3D& accel, const Sensor3D& gyro, const Sensor3D& magneto)
+		{
+			const Matrix r = rotation();
+			Vector error{};
+			Vector a;
+			if (normalize(accel, a))
+				add_cross(error, a, Vector{r.m[2][0], r.m[2][1], r.m[2][2]});
+			Vector m;
+			if (normalize(magneto, m))
+			{
+				// Magnetic field in earth frame, then projected to North and Down only
+				const int16_t hx = dot(r.m[0], m);
+				const int16_t hy = dot(r.m[1], m);
+				const int16_t bx = fixmath::saturate_q15(fixmath::hypot(hx, hy));
+				const int16_t bz = dot(r.m[2], m);
+				// Estimated direction of magnetic field in device frame
+				const Vector w{
+					mul_add(r.m[0][0], bx, r.m[2][0], bz),
+					mul_add(r.m[0][1], bx, r.m[2][1], bz),
+					mul_add(r.m[0][2], bx, r.m[2][2], bz)};
+				add_cross(error, m, w);
+			}
+			integrate(gyro, error);
+		}
+
+		/**
+		 * Update orientation estimation with new raw IMU measurements.
+		 * @param sample raw accelerometer and gyroscope measurements
+		 */
+		void update(const AllSensors& sample)
+		{
+			update(sample.accel, sample.gyro);
+		}
+
+		/**
+		 * Update orientation estimation with a batch of raw IMU measurements,
+		 * e.g. read at once from MPU6050 FIFO.
+		 * @param samples pointer to the first sample of the batch
+		 * @param count number of samples in the batch
+		 */
+		void update(const AllSensors* samples, uint8_t count)
+		{
+			while (count--) update(*samples++);
+		}
+
+		/**
+		 * Current estimation of orientation, as a unit quaternion.
+		 */
+		const Quaternion& quaternion() const
+		{
+			return q_;
+		}
+
+		/**
+		 * Current estimation of orientation, as Euler angles.
+		 * Note that yaw is meaningful only if the filter is updated with
+		 * magnetometer measurements.
+		 */
+		EulerAngles euler() const
+		{
+			const Matrix r = rotation();
+			return EulerAngles{
+				fixmath::atan2(r.m[2][1], r.m[2][2]),
+				fixmath::asin(-r.m[2][0]),
+				fixmath::atan2(r.m[1][0], r.m[0][0])};
+		}
+
+	private:
+		// Q15 vectors and matrices
+		struct Vector
+		{
+			int16_t x;
+			int16_t y;
+			int16_t z;
+		};
+		struct Matrix
+		{
+			int16_t m[3][3];
+		};
+
+		static int16_t dot(const int16_t (&row)[3], const Vector& v)
+		{
+			return fixmath::saturate_q15(
+				(int32_t(row[0]) * v.x + int32_t(row[1]) * v.y + int32_t(row[2]) * v.z) >> 15);
+		}
+
+		static int16_t mul_add(int16_t a1, int16_t b1, int16_t a2, int16_t b2)
+		{
+			return fixmath::saturate_q15((int32_t(a1) * b1 + int32_t(a2) * b2) >> 15);
+		}
+
+		static void add_cross(Vector& result, const Vector& a, const Vector& b)
+		{
+			result.x += int16_t((int32_t(a.y) * b.z - int32_t(a.z) * b.y) >> 15);
+			result.y += int16_t((int32_t(a.z) * b.x - int32_t(a.x) * b.z) >> 15);
+			result.z += int16_t((int32_t(a.x) * b.y - int32_t(a.y) * b.x) >> 15);
+		}
+
+		// Normalize raw measurements to a Q15 unit vector
+		static bool normalize(const Sensor3D& raw, Vector& unit)
+		{
+			const int32_t inverse = fixmath::inverse_norm(raw.x, raw.y, raw.z);
+			if (inverse == 0) return false;
+			unit.x = fixmath::saturate_q15((raw.x * inverse) >> 15);
+			unit.y = fixmath::saturate_q15((raw.y * inverse) >> 15);
+			unit.z = fixmath::saturate_q15((raw.z * inverse) >> 15);
+			return true;
+		}
+
+		// Rotation matrix (device to earth frame) from current quaternion
+		Matrix rotation() const
+		{
+			using fixmath::mul_q30;
+			using fixmath::saturate_q15;
+			const int32_t xx = mul_q30(q_.x, q_.x);
+			const int32_t yy = mul_q30(q_.y, q_.y);
+			const int32_t zz = mul_q30(q_.z, q_.z);
+			const int32_t xy = mul_q30(q_.x, q_.y);
+			const int32_t xz = mul_q30(q_.x, q_.z);
+			const int32_t yz = mul_q30(q_.y, q_.z);
+			const int32_t wx = mul_q30(q_.w, q_.x);
+			const int32_t wy = mul_q30(q_.w, q_.y);
+			const int32_t wz = mul_q30(q_.w, q_.z);
+			// 2 * Q30 >> 15 = Q15
+			constexpr int32_t ONE = fixmath::Q30_ONE >> 15;
+			return Matrix{{
+				{saturate_q15(ONE - ((yy + zz) >> 14)), saturate_q15((xy - wz) >> 14), saturate_q15((xz + wy) >> 14)},
+				{saturate_q15((xy + wz) >> 14), saturate_q15(ONE - ((xx + zz) >> 14)), saturate_q15((yz - wx) >> 14)},
+				{saturate_q15((xz - wy) >> 14), saturate_q15((yz + wx) >> 14), saturate_q15(ONE - ((xx + yy) >> 14))}}};
+		}
+
+		static int32_t integrate_integral(int32_t& integral, int16_t error)
+		{
+			if (KI_STEP)
+			{
+				integral += (int32_t(error) * KI_STEP) >> 16;
+				if (integral > INTEGRAL_LIMIT) integral = INTEGRAL_LIMIT;
+				if (integral < -INTEGRAL_LIMIT) integral = -INTEGRAL_LIMIT;
+				return (integral >> 8) * INTEGRAL_STEP;
+			}
+			return 0;
+		}
+
+		// Rotate current quaternion by gyroscope rates corrected by error feedback
+		void integrate(const Sensor3D& gyro, const Vector& error)
+		{
+			using fixmath::mul_q30;
+			// Half rotation angles in Q30
+			const int32_t hx = int32_t(gyro.x) * GYRO_STEP + ((int32_t(error.x) * KP_STEP) >> 4)
+				+ integrate_integral(integral_.x, error.x);
+			const int32_t hy = int32_t(gyro.y) * GYRO_STEP + ((int32_t(error.y) * KP_STEP) >> 4)
+				+ integrate_integral(integral_.y, error.y);
+			const int32_t hz = int32_t(gyro.z) * GYRO_STEP + ((int32_t(error.z) * KP_STEP) >> 4)
+				+ integrate_integral(integral_.z, error.z);
+
+			const Quaternion q = q_;
+			q_.w -= mul_q30(q.x, hx) + mul_q30(q.y, hy) + mul_q30(q.z, hz);
+			q_.x += mul_q30(q.w, hx) + mul_q30(q.y, hz) - mul_q30(q.z, hy);
+			q_.y += mul_q30(q.w, hy) - mul_q30(q.x, hz) + mul_q30(q.z, hx);
+			q_.z += mul_q30(q.w, hz) + mul_q30(q.x, hy) - mul_q30(q.y, hx);
+
+			// Renormalize with one Newton iteration: q *= (3 - |q|^2) / 2
+			const int32_t correction = (fixmath::Q30_ONE - norm2()) >> 1;
+			q_.w += mul_q30(q_.w, correction);
+			q_.x += mul_q30(q_.x, correction);
+			q_.y += mul_q30(q_.y, correction);
+			q_.z += mul_q30(q_.z, correction);
+		}
+
+		static uint32_t square(int32_t value)
+		{
+			// Q30 -> Q15, then square as Q30
+			const uint16_t v = uint16_t((value < 0 ? -value : value) >> 15);
+			return uint32_t(v) * v;
+		}
+
+		int32_t norm2() const
+		{
+			return int32_t(square(q_.w) + square(q_.x) + square(q_.y) + square(q_.z));
+		}
+
+		struct Integral
+		{
+			int32_t x;
+			int32_t y;
+			int32_t z;
+		};
+
+		Quaternion q_ = Quaternion{fixmath::Q30_ONE, 0, 0, 0};
+		Integral integral_ = Integral{};
+	};
+}
+
+#endif /* SENSOR_FUSION_HH */
+/// @endcond
@@ -0,0 +1,315 @@
+//   Copyright 2016-2023 Jean-Francois Poilpret
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+/// @cond api
+
+/**
+ * @file
+ * API to handle daisy-chained "SIPO" (*serial in parallel out*) chips, like
+ * the **74HC595**, through the hardware SPI of the MCU.
+ * This is much faster than bit-banging performed by `devices::SIPO`, but it
+ * requires SPI MOSI and SCK pins to be connected to the first chip.
+ */
+#ifndef SIPO_SPI_HH
+#define SIPO_SPI_HH
+
+#include <string.h>
+#include "../bits.h"
+#include "../spi.h"
+
+namespace devices
+{
+	/**
+	 * This template class supports a chain of SIPO chips, connected to the MCU
+	 * through the SPI bus:
+	 * - SCK is connected to CLOCK pin of all chips
+	 * - MOSI is connected to DATA pin of the first chip of the chain
+	 * - @p LATCH_ is connected to LATCH pin of all chips
+	 *
+	 * Outputs of all chips are held in a framebuffer, where byte `0` maps to the
+	 * first chip of the chain (the one connected to MOSI); the framebuffer is
+	 * shifted to the chips only when it has been modified since last update.
+	 *
+	 * Note that `spi::init()` must be called before using this class.
+	 *
+	 * @tparam LATCH_ the output pin that will tell the chips to copy their shift
+	 * register content to their output pins
+	 * @tparam CHIPS_ the number of chips in the chain
+	 * @tparam RATE_ the SPI clock rate; 74HC595 can be used at the maximum SPI
+	 * rate at 5V.
+	 *
+	 * @sa SIPO
+	 * @sa SIPOMatrixMultiplexer
+	 */
+	template<board::DigitalPin LATCH_, uint8_t CHIPS_,
+			 spi::ClockRate RATE_ = spi::ClockRate::CLOCK_DIV_2>
+	class SPI_SIPO : public spi::SPIDevice<LATCH_, spi::ChipSelect::ACTIVE_LOW, RATE_>
+	{
+		static_assert(CHIPS_ > 0, "CHIPS_ must be at least 1");
+
+	public:
+		/** The output pin that will tell the chips to copy their shift register content to their output pins. */
+		static constexpr const board::DigitalPin LATCH = LATCH_;
+		/** The number of chips in the chain. */
+		static constexpr const uint8_t CHIPS = CHIPS_;
+
+		/// @cond notdocumented
+		SPI_SIPO(const SPI_SIPO&) = delete;
+		SPI_SIPO& operator=(const SPI_SIPO&) = delete;
+		/// @endcond
+
+		/**
+		 * Create a new SIPO chain handler; all outputs are initially cleared
+		 * in the framebuffer, but chips are updated only at first `update()`.
+		 */
+		SPI_SIPO() = default;
+
+		/**
+		 * Get a pointer to the framebuffer, `CHIPS` bytes long, byte `0` mapping
+		 * to the first chip of the chain.
+		 * If you modify the framebuffer directly through this pointer, you must
+		 * then call `invalidate()` for `update()` to take your changes into
+		 * account.
+		 */
+		uint8_t* buffer()
+		{
+			return buffer_;
+		}
+
+		/**
+		 * Get current framebuffer value of all outputs of one chip.
+		 * @param chip the index of the chip in the chain (`0` is the chip connected
+		 * to MOSI)
+		 */
+		uint8_t get(uint8_t chip) const
+		{
+			return buffer_[chip];
+		}
+
+		/**
+		 * Set all outputs of one chip in the framebuffer.
+		 * This does not output anything to the chips until `update()` is called.
+		 * @param chip the index of the chip in the chain (`0` is the chip connected
+		 * to MOSI)
+		 * @param value the new value of all outputs of @p chip
+		 */
+		void set(uint8_t chip, uint8_t value)
+		{
+			if (buffer_[chip] != value)
+			{
+				buffer_[chip] = value;
+				dirty_ = true;
+			}
+		}
+
+		/**
+		 * Set one output of the chain in the framebuffer.
+		 * This does not output anything to the chips until `update()` is called.
+		 * @param output the index of the output in the chain (`0` is `QA` output
+		 * of the chip connected to MOSI, `8` is `QA` output of the next chip...)
+		 * @param level the new level of @p output
+		 */
+		void set_output(uint8_t output, bool level)
+		{
+			const uint8_t chip = output / 8;
+			const uint8_t mask = bits::BV8(output % 8);
+			set(chip, level ? (buffer_[chip] | mask) : (buffer_[chip] & uint8_t(~mask)));
+		}
+
+		/**
+		 * Fill the whole framebuffer from @p data.
+		 * This does not output anything to the chips until `update()` is called.
+		 * @tparam T the type of @p data; its size must be the size of the chain;
+		 * its first byte maps to the first chip in the chain.
+		 */
+		template<typename T> void set(const T& data)
+		{
+			static_assert(sizeof(T) == CHIPS, "T must have the same size as the SIPO chain");
+			if (memcmp(buffer_, &data, CHIPS) != 0)
+			{
+				memcpy(buffer_, &data, CHIPS);
+				dirty_ = true;
+			}
+		}
+
+		/**
+		 * Mark the framebuffer as modified, so that next call to `update()`
+		 * will output it to the chips. This is needed only when the framebuffer
+		 * was directly modified through `buffer()`.
+		 */
+		void invalidate()
+		{
+			dirty_ = true;
+		}
+
+		/**
+		 * Output the framebuffer to the chips and latch it, only if it was
+		 * modified since last time it was output.
+		 * @retval true if the chips were actually updated
+		 * @retval false if the framebuffer was not modified, nothing was output
+		 */
+		bool update()
+		{
+			if (!dirty_) return false;
+			refresh();
+			return true;
+		}
+
+		/**
+		 * Output the framebuffer to the chips and latch it, whether it was
+		 * modified or not.
+		 */
+		void refresh()
+		{
+			dirty_ = false;
+			this->start_transfer();
+			// Last chip of the chain must be shifted first
+			const uint8_t* data = buffer_ + CHIPS;
+			while (data != buffer_) this->transfer(*--data);
+			// Rising edge on LATCH copies shift registers to outputs
+			this->end_transfer();
+		}
+
+	private:
+		uint8_t buffer_[CHIPS] = {};
+		bool dirty_ = true;
+	};
+
+	/**
+	 * This template class handles LED matrix multiplexing through a chain of SIPO
+	 * chips connected to the MCU through the SPI bus (see `SPI_SIPO` for wiring).
+	 *
+	 * The last chip of the chain drives matrix rows (up to 8), all other chips
+	 * (`COLUMN_CHIPS_`) drive matrix columns.
+	 *
+	 * One row is output at each call to `refresh()`, which is aimed at being
+	 * called from a timer ISR, as in the following snippet:
+	 * @code
+	 * using MULTIPLEXER = devices::SIPOMatrixMultiplexer<board::DigitalPin::D10_PB2, 8, 1>;
+	 * REGISTER_TIMER_COMPARE_ISR_METHOD(0, MULTIPLEXER, &MULTIPLEXER::refresh)
+	 *
+	 * int main() {
+	 *     ...
+	 *     spi::init();
+	 *     MULTIPLEXER mux;
+	 *     interrupt::register_handler(mux);
+	 *     // Start timer 0 with a period of 1ms
+	 *     ...
+	 * }
+	 * @endcode
+	 *
+	 * @warning Since `refresh()` uses the SPI bus from an ISR, any SPI transfer
+	 * to other devices from your main program must be performed within a
+	 * `synchronized` block.
+	 *
+	 * @tparam LATCH_ the output pin that will tell the chips to copy their shift
+	 * register content to their output pins
+	 * @tparam ROWS_ the number of rows of the matrix (1 to 8)
+	 * @tparam COLUMN_CHIPS_ the number of chips driving matrix columns, 8 columns
+	 * per chip
+	 * @tparam ROW_ACTIVE_LOW_ `true` if the selected row output must be low and
+	 * all other rows high (e.g. common cathode rows), `false` otherwise
+	 * @tparam RATE_ the SPI clock rate
+	 *
+	 * @sa SPI_SIPO
+	 */
+	template<board::DigitalPin LATCH_, uint8_t ROWS_, uint8_t COLUMN_CHIPS_ = 1, bool ROW_ACTIVE_LOW_ = true,
+			 spi::ClockRate RATE_ = spi::ClockRate::CLOCK_DIV_2>
+	class SIPOMatrixMultiplexer : public spi::SPIDevice<LATCH_, spi::ChipSelect::ACTIVE_LOW, RATE_>
+	{
+		static_assert(ROWS_ > 0 && ROWS_ <= 8, "ROWS_ must be in range [1..8]");
+		static_assert(COLUMN_CHIPS_ > 0, "COLUMN_CHIPS_ must be at least 1");
+
+	public:
+		/** The number of rows of the matrix. */
+		static constexpr const uint8_t ROWS = ROWS_;
+		/** The number of chips driving matrix columns. */
+		static constexpr const uint8_t COLUMN_CHIPS = COLUMN_CHIPS_;
+		/** The number of columns of the matrix. */
+		static constexpr const uint8_t COLUMNS = COLUMN_CHIPS_ * 8;
+
+		/// @cond notdocumented
+		SIPOMatrixMultiplexer(const SIPOMatrixMultiplexer&) = delete;
+		SIPOMatrixMultiplexer& operator=(const SIPOMatrixMultiplexer&) = delete;
+		/// @endcond
+
+		/**
+		 * Create a new matrix multiplexer; all LEDs are initially off.
+		 */
+		SIPOMatrixMultiplexer() = default;
+
+		/**
+		 * Get a pointer to the framebuffer of one row, `COLUMN_CHIPS` bytes long,
+		 * byte `0` mapping to the first chip of the chain.
+		 * The framebuffer can be modified at any time, changes will be visible
+		 * at next refresh of @p row.
+		 */
+		uint8_t* data(uint8_t row)
+		{
+			return data_[row];
+		}
+
+		/**
+		 * Set the level of one LED of the matrix in the framebuffer.
+		 */
+		void set(uint8_t row, uint8_t column, bool level)
+		{
+			uint8_t& data = data_[row][column / 8];
+			const uint8_t mask = bits::BV8(column % 8);
+			if (level)
+				data |= mask;
+			else
+				data &= uint8_t(~mask);
+		}
+
+		/**
+		 * Get the level of one LED of the matrix in the framebuffer.
+		 */
+		bool get(uint8_t row, uint8_t column) const
+		{
+			return data_[row][column / 8] & bits::BV8(column % 8);
+		}
+
+		/**
+		 * Turn off all LEDs of the matrix in the framebuffer.
+		 */
+		void clear()
+		{
+			memset(data_, 0, sizeof data_);
+		}
+
+		/**
+		 * Output the next row of the framebuffer to the SIPO chips.
+		 * This is aimed at being called from a timer ISR; the refresh rate of the
+		 * whole matrix is the timer rate divided by `ROWS`.
+		 */
+		void refresh()
+		{
+			const uint8_t select = bits::BV8(row_);
+			this->start_transfer();
+			this->transfer(ROW_ACTIVE_LOW_ ? uint8_t(~select) : select);
+			const uint8_t* data = data_[row_] + COLUMN_CHIPS;
+			while (data != data_[row_]) this->transfer(*--data);
+			this->end_transfer();
+			if (++row_ == ROWS) row_ = 0;
+		}
+
+	private:
+		uint8_t data_[ROWS][COLUMN_CHIPS] = {};
+		uint8_t row_ = 0;
+	};
+}
+
+#endif /* SIPO_SPI_HH */
+/// @endcond
@@ -531,6 +531,32 @@ namespace devices::audio
 			prepare_(melody, load_flash);
 		}
 
+		/**
+		 * The type of function used to load the next `TONE_PLAY` of a melody.
+		 * @param address the address of the next `TONE_PLAY` to load
+		 * @param holder a `TONE_PLAY` that can be filled by the function
+		 * @return a pointer, in SRAM, to the loaded `TONE_PLAY`
+		 * @sa prepare_stream()
+		 */
+		using LOAD_TONE = const TONE_PLAY* (*) (const TONE_PLAY* address, TONE_PLAY& holder);
+
+		/**
+		 * Prepare playing of a melody that is not stored as a sequence of
+		 * `TONE_PLAY` but produced one `TONE_PLAY` at a time by @p load_tone
+		 * (e.g. pulled from a queue or decoded from another format).
+		 * @p load_tone is called with a meaningless @p address and shall fill
+		 * @p holder with the next `TONE_PLAY` and return its address; the 
+		 * melody ends when @p load_tone returns `SpecialTone::END`.
+		 * Since a streamed melody cannot be rewinded, `SpecialTone::REPEAT_START`
+		 * and `SpecialTone::REPEAT_END` are ignored; ties are supported.
+		 * Once preparation is done, actual melody playing is performed by sequenced
+		 * calls to `start_next_note()` and `stop_current_note()`.
+		 */
+		void prepare_stream(LOAD_TONE load_tone)
+		{
+			prepare_(nullptr, load_tone);
+		}
+
 		/**
 		 * Ask this player to start playing the next note of the melody.
 		 * @return the duration of the next note that just started playing; it is
@@ -571,8 +597,6 @@ namespace devices::audio
 	private:
 		static constexpr const uint16_t INTERTONE_DELAY_MS = 20;
 
-		using LOAD_TONE = const TONE_PLAY* (*) (const TONE_PLAY* address, TONE_PLAY& holder);
-
 		void prepare_(const TONE_PLAY* melody, LOAD_TONE load_tone)
 		{
 			loader_ = load_tone;
@@ -633,7 +657,8 @@ namespace devices::audio
 					no_delay_ = false;
 				delay = duration(current->duration());
 			}
-			++current_play_;
+			// Streamed melodies have no address (hence no possible repeat)
+			if (current_play_ != nullptr) ++current_play_;
 			return delay;
 		}
 
@@ -1483,7 +1483,8 @@ namespace devices::vl53l0x
 			return this->template sync_write<SetRegisterFuture>(value);
 		}
 
-	private:
+	protected:
+		/// @cond notdocumented
 		bool force_io_2_8V()
 		{
 			using READ_VHV_CONFIG = TReadRegisterFuture<Register::VHV_CONFIG_PAD_SCL_SDA_EXTSUP_HV>;
@@ -1897,6 +1898,7 @@ namespace devices::vl53l0x
 
 		// Stop variable used across device invocations
 		uint8_t stop_variable_ = 0;
+		/// @endcond
 	};
 }
 
@@ -0,0 +1,1036 @@
+//   Copyright 2016-2023 Jean-Francois Poilpret
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+/// @cond api
+
+/**
+ * @file
+ * API to initialize VL53L0X Time-of-Flight ranging sensors and perform
+ * continuous ranging, without ever blocking the program: every I2C transaction
+ * is launched from ISR (I2C ISR or VL53L0X GPIO pin ISR) and ranges are
+ * delivered as `events::Event` to the program.
+ * Several sensors can share the same I2C bus, with staggered measurements.
+ */
+#ifndef VL53L0X_ASYNC_H
+#define VL53L0X_ASYNC_H
+
+#include <string.h>
+#include "../events.h"
+#include "../gpio.h"
+#include "../interrupts.h"
+#include "../queue.h"
+#include "vl53l0x.h"
+
+/// @cond notdocumented
+// Scripts executed by VL53L0XAsync; each script is a sequence of actions
+// encoded as per i2c::actions, which mirror the sequences of blocking API
+// in VL53L0X.
+namespace devices::vl53l0x_internals::async
+{
+	using Register = devices::vl53l0x::Register;
+	using GPIOFunction = devices::vl53l0x::GPIOFunction;
+	using FixPoint9_7 = devices::vl53l0x::FixPoint9_7;
+	namespace actions = i2c::actions;
+
+	// Codes following actions::MARKER
+	namespace marker
+	{
+		static constexpr uint8_t VHV_CONFIG = 1;
+		static constexpr uint8_t STOP_VARIABLE_READ = 2;
+		static constexpr uint8_t STOP_VARIABLE_WRITE = 3;
+		static constexpr uint8_t MSRC_CONFIG = 4;
+		static constexpr uint8_t STROBE_SET = 5;
+		static constexpr uint8_t STROBE_CHECK = 6;
+		static constexpr uint8_t STROBE_CLEAR = 7;
+		static constexpr uint8_t SPAD_INFO = 8;
+		static constexpr uint8_t REF_SPADS = 9;
+		static constexpr uint8_t REF_SPADS_WRITE = 10;
+		static constexpr uint8_t TIMEOUTS = 11;
+		static constexpr uint8_t GET_BUDGET = 12;
+		static constexpr uint8_t SET_BUDGET = 13;
+		static constexpr uint8_t AWAIT_SAMPLE = 14;
+		static constexpr uint8_t CHECK_INTERRUPT = 15;
+		static constexpr uint8_t RESTORE_STEPS = 16;
+		static constexpr uint8_t PRE_RANGE_TIMEOUT = 17;
+		static constexpr uint8_t MSRC_TIMEOUT = 18;
+		static constexpr uint8_t FINAL_RANGE_TIMEOUT = 19;
+		static constexpr uint8_t PERIOD = 20;
+		static constexpr uint8_t START = 21;
+		static constexpr uint8_t RANGE = 22;
+	}
+
+	// Codes following actions::INCLUDE (register/value pairs buffers)
+	namespace include
+	{
+		static constexpr uint8_t STOP_VARIABLE_PRE = 0;
+		static constexpr uint8_t STOP_VARIABLE_POST = 1;
+		static constexpr uint8_t SPAD_INFO_1 = 2;
+		static constexpr uint8_t SPAD_INFO_2 = 3;
+		static constexpr uint8_t SPAD_INFO_3 = 4;
+		static constexpr uint8_t SPAD_INFO_4 = 5;
+		static constexpr uint8_t SET_REFERENCE_SPADS = 6;
+		static constexpr uint8_t TUNING_SETTINGS = 7;
+	}
+
+	static constexpr uint8_t STATIC_SEQUENCE_STEPS = 0xE8;	// PRE-RANGE, FINAL-RANGE, DSS
+	static constexpr uint8_t LONG_RANGE_VCSEL_PERIOD_PRE = 18;
+	static constexpr uint8_t LONG_RANGE_VCSEL_PERIOD_FINAL = 14;
+	static constexpr uint16_t DEFAULT_SIGNAL_RATE = FixPoint9_7::convert(0.25f);
+	static constexpr uint16_t LONG_RANGE_SIGNAL_RATE = FixPoint9_7::convert(0.1f);
+
+	// Same as VL53L0X::begin(): init_data_first(), init_static_second() and perform_ref_calibration()
+	static constexpr uint8_t INIT[] PROGMEM =
+	{
+		// 1. Force 2.8V for I/O (instead of default 1.8V)
+		actions::read(1), uint8_t(Register::VHV_CONFIG_PAD_SCL_SDA_EXTSUP_HV),
+		actions::MARKER, marker::VHV_CONFIG,
+		// 2. Set I2C standard mode
+		actions::write(1), uint8_t(Register::SYSTEM_CONFIG_I2C_MODE), 0x00,
+		// 3. Read stop variable
+		actions::INCLUDE, include::STOP_VARIABLE_PRE,
+		actions::read(1), uint8_t(Register::SYSTEM_STOP_VARIABLE),
+		actions::MARKER, marker::STOP_VARIABLE_READ,
+		actions::INCLUDE, include::STOP_VARIABLE_POST,
+		// 4. Disable SIGNAL_RATE_MSRC and SIGNAL_RATE_PRE_RANGE limit checks
+		actions::read(1), uint8_t(Register::MSRC_CONFIG_CONTROL),
+		actions::MARKER, marker::MSRC_CONFIG,
+		// 5. Set signal rate limit to 0.25 MCPS
+		actions::write(2), uint8_t(Register::FINAL_RANGE_CONFIG_MIN_COUNT_RATE_RTN_LIMIT),
+			uint8_t(DEFAULT_SIGNAL_RATE >> 8), uint8_t(DEFAULT_SIGNAL_RATE),
+		// 6. Enable all sequence steps
+		actions::write(1), uint8_t(Register::SYSTEM_SEQUENCE_CONFIG), 0xFF,
+		// 7. Get SPAD info
+		actions::INCLUDE, include::SPAD_INFO_1,
+		actions::read(1), uint8_t(Register::DEVICE_STROBE),
+		actions::MARKER, marker::STROBE_SET,
+		actions::INCLUDE, include::SPAD_INFO_2,
+		actions::write(1), uint8_t(Register::DEVICE_STROBE), 0x00,
+		actions::LOOP,
+		actions::read(1), uint8_t(Register::DEVICE_STROBE),
+		actions::MARKER, marker::STROBE_CHECK,
+		actions::write(1), uint8_t(Register::DEVICE_STROBE), 0x01,
+		actions::read(1), uint8_t(Register::SPAD_INFO),
+		actions::MARKER, marker::SPAD_INFO,
+		actions::INCLUDE, include::SPAD_INFO_3,
+		actions::read(1), uint8_t(Register::DEVICE_STROBE),
+		actions::MARKER, marker::STROBE_CLEAR,
+		actions::INCLUDE, include::SPAD_INFO_4,
+		// 8. Calculate and set reference SPADs
+		actions::read(6), uint8_t(Register::GLOBAL_CONFIG_SPAD_ENABLES_REF_0),
+		actions::MARKER, marker::REF_SPADS,
+		actions::INCLUDE, include::SET_REFERENCE_SPADS,
+		actions::MARKER, marker::REF_SPADS_WRITE,
+		// 9. Load tuning settings
+		actions::INCLUDE, include::TUNING_SETTINGS,
+		// 10. Set GPIO settings: interrupt on sample ready, active low
+		actions::write(1), uint8_t(Register::SYSTEM_INTERRUPT_CONFIG_GPIO), uint8_t(GPIOFunction::SAMPLE_READY),
+		actions::write(1), uint8_t(Register::GPIO_HV_MUX_ACTIVE_HIGH), 0x01,
+		actions::write(2), uint8_t(Register::SYSTEM_THRESH_LOW), 0x00, 0x00,
+		actions::write(2), uint8_t(Register::SYSTEM_THRESH_HIGH), 0x00, 0x00,
+		actions::write(1), uint8_t(Register::SYSTEM_INTERRUPT_CLEAR), 0x00,
+		// 11. Get current timing budget
+		actions::read(1), uint8_t(Register::SYSTEM_SEQUENCE_CONFIG),
+		actions::read(1), uint8_t(Register::PRE_RANGE_CONFIG_VCSEL_PERIOD),
+		actions::read(1), uint8_t(Register::FINAL_RANGE_CONFIG_VCSEL_PERIOD),
+		actions::read(1), uint8_t(Register::MSRC_CONFIG_TIMEOUT_MACROP),
+		actions::read(2), uint8_t(Register::PRE_RANGE_CONFIG_TIMEOUT_MACROP_HI),
+		actions::read(2), uint8_t(Register::FINAL_RANGE_CONFIG_TIMEOUT_MACROP_HI),
+		actions::MARKER, marker::TIMEOUTS,
+		actions::MARKER, marker::GET_BUDGET,
+		// 12. Set sequence steps
+		actions::write(1), uint8_t(Register::SYSTEM_SEQUENCE_CONFIG), STATIC_SEQUENCE_STEPS,
+		// 13. Recalculate timing budget and set it
+		actions::read(1), uint8_t(Register::SYSTEM_SEQUENCE_CONFIG),
+		actions::read(1), uint8_t(Register::PRE_RANGE_CONFIG_VCSEL_PERIOD),
+		actions::read(1), uint8_t(Register::FINAL_RANGE_CONFIG_VCSEL_PERIOD),
+		actions::read(1), uint8_t(Register::MSRC_CONFIG_TIMEOUT_MACROP),
+		actions::read(2), uint8_t(Register::PRE_RANGE_CONFIG_TIMEOUT_MACROP_HI),
+		actions::read(2), uint8_t(Register::FINAL_RANGE_CONFIG_TIMEOUT_MACROP_HI),
+		actions::MARKER, marker::TIMEOUTS,
+		actions::MARKER, marker::SET_BUDGET,
+		// 14. Perform VHV calibration
+		actions::write(1), uint8_t(Register::SYSTEM_SEQUENCE_CONFIG), 0x01,
+		actions::write(1), uint8_t(Register::SYSRANGE_START), 0x41,
+		actions::LOOP,
+		actions::MARKER, marker::AWAIT_SAMPLE,
+		actions::read(1), uint8_t(Register::RESULT_INTERRUPT_STATUS),
+		actions::MARKER, marker::CHECK_INTERRUPT,
+		actions::write(1), uint8_t(Register::SYSTEM_INTERRUPT_CLEAR), 0x01,
+		actions::write(1), uint8_t(Register::SYSRANGE_START), 0x00,
+		// 15. Perform Phase calibration
+		actions::write(1), uint8_t(Register::SYSTEM_SEQUENCE_CONFIG), 0x02,
+		actions::write(1), uint8_t(Register::SYSRANGE_START), 0x01,
+		actions::LOOP,
+		actions::MARKER, marker::AWAIT_SAMPLE,
+		actions::read(1), uint8_t(Register::RESULT_INTERRUPT_STATUS),
+		actions::MARKER, marker::CHECK_INTERRUPT,
+		actions::write(1), uint8_t(Register::SYSTEM_INTERRUPT_CLEAR), 0x01,
+		actions::write(1), uint8_t(Register::SYSRANGE_START), 0x00,
+		// 16. Restore sequence steps
+		actions::MARKER, marker::RESTORE_STEPS,
+		actions::END
+	};
+
+	// Same as VL53L0X::begin() for long range profiles: set_vcsel_pulse_period()
+	// for PRE-RANGE and FINAL-RANGE, then set_signal_rate_limit()
+	static constexpr uint8_t LONG_RANGE[] PROGMEM =
+	{
+		// 1. Get current timing budget
+		actions::read(1), uint8_t(Register::SYSTEM_SEQUENCE_CONFIG),
+		actions::read(1), uint8_t(Register::PRE_RANGE_CONFIG_VCSEL_PERIOD),
+		actions::read(1), uint8_t(Register::FINAL_RANGE_CONFIG_VCSEL_PERIOD),
+		actions::read(1), uint8_t(Register::MSRC_CONFIG_TIMEOUT_MACROP),
+		actions::read(2), uint8_t(Register::PRE_RANGE_CONFIG_TIMEOUT_MACROP_HI),
+		actions::read(2), uint8_t(Register::FINAL_RANGE_CONFIG_TIMEOUT_MACROP_HI),
+		actions::MARKER, marker::TIMEOUTS,
+		actions::MARKER, marker::GET_BUDGET,
+		// 2. Set PRE-RANGE VCSEL period and timeouts
+		actions::write(1), uint8_t(Register::PRE_RANGE_CONFIG_VALID_PHASE_HIGH), 0x50,
+		actions::write(1), uint8_t(Register::PRE_RANGE_CONFIG_VALID_PHASE_LOW), 0x08,
+		actions::write(1), uint8_t(Register::PRE_RANGE_CONFIG_VCSEL_PERIOD),
+			uint8_t((LONG_RANGE_VCSEL_PERIOD_PRE >> 1) - 1),
+		actions::MARKER, marker::PRE_RANGE_TIMEOUT,
+		actions::MARKER, marker::MSRC_TIMEOUT,
+		// 3. Set timing budget as before
+		actions::read(1), uint8_t(Register::SYSTEM_SEQUENCE_CONFIG),
+		actions::read(1), uint8_t(Register::PRE_RANGE_CONFIG_VCSEL_PERIOD),
+		actions::read(1), uint8_t(Register::FINAL_RANGE_CONFIG_VCSEL_PERIOD),
+		actions::read(1), uint8_t(Register::MSRC_CONFIG_TIMEOUT_MACROP),
+		actions::read(2), uint8_t(Register::PRE_RANGE_CONFIG_TIMEOUT_MACROP_HI),
+		actions::read(2), uint8_t(Register::FINAL_RANGE_CONFIG_TIMEOUT_MACROP_HI),
+		actions::MARKER, marker::TIMEOUTS,
+		actions::MARKER, marker::SET_BUDGET,
+		// 4. Perform Phase calibration
+		actions::write(1), uint8_t(Register::SYSTEM_SEQUENCE_CONFIG), 0x02,
+		actions::write(1), uint8_t(Register::SYSRANGE_START), 0x01,
+		actions::LOOP,
+		actions::MARKER, marker::AWAIT_SAMPLE,
+		actions::read(1), uint8_t(Register::RESULT_INTERRUPT_STATUS),
+		actions::MARKER, marker::CHECK_INTERRUPT,
+		actions::write(1), uint8_t(Register::SYSTEM_INTERRUPT_CLEAR), 0x01,
+		actions::write(1), uint8_t(Register::SYSRANGE_START), 0x00,
+		actions::MARKER, marker::RESTORE_STEPS,
+		// 5. Get current timing budget
+		actions::read(1), uint8_t(Register::SYSTEM_SEQUENCE_CONFIG),
+		actions::read(1), uint8_t(Register::PRE_RANGE_CONFIG_VCSEL_PERIOD),
+		actions::read(1), uint8_t(Register::FINAL_RANGE_CONFIG_VCSEL_PERIOD),
+		actions::read(1), uint8_t(Register::MSRC_CONFIG_TIMEOUT_MACROP),
+		actions::read(2), uint8_t(Register::PRE_RANGE_CONFIG_TIMEOUT_MACROP_HI),
+		actions::read(2), uint8_t(Register::FINAL_RANGE_CONFIG_TIMEOUT_MACROP_HI),
+		actions::MARKER, marker::TIMEOUTS,
+		actions::MARKER, marker::GET_BUDGET,
+		// 6. Set FINAL-RANGE VCSEL period and timeout
+		actions::write(1), uint8_t(Register::FINAL_RANGE_CONFIG_VALID_PHASE_HIGH), 0x48,
+		actions::write(1), uint8_t(Register::FINAL_RANGE_CONFIG_VALID_PHASE_LOW), 0x08,
+		actions::write(1), uint8_t(Register::GLOBAL_CONFIG_VCSEL_WIDTH), 0x03,
+		actions::write(1), uint8_t(Register::ALGO_PHASECAL_CONFIG_TIMEOUT), 0x07,
+		actions::write(1), 0xFF, 0x01,
+		actions::write(1), uint8_t(Register::ALGO_PHASECAL_LIM), 0x20,
+		actions::write(1), 0xFF, 0x00,
+		actions::write(1), uint8_t(Register::FINAL_RANGE_CONFIG_VCSEL_PERIOD),
+			uint8_t((LONG_RANGE_VCSEL_PERIOD_FINAL >> 1) - 1),
+		actions::MARKER, marker::FINAL_RANGE_TIMEOUT,
+		// 7. Set timing budget as before
+		actions::read(1), uint8_t(Register::SYSTEM_SEQUENCE_CONFIG),
+		actions::read(1), uint8_t(Register::PRE_RANGE_CONFIG_VCSEL_PERIOD),
+		actions::read(1), uint8_t(Register::FINAL_RANGE_CONFIG_VCSEL_PERIOD),
+		actions::read(1), uint8_t(Register::MSRC_CONFIG_TIMEOUT_MACROP),
+		actions::read(2), uint8_t(Register::PRE_RANGE_CONFIG_TIMEOUT_MACROP_HI),
+		actions::read(2), uint8_t(Register::FINAL_RANGE_CONFIG_TIMEOUT_MACROP_HI),
+		actions::MARKER, marker::TIMEOUTS,
+		actions::MARKER, marker::SET_BUDGET,
+		// 8. Perform Phase calibration
+		actions::write(1), uint8_t(Register::SYSTEM_SEQUENCE_CONFIG), 0x02,
+		actions::write(1), uint8_t(Register::SYSRANGE_START), 0x01,
+		actions::LOOP,
+		actions::MARKER, marker::AWAIT_SAMPLE,
+		actions::read(1), uint8_t(Register::RESULT_INTERRUPT_STATUS),
+		actions::MARKER, marker::CHECK_INTERRUPT,
+		actions::write(1), uint8_t(Register::SYSTEM_INTERRUPT_CLEAR), 0x01,
+		actions::write(1), uint8_t(Register::SYSRANGE_START), 0x00,
+		actions::MARKER, marker::RESTORE_STEPS,
+		// 9. Set signal rate limit to 0.1 MCPS
+		actions::write(2), uint8_t(Register::FINAL_RANGE_CONFIG_MIN_COUNT_RATE_RTN_LIMIT),
+			uint8_t(LONG_RANGE_SIGNAL_RATE >> 8), uint8_t(LONG_RANGE_SIGNAL_RATE),
+		actions::END
+	};
+
+	// Same as VL53L0X::set_measurement_timing_budget()
+	static constexpr uint8_t BUDGET[] PROGMEM =
+	{
+		actions::read(1), uint8_t(Register::SYSTEM_SEQUENCE_CONFIG),
+		actions::read(1), uint8_t(Register::PRE_RANGE_CONFIG_VCSEL_PERIOD),
+		actions::read(1), uint8_t(Register::FINAL_RANGE_CONFIG_VCSEL_PERIOD),
+		actions::read(1), uint8_t(Register::MSRC_CONFIG_TIMEOUT_MACROP),
+		actions::read(2), uint8_t(Register::PRE_RANGE_CONFIG_TIMEOUT_MACROP_HI),
+		actions::read(2), uint8_t(Register::FINAL_RANGE_CONFIG_TIMEOUT_MACROP_HI),
+		actions::MARKER, marker::TIMEOUTS,
+		actions::MARKER, marker::SET_BUDGET,
+		actions::END
+	};
+
+	// Same as VL53L0X::start_continuous_ranging(), then endless loop of
+	// await_continuous_range()
+	static constexpr uint8_t RANGING[] PROGMEM =
+	{
+		// 1. Start continuous ranging
+		actions::INCLUDE, include::STOP_VARIABLE_PRE,
+		actions::MARKER, marker::STOP_VARIABLE_WRITE,
+		actions::INCLUDE, include::STOP_VARIABLE_POST,
+		actions::read(2), uint8_t(Register::OSC_CALIBRATE_VAL),
+		actions::MARKER, marker::PERIOD,
+		actions::MARKER, marker::START,
+		// 2. Get each range as soon as ready
+		actions::LOOP,
+		actions::MARKER, marker::AWAIT_SAMPLE,
+		actions::read(2), uint8_t(Register::RESULT_RANGE_MILLIMETER),
+		actions::write(1), uint8_t(Register::SYSTEM_INTERRUPT_CLEAR), 0x01,
+		actions::MARKER, marker::RANGE,
+		actions::END
+	};
+}
+/// @endcond
+
+namespace devices::vl53l0x
+{
+	/// @cond notdocumented
+	template<typename MANAGER, board::DigitalPin... GPIOS_> class VL53L0XAsyncGroup;
+	/// @endcond
+
+	/**
+	 * Non-blocking driver for a VL53L0X chip, performing the whole
+	 * initialization sequence (same as `VL53L0X::begin()`) and then continuous
+	 * ranging, as a state machine driven by ISR only:
+	 * - each I2C transaction is launched from I2C ISR, as soon as the previous
+	 * one is complete
+	 * - calibration and ranging steps wait for VL53L0X GPIO pin interrupt
+	 * ("sample ready", active low), instead of polling the device
+	 *
+	 * Each range measured is pushed, as an `events::Event<uint16_t>`, to an
+	 * `events` queue, with the event type provided at construction time, and
+	 * the range (in mm) as value; when an error occurs (during initialization
+	 * or ranging), `ERROR_RANGE` is pushed and this device stops.
+	 *
+	 * This class is not used directly, but only through `VL53L0XAsyncGroup`,
+	 * which handles GPIO pins interrupts, dispatches I2C futures notifications
+	 * and staggers measurements of several devices.
+	 *
+	 * Since this class derives from `VL53L0X`, all its blocking API is also
+	 * available before calling `VL53L0XAsyncGroup::begin()`, e.g. to set
+	 * distinct I2C addresses to several devices with `set_address()`.
+	 *
+	 * @tparam MANAGER one of FastArduino available asynchronous I2C Manager
+	 *
+	 * @sa VL53L0XAsyncGroup
+	 * @sa VL53L0X
+	 */
+	template<typename MANAGER>
+	class VL53L0XAsync : public VL53L0X<MANAGER>
+	{
+		static_assert(i2c::I2CManager_trait<MANAGER>::IS_ASYNC, "MANAGER must be an asynchronous I2C Manager");
+
+		using PARENT = VL53L0X<MANAGER>;
+		using ABSTRACT_FUTURE = typename MANAGER::ABSTRACT_FUTURE;
+
+	public:
+		/** The type of events pushed for every range measured. */
+		using EVENT = events::Event<uint16_t>;
+
+		/** The range value pushed when an error occurred on this device. */
+		static constexpr const uint16_t ERROR_RANGE = UINT16_MAX;
+
+		/** The current status of this device. */
+		enum class Status : uint8_t
+		{
+			/** Nothing started yet. */
+			IDLE = 0,
+			/** Initialization sequence in progress. */
+			INITIALIZING,
+			/** Initialization done, waiting for continuous ranging to start. */
+			INITIALIZED,
+			/** Continuous ranging started, no range measured yet. */
+			STARTING,
+			/** Continuous ranging in progress. */
+			RANGING,
+			/** An error occurred, this device is stopped. */
+			ERROR
+		};
+
+		/// @cond notdocumented
+		VL53L0XAsync(const VL53L0XAsync&) = delete;
+		VL53L0XAsync& operator=(const VL53L0XAsync&) = delete;
+		/// @endcond
+
+		/**
+		 * Create a new non-blocking device driver for a VL53L0X chip.
+		 *
+		 * @param manager reference to a suitable MANAGER for this device
+		 * @param queue the queue of events where ranges will be pushed
+		 * @param event_type the type of all events pushed to @p queue by this
+		 * device; this allows distinguishing events of several devices.
+		 */
+		VL53L0XAsync(MANAGER& manager, containers::Queue<EVENT>& queue, uint8_t event_type)
+			: PARENT{manager}, queue_{queue}, event_type_{event_type} {}
+
+		/**
+		 * Get current status of this device.
+		 */
+		Status status() const
+		{
+			return status_;
+		}
+
+	private:
+		using Register = vl53l0x::Register;
+		static constexpr uint8_t MAX_DATA = 6;
+
+		static constexpr uint8_t LONG_RANGE_MASK = 0x01;
+		static constexpr uint8_t ACCURATE_MASK = 0x02;
+		static constexpr uint8_t FAST_MASK = 0x04;
+		static constexpr uint32_t ACCURATE_TIMING_BUDGET = 200'000UL;
+		static constexpr uint32_t FAST_TIMING_BUDGET = 20'000UL;
+
+		// The only future used for all I2C transactions of this device:
+		// write register index then read up to MAX_DATA bytes, or write
+		// register index and up to MAX_DATA bytes
+		class RegisterFuture : public ABSTRACT_FUTURE
+		{
+		public:
+			RegisterFuture() : ABSTRACT_FUTURE{nullptr, 0, input_, 1, future::FutureNotification::STATUS} {}
+
+			void reset_read(uint8_t reg, uint8_t* output, uint8_t size)
+			{
+				input_[0] = reg;
+				ABSTRACT_FUTURE::reset_(output, size, input_, 1);
+			}
+
+			void reset_write(uint8_t reg, const uint8_t* data, uint8_t size)
+			{
+				input_[0] = reg;
+				memcpy(input_ + 1, data, size);
+				ABSTRACT_FUTURE::reset_(nullptr, 0, input_, uint8_t(size + 1));
+			}
+
+		private:
+			uint8_t input_[1 + MAX_DATA];
+		};
+
+		enum class Script : uint8_t
+		{
+			INIT = 0,
+			LONG_RANGE,
+			BUDGET,
+			RANGING
+		};
+
+		// Called by VL53L0XAsyncGroup (with interrupts disabled)
+		int begin_(Profile profile)
+		{
+			if (status_ != Status::IDLE && status_ != Status::ERROR) return errors::EAGAIN;
+			profile_ = uint8_t(profile);
+			status_ = Status::INITIALIZING;
+			pending_ = false;
+			waiting_ = false;
+			return run(Script::INIT);
+		}
+
+		// Called by VL53L0XAsyncGroup (with interrupts disabled)
+		int start_(uint16_t period_ms)
+		{
+			period_ms_ = period_ms;
+			status_ = Status::STARTING;
+			return run(Script::RANGING);
+		}
+
+		int run(Script script)
+		{
+			script_ = script;
+			switch (script)
+			{
+				case Script::INIT:
+				position_ = vl53l0x_internals::async::INIT;
+				break;
+
+				case Script::LONG_RANGE:
+				position_ = vl53l0x_internals::async::LONG_RANGE;
+				break;
+
+				case Script::BUDGET:
+				position_ = vl53l0x_internals::async::BUDGET;
+				break;
+
+				case Script::RANGING:
+				position_ = vl53l0x_internals::async::RANGING;
+				break;
+			}
+			include_size_ = 0;
+			scratch_size_ = 0;
+			return next();
+		}
+
+		// Called by VL53L0XAsyncGroup from I2C ISR
+		// Return true if future belongs to this device
+		bool on_status_change(const ABSTRACT_FUTURE& future, future::FutureStatus status)
+		{
+			if (&future != &future_) return false;
+			if (status != future::FutureStatus::READY)
+				fail();
+			else
+				next();
+			return true;
+		}
+
+		// Called by VL53L0XAsyncGroup from GPIO pin ISR, when GPIO pin is low
+		void on_sample_ready()
+		{
+			if (waiting_)
+			{
+				waiting_ = false;
+				next();
+			}
+			else
+				pending_ = true;
+		}
+
+		// Execute actions until one I2C transaction is launched or a GPIO
+		// interrupt is needed
+		int next()
+		{
+			namespace actions = i2c::actions;
+			while (true)
+			{
+				if (include_size_)
+				{
+					const uint8_t reg = pgm_read_byte(include_++);
+					const uint8_t value = pgm_read_byte(include_++);
+					include_size_ -= 2;
+					return write(reg, &value, 1);
+				}
+				const uint8_t action = pgm_read_byte(position_++);
+				if (action == actions::END)
+				{
+					end_script();
+					return 0;
+				}
+				else if (action == actions::LOOP)
+				{
+					loop_ = position_;
+					loops_ = PARENT::MAX_LOOP;
+				}
+				else if (action == actions::INCLUDE)
+					include(pgm_read_byte(position_++));
+				else if (action == actions::MARKER)
+				{
+					int error = 0;
+					if (marker(pgm_read_byte(position_++), error)) return error;
+				}
+				else if (actions::is_read(action))
+					return read(pgm_read_byte(position_++), actions::count(action));
+				else
+				{
+					const uint8_t reg = pgm_read_byte(position_++);
+					const uint8_t count = actions::count(action);
+					uint8_t data[MAX_DATA];
+					for (uint8_t i = 0; i < count; ++i)
+						data[i] = pgm_read_byte(position_++);
+					return write(reg, data, count);
+				}
+			}
+		}
+
+		// Chain to next initialization script if needed
+		void end_script()
+		{
+			if (script_ == Script::INIT && (profile_ & LONG_RANGE_MASK))
+				run(Script::LONG_RANGE);
+			else if (script_ != Script::BUDGET && (profile_ & (ACCURATE_MASK | FAST_MASK)))
+			{
+				budget_us_ = (profile_ & ACCURATE_MASK) ? ACCURATE_TIMING_BUDGET : FAST_TIMING_BUDGET;
+				run(Script::BUDGET);
+			}
+			else
+				status_ = Status::INITIALIZED;
+		}
+
+		void include(uint8_t id)
+		{
+			namespace internals = vl53l0x_internals;
+			namespace include = vl53l0x_internals::async::include;
+			switch (id)
+			{
+				case include::STOP_VARIABLE_PRE:
+				include_ = internals::stop_variable::PRE_BUFFER;
+				include_size_ = internals::stop_variable::PRE_BUFFER_SIZE;
+				break;
+
+				case include::STOP_VARIABLE_POST:
+				include_ = internals::stop_variable::POST_BUFFER;
+				include_size_ = internals::stop_variable::POST_BUFFER_SIZE;
+				break;
+
+				case include::SPAD_INFO_1:
+				include_ = internals::spad_info::BUFFER1;
+				include_size_ = internals::spad_info::BUFFER1_SIZE;
+				break;
+
+				case include::SPAD_INFO_2:
+				include_ = internals::spad_info::BUFFER2;
+				include_size_ = internals::spad_info::BUFFER2_SIZE;
+				break;
+
+				case include::SPAD_INFO_3:
+				include_ = internals::spad_info::BUFFER3;
+				include_size_ = internals::spad_info::BUFFER3_SIZE;
+				break;
+
+				case include::SPAD_INFO_4:
+				include_ = internals::spad_info::BUFFER4;
+				include_size_ = internals::spad_info::BUFFER4_SIZE;
+				break;
+
+				case include::SET_REFERENCE_SPADS:
+				include_ = internals::set_reference_spads::BUFFER;
+				include_size_ = internals::set_reference_spads::BUFFER_SIZE;
+				break;
+
+				case include::TUNING_SETTINGS:
+				include_ = internals::load_tuning_settings::BUFFER;
+				include_size_ = internals::load_tuning_settings::BUFFER_SIZE;
+				break;
+			}
+		}
+
+		// Process a marker; return true if processing of actions must stop
+		// (I2C transaction launched or GPIO interrupt awaited), error is then
+		// set to the result of I2C transaction launch.
+		bool marker(uint8_t code, int& error)
+		{
+			namespace marker = vl53l0x_internals::async::marker;
+			namespace async = vl53l0x_internals::async;
+			// All data read so far is consumed by the marker
+			scratch_size_ = 0;
+			uint8_t value = scratch_[0];
+			switch (code)
+			{
+				case marker::VHV_CONFIG:
+				value |= 0x01;
+				error = write(Register::VHV_CONFIG_PAD_SCL_SDA_EXTSUP_HV, value);
+				return true;
+
+				case marker::STOP_VARIABLE_READ:
+				this->stop_variable_ = value;
+				return false;
+
+				case marker::STOP_VARIABLE_WRITE:
+				error = write(Register::SYSTEM_STOP_VARIABLE, this->stop_variable_);
+				return true;
+
+				case marker::MSRC_CONFIG:
+				value |= 0x12;
+				error = write(Register::MSRC_CONFIG_CONTROL, value);
+				return true;
+
+				case marker::STROBE_SET:
+				value |= 0x04U;
+				error = write(Register::DEVICE_STROBE, value);
+				return true;
+
+				case marker::STROBE_CLEAR:
+				value &= ~0x04U;
+				error = write(Register::DEVICE_STROBE, value);
+				return true;
+
+				case marker::STROBE_CHECK:
+				return check_loop(value != 0, error);
+
+				case marker::CHECK_INTERRUPT:
+				return check_loop((value & 0x07) != 0, error);
+
+				case marker::SPAD_INFO:
+				spad_info_ = value;
+				return false;
+
+				case marker::REF_SPADS:
+				// scratch_ is kept as is until REF_SPADS_WRITE (no read in-between)
+				PARENT::calculate_reference_SPADs(scratch_, SPADInfo{spad_info_});
+				return false;
+
+				case marker::REF_SPADS_WRITE:
+				error = write(uint8_t(Register::GLOBAL_CONFIG_SPAD_ENABLES_REF_0), scratch_, SPADReference::NUM_PADS_BYTES);
+				return true;
+
+				case marker::TIMEOUTS:
+				steps_ = SequenceSteps{scratch_[0]};
+				timeouts_ = SequenceStepsTimeout{
+					PARENT::decode_vcsel_period(scratch_[1]), PARENT::decode_vcsel_period(scratch_[2]),
+					scratch_[3], big_endian(scratch_ + 4), big_endian(scratch_ + 6)};
+				return false;
+
+				case marker::GET_BUDGET:
+				budget_us_ = PARENT::calculate_measurement_budget_us(true, steps_, timeouts_);
+				return false;
+
+				case marker::SET_BUDGET:
+				return write_timeout(Register::FINAL_RANGE_CONFIG_TIMEOUT_MACROP_HI,
+					PARENT::calculate_final_range_timeout(steps_, timeouts_, budget_us_), error);
+
+				case marker::RESTORE_STEPS:
+				error = write(Register::SYSTEM_SEQUENCE_CONFIG, steps_.value());
+				return true;
+
+				case marker::PRE_RANGE_TIMEOUT:
+				return write_timeout(Register::PRE_RANGE_CONFIG_TIMEOUT_MACROP_HI,
+					TimeoutUtilities::encode_timeout(TimeoutUtilities::calculate_timeout_mclks(
+						timeouts_.pre_range_us(), async::LONG_RANGE_VCSEL_PERIOD_PRE)), error);
+
+				case marker::MSRC_TIMEOUT:
+				{
+					const uint16_t msrc_mclks = TimeoutUtilities::calculate_timeout_mclks(
+						timeouts_.msrc_dss_tcc_us(), async::LONG_RANGE_VCSEL_PERIOD_PRE);
+					value = (msrc_mclks > (UINT8_MAX + 1)) ? UINT8_MAX : uint8_t(msrc_mclks - 1);
+					error = write(Register::MSRC_CONFIG_TIMEOUT_MACROP, value);
+					return true;
+				}
+
+				case marker::FINAL_RANGE_TIMEOUT:
+				return write_timeout(Register::FINAL_RANGE_CONFIG_TIMEOUT_MACROP_HI,
+					TimeoutUtilities::encode_timeout(TimeoutUtilities::calculate_timeout_mclks(
+						timeouts_.final_range_us(steps_.is_pre_range()), async::LONG_RANGE_VCSEL_PERIOD_FINAL)),
+					error);
+
+				case marker::PERIOD:
+				{
+					if (period_ms_ == 0) return false;
+					const uint16_t osc_calibrate = big_endian(scratch_);
+					uint32_t actual_period = period_ms_;
+					if (osc_calibrate) actual_period *= osc_calibrate;
+					const uint8_t data[] = {
+						uint8_t(actual_period >> 24), uint8_t(actual_period >> 16),
+						uint8_t(actual_period >> 8), uint8_t(actual_period)};
+					error = write(uint8_t(Register::SYSTEM_INTERMEASUREMENT_PERIOD), data, sizeof data);
+					return true;
+				}
+
+				case marker::START:
+				// Forget any GPIO interrupt that occurred before ranging is started
+				pending_ = false;
+				error = write(Register::SYSRANGE_START, uint8_t(period_ms_ ? 0x04 : 0x02));
+				return true;
+
+				case marker::AWAIT_SAMPLE:
+				if (pending_)
+				{
+					pending_ = false;
+					return false;
+				}
+				waiting_ = true;
+				return true;
+
+				case marker::RANGE:
+				status_ = Status::RANGING;
+				queue_.push_(EVENT{event_type_, big_endian(scratch_)});
+				position_ = loop_;
+				return false;
+
+				default:
+				error = errors::EILSEQ;
+				fail();
+				return true;
+			}
+		}
+
+		// Loop back to last LOOP action until condition is met or too many loops
+		bool check_loop(bool condition, int& error)
+		{
+			if (condition) return false;
+			if (--loops_ == 0)
+			{
+				error = errors::ETIME;
+				fail();
+				return true;
+			}
+			position_ = loop_;
+			return false;
+		}
+
+		bool write_timeout(Register reg, uint16_t timeout, int& error)
+		{
+			if (timeout == 0)
+			{
+				error = errors::EINVAL;
+				fail();
+				return true;
+			}
+			const uint8_t data[] = {uint8_t(timeout >> 8), uint8_t(timeout)};
+			error = write(uint8_t(reg), data, sizeof data);
+			return true;
+		}
+
+		int write(Register reg, uint8_t value)
+		{
+			return write(uint8_t(reg), &value, 1);
+		}
+
+		int write(uint8_t reg, const uint8_t* data, uint8_t size)
+		{
+			future_.reset_write(reg, data, size);
+			const int error = this->async_write(future_);
+			if (error) fail();
+			return error;
+		}
+
+		int read(uint8_t reg, uint8_t size)
+		{
+			future_.reset_read(reg, scratch_ + scratch_size_, size);
+			scratch_size_ += size;
+			const int error = this->async_read(future_);
+			if (error) fail();
+			return error;
+		}
+
+		void fail()
+		{
+			status_ = Status::ERROR;
+			waiting_ = false;
+			queue_.push_(EVENT{event_type_, ERROR_RANGE});
+		}
+
+		static uint16_t big_endian(const uint8_t* data)
+		{
+			return utils::as_uint16_t(data[0], data[1]);
+		}
+
+		containers::Queue<EVENT>& queue_;
+		const uint8_t event_type_;
+		volatile Status status_ = Status::IDLE;
+
+		// Current position in script
+		Script script_ = Script::INIT;
+		const uint8_t* position_ = nullptr;
+		const uint8_t* loop_ = nullptr;
+		uint16_t loops_ = 0;
+		const uint8_t* include_ = nullptr;
+		uint8_t include_size_ = 0;
+
+		// GPIO interrupt handling
+		volatile bool waiting_ = false;
+		volatile bool pending_ = false;
+
+		// Data read from device and settings
+		uint8_t scratch_[8];
+		uint8_t scratch_size_ = 0;
+		uint8_t profile_ = 0;
+		uint8_t spad_info_ = 0;
+		uint16_t period_ms_ = 0;
+		uint32_t budget_us_ = 0UL;
+		SequenceSteps steps_;
+		SequenceStepsTimeout timeouts_;
+
+		RegisterFuture future_;
+
+		template<typename M, board::DigitalPin... GPIOS> friend class VL53L0XAsyncGroup;
+	};
+
+	/**
+	 * Group of `VL53L0XAsync` devices sharing the same I2C bus, initialized
+	 * concurrently and then performing continuous ranging with staggered
+	 * measurements, without ever blocking the program.
+	 *
+	 * All devices of the group are initialized at the same time (I2C
+	 * transactions of all devices are interleaved on the bus), which takes
+	 * about as much time as the blocking initialization of one device.
+	 * Once all devices are initialized, continuous ranging is started on the
+	 * first device; then continuous ranging of each next device is started as
+	 * soon as the previous device has measured its first range. Hence, in timed
+	 * mode (non-zero period), devices measure one after another, which avoids
+	 * cross-talk between devices facing the same direction, provided that
+	 * the ranging period is larger than the sum of all devices timing budgets
+	 * (about 33ms with `Profile::STANDARD`).
+	 *
+	 * The GPIO pin of each device must be connected to the MCU, with a pull-up
+	 * resistor (most VL53L0X breakouts include one), and to a pin change or
+	 * external interrupt that will call `on_gpio()`. Devices must have distinct
+	 * I2C addresses, set with blocking `VL53L0X::set_address()` before `begin()`
+	 * (XSHUT pins of other devices must be held low meanwhile).
+	 *
+	 * This class requires an asynchronous I2C Manager, whose commands buffer
+	 * size is at least `2 * sizeof...(GPIOS_)`, and needs the following
+	 * registrations in your program:
+	 * @code
+	 * using MANAGER = i2c::I2CAsyncManager<...>;
+	 * using SENSOR = devices::vl53l0x::VL53L0XAsync<MANAGER>;
+	 * using GROUP = devices::vl53l0x::VL53L0XAsyncGroup<
+	 *     MANAGER, board::DigitalPin::D8_PB0, board::DigitalPin::D9_PB1>;
+	 * REGISTER_I2C_ISR(MANAGER)
+	 * REGISTER_PCI_ISR_METHOD(0, GROUP, &GROUP::on_gpio,
+	 *     board::InterruptPin::D8_PB0_PCI0, board::InterruptPin::D9_PB1_PCI0)
+	 * REGISTER_FUTURE_STATUS_LISTENERS(MANAGER_FUTURE(MANAGER), GROUP)
+	 * REGISTER_FUTURE_OUTPUT_NO_LISTENERS()
+	 *
+	 * static const uint8_t RANGE_LEFT = events::Type::USER_EVENT;
+	 * static const uint8_t RANGE_RIGHT = events::Type::USER_EVENT + 1;
+	 * ...
+	 * containers::Queue<SENSOR::EVENT> queue{buffer};
+	 * SENSOR left{manager, queue, RANGE_LEFT};
+	 * SENSOR right{manager, queue, RANGE_RIGHT};
+	 * // set distinct addresses with left.set_address()...
+	 * GROUP group{left, right};
+	 * interrupt::PCISignal<0> pci;
+	 * pci.enable_pins<board::InterruptPin::D8_PB0_PCI0, board::InterruptPin::D9_PB1_PCI0>();
+	 * pci.enable();
+	 * group.begin(devices::vl53l0x::Profile::STANDARD, 100);
+	 * while (true) {
+	 *     SENSOR::EVENT event = containers::pull(queue);
+	 *     ...
+	 * }
+	 * @endcode
+	 *
+	 * @tparam MANAGER one of FastArduino available asynchronous I2C Manager
+	 * @tparam GPIOS_ the pins connected to GPIO pin of each device, in the same
+	 * order as devices passed to the constructor
+	 *
+	 * @sa VL53L0XAsync
+	 */
+	template<typename MANAGER, board::DigitalPin... GPIOS_>
+	class VL53L0XAsyncGroup
+	{
+		using SENSOR = VL53L0XAsync<MANAGER>;
+		using Status = typename SENSOR::Status;
+		using ABSTRACT_FUTURE = typename MANAGER::ABSTRACT_FUTURE;
+
+	public:
+		/** The number of devices in this group. */
+		static constexpr const uint8_t SIZE = sizeof...(GPIOS_);
+
+		/// @cond notdocumented
+		VL53L0XAsyncGroup(const VL53L0XAsyncGroup&) = delete;
+		VL53L0XAsyncGroup& operator=(const VL53L0XAsyncGroup&) = delete;
+		/// @endcond
+
+		/**
+		 * Create a new group of VL53L0X devices.
+		 * @param sensors all devices of this group, in the same order as
+		 * @p GPIOS_ pins; there must be exactly as many devices as pins.
+		 */
+		template<typename... SENSORS>
+		explicit VL53L0XAsyncGroup(SENSORS&... sensors) : sensors_{&sensors...}
+		{
+			static_assert(sizeof...(SENSORS) == SIZE, "There must be exactly one device for each GPIO pin");
+			static_assert(SIZE > 0, "There must be at least one device in the group");
+			interrupt::register_handler(*this);
+			(gpio::FastPinType<GPIOS_>::set_mode(gpio::PinMode::INPUT), ...);
+			for (bool& level : levels_) level = true;
+		}
+
+		/**
+		 * Start initialization of all devices with @p profile, then continuous
+		 * ranging of all devices, staggered one after another.
+		 * This method returns immediately; ranges will then be pushed to the
+		 * queue of each device, as they are measured.
+		 *
+		 * @param profile the pre-defined Profile to use on all devices
+		 * @param period_ms the period, in ms, between 2 consecutive ranging
+		 * measures of each device; if `0`, then consecutive measures will follow
+		 * each other with no delay ("back-to-back" mode), and measures of
+		 * distinct devices are not staggered.
+		 * @retval 0 if initialization could start on all devices
+		 * @return an error code if initialization could not start on one device;
+		 * other devices are still initialized.
+		 */
+		int begin(Profile profile, uint16_t period_ms = 0)
+		{
+			synchronized
+			{
+				period_ms_ = period_ms;
+				next_ = 0;
+				int error = 0;
+				for (SENSOR* sensor : sensors_)
+				{
+					const int result = sensor->begin_(profile);
+					if (result && !error) error = result;
+				}
+				return error;
+			}
+		}
+
+		/**
+		 * Get current status of one device of this group.
+		 * @param index the index of the device, in the order of constructor
+		 * arguments
+		 */
+		Status status(uint8_t index) const
+		{
+			return sensors_[index]->status();
+		}
+
+		/**
+		 * Check GPIO pin of each device and resume its ranging if a range
+		 * sample has just become ready, i.e. its GPIO pin has fallen since
+		 * last call.
+		 * This shall be called from the ISR of pin change or external interrupts
+		 * connected to devices GPIO pins.
+		 */
+		void on_gpio()
+		{
+			const bool levels[] = {gpio::FastPinType<GPIOS_>::value()...};
+			for (uint8_t i = 0; i < SIZE; ++i)
+			{
+				// GPIO pin is active low: only a falling edge signals a new sample,
+				// other devices may still hold their pin low from a previous sample
+				if (levels_[i] && !levels[i]) sensors_[i]->on_sample_ready();
+				levels_[i] = levels[i];
+			}
+		}
+
+	private:
+		// Called from I2C ISR
+		void on_status_change(const ABSTRACT_FUTURE& future, future::FutureStatus status)
+		{
+			for (SENSOR* sensor : sensors_)
+				if (sensor->on_status_change(future, status)) break;
+			stagger();
+		}
+
+		// Start continuous ranging on next device when possible
+		void stagger()
+		{
+			if (next_ == SIZE) return;
+			if (next_ == 0)
+			{
+				// Wait until all devices are initialized
+				for (SENSOR* sensor : sensors_)
+					if (sensor->status() == Status::INITIALIZING) return;
+			}
+			else if (sensors_[next_ - 1]->status() == Status::STARTING)
+				// Wait until previous device has measured its first range
+				return;
+			while (next_ < SIZE)
+			{
+				SENSOR& sensor = *sensors_[next_++];
+				if (sensor.status() == Status::INITIALIZED && sensor.start_(period_ms_) == 0) return;
+			}
+		}
+
+		SENSOR* sensors_[SIZE];
+		// Last known level of each GPIO pin, to detect falling edges
+		bool levels_[SIZE];
+		uint16_t period_ms_ = 0;
+		uint8_t next_ = SIZE;
+
+		DECL_FUTURE_LISTENERS_FRIEND
+	};
+}
+
+#endif /* VL53L0X_ASYNC_H */
+/// @endcond
@@ -755,6 +755,7 @@ namespace devices::vl53l0x
 		uint8_t steps_ = FORCED_BITS;
 
 		template<typename MANAGER> friend class VL53L0X;
+		template<typename MANAGER> friend class VL53L0XAsync;
 	};
 
 	/// @cond notdocumented
@@ -885,6 +886,7 @@ namespace devices::vl53l0x
 		uint16_t final_range_mclks_ = 0;
 
 		template<typename MANAGER> friend class VL53L0X;
+		template<typename MANAGER> friend class VL53L0XAsync;
 	};
 
 	/// @cond notdocumented
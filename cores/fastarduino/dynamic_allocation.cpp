@@ -17,7 +17,8 @@
 
 // Allows to disengage dynamic allocation prevention (requires library rebuild)
 // This also requires developers to implement their own new/delete as needed!
-#ifndef USE_DYNAMIC_ALLOCATION
+// Host-native builds (CONF=HOST) keep the host C++ runtime allocation
+#if !defined(USE_DYNAMIC_ALLOCATION) && !defined(FASTARDUINO_HOST)
 
 // This code is just to prevent any kind of dynamic allocation in FastArduino programs
 void* operator new(size_t) = delete;
@@ -148,7 +148,7 @@ namespace eeprom
 		 */
 		template<typename T> static bool read(const T* address, T& value)
 		{
-			return read((uint16_t) address, value);
+			return read((uint16_t) (uintptr_t) address, value);
 		}
 
 		/**
@@ -193,7 +193,7 @@ namespace eeprom
 		 */
 		template<typename T> static bool read(const T* address, T* value, uint16_t count)
 		{
-			return read((uint16_t) address, value, count);
+			return read((uint16_t) (uintptr_t) address, value, count);
 		}
 
 		/**
@@ -234,7 +234,7 @@ namespace eeprom
 		 */
 		static bool read(const uint8_t* address, uint8_t& value)
 		{
-			return read((uint16_t) address, value);
+			return read((uint16_t) (uintptr_t) address, value);
 		}
 
 		/**
@@ -277,7 +277,7 @@ namespace eeprom
 		 */
 		template<typename T> static bool write(const T* address, const T& value)
 		{
-			return write((uint16_t) address, value);
+			return write((uint16_t) (uintptr_t) address, value);
 		}
 
 		/**
@@ -322,7 +322,7 @@ namespace eeprom
 		 */
 		template<typename T> static bool write(const T* address, const T* value, uint16_t count)
 		{
-			return write((uint16_t) address, value, count);
+			return write((uint16_t) (uintptr_t) address, value, count);
 		}
 
 		/**
@@ -362,7 +362,7 @@ namespace eeprom
 		 */
 		static bool write(const uint8_t* address, uint8_t value)
 		{
-			return write((uint16_t) address, value);
+			return write((uint16_t) (uintptr_t) address, value);
 		}
 
 		/**
@@ -562,7 +562,7 @@ namespace eeprom
 		 */
 		template<typename T> bool write(const T* address, const T& value)
 		{
-			return write((uint16_t) address, value);
+			return write((uint16_t) (uintptr_t) address, value);
 		}
 
 		/**
@@ -607,7 +607,7 @@ namespace eeprom
 		 */
 		template<typename T> bool write(const T* address, const T* value, uint16_t count)
 		{
-			return write((uint16_t) address, value, count);
+			return write((uint16_t) (uintptr_t) address, value, count);
 		}
 
 		/**
@@ -647,7 +647,7 @@ namespace eeprom
 		 */
 		bool write(const uint8_t* address, uint8_t value)
 		{
-			return write((uint16_t) address, value);
+			return write((uint16_t) (uintptr_t) address, value);
 		}
 
 		/**
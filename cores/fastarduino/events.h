@@ -23,6 +23,7 @@
 
 #include <stddef.h>
 #include "queue.h"
+#include "instrumentation.h"
 #include "linked_list.h"
 
 /**
@@ -111,6 +112,28 @@ namespace events
 		 */
 		const uint8_t RTT_TIMER = 2;
 
+		/**
+		 * Type of events generated by `devices::rf::AsyncNRF24L01` whenever a
+		 * new packet has been received and pushed to its packets queue.
+		 * @sa devices::rf::AsyncNRF24L01
+		 */
+		const uint8_t RF_RECEIVED = 3;
+
+		/**
+		 * Type of events generated by `devices::rf::AsyncNRF24L01` whenever a
+		 * pending payload has been successfully transmitted.
+		 * @sa devices::rf::AsyncNRF24L01
+		 */
+		const uint8_t RF_SENT = 4;
+
+		/**
+		 * Type of events generated by `devices::rf::AsyncNRF24L01` whenever
+		 * pending payloads could not be transmitted (maximum number of
+		 * retransmissions reached) and have been dropped.
+		 * @sa devices::rf::AsyncNRF24L01
+		 */
+		const uint8_t RF_SEND_FAILED = 5;
+
 		/**
 		 * The first ordinal event type that you may use for your own custom events.
 		 * You would generally define all your custom event types as constant:
@@ -159,7 +182,11 @@ namespace events
 		 * @param value the value of this event, `T{}` by default; for an `Event<void>`, 
 		 * this argument shall not be provided or a compile error will occur.
 		 */
-		explicit Event(uint8_t type = Type::NO_EVENT, T value = T{}) INLINE : type_{type}, value_{value} {}
+		explicit Event(uint8_t type = Type::NO_EVENT, T value = T{}) INLINE : type_{type}, value_{value}
+#ifdef FASTARDUINO_INSTRUMENTATION
+			, timestamp_{instrumentation::now_()}
+#endif
+		{}
 
 		/**
 		 * The type of this event.
@@ -179,9 +206,26 @@ namespace events
 			return value_;
 		}
 
+		/**
+		 * The time this event was created, in ticks of the instrumentation timer.
+		 * This is always `0` when `FASTARDUINO_INSTRUMENTATION` is not defined.
+		 * @sa instrumentation.h
+		 */
+		uint16_t timestamp() const INLINE
+		{
+#ifdef FASTARDUINO_INSTRUMENTATION
+			return timestamp_;
+#else
+			return 0;
+#endif
+		}
+
 	private:
 		uint8_t type_;
 		T value_;
+#ifdef FASTARDUINO_INSTRUMENTATION
+		uint16_t timestamp_;
+#endif
 	};
 
 	/// @cond notdocumented
@@ -193,14 +237,29 @@ namespace events
 
 		using TYPE = void;
 
-		explicit Event(uint8_t type = Type::NO_EVENT) INLINE : type_{type} {}
+		explicit Event(uint8_t type = Type::NO_EVENT) INLINE : type_{type}
+#ifdef FASTARDUINO_INSTRUMENTATION
+			, timestamp_{instrumentation::now_()}
+#endif
+		{}
 		uint8_t type() const INLINE
 		{
 			return type_;
 		}
+		uint16_t timestamp() const INLINE
+		{
+#ifdef FASTARDUINO_INSTRUMENTATION
+			return timestamp_;
+#else
+			return 0;
+#endif
+		}
 
 	private:
 		uint8_t type_;
+#ifdef FASTARDUINO_INSTRUMENTATION
+		uint16_t timestamp_;
+#endif
 	};
 	/// @endcond
 
@@ -257,9 +316,27 @@ namespace events
 		 */
 		void dispatch(const EVENT& event)
 		{
+#ifdef FASTARDUINO_INSTRUMENTATION
+			latency_.add_(instrumentation::since_(event.timestamp()));
+#endif
 			this->traverse(HandlerCaller(event));
 		}
 
+		/**
+		 * Statistics of latency of all events dispatched so far, from their
+		 * creation to their dispatch.
+		 * This is always empty when `FASTARDUINO_INSTRUMENTATION` is not defined.
+		 * @sa instrumentation.h
+		 */
+		instrumentation::Stats latency() const
+		{
+#ifdef FASTARDUINO_INSTRUMENTATION
+			return latency_;
+#else
+			return instrumentation::Stats{};
+#endif
+		}
+
 	private:
 		class HandlerCaller
 		{
@@ -267,13 +344,26 @@ namespace events
 			explicit HandlerCaller(const EVENT& event) INLINE : event_{event} {}
 			bool operator()(EventHandler<EVENT>& handler) INLINE
 			{
-				if (handler.type() == event_.type()) handler.on_event(event_);
+				if (handler.type() == event_.type())
+				{
+#ifdef FASTARDUINO_INSTRUMENTATION
+					const uint16_t start = instrumentation::now_();
+					handler.on_event(event_);
+					handler.stats_.add_(instrumentation::since_(start));
+#else
+					handler.on_event(event_);
+#endif
+				}
 				return false;
 			}
 
 		private:
 			const EVENT event_;
 		};
+
+#ifdef FASTARDUINO_INSTRUMENTATION
+		instrumentation::Stats latency_;
+#endif
 	};
 
 	/**
@@ -297,6 +387,20 @@ namespace events
 			return type_;
 		}
 
+		/**
+		 * Statistics of execution time of this handler `on_event()`.
+		 * This is always empty when `FASTARDUINO_INSTRUMENTATION` is not defined.
+		 * @sa instrumentation.h
+		 */
+		instrumentation::Stats stats() const
+		{
+#ifdef FASTARDUINO_INSTRUMENTATION
+			return stats_;
+#else
+			return instrumentation::Stats{};
+#endif
+		}
+
 	protected:
 		/// @cond notdocumented
 		EventHandler(const EventHandler&) = default;
@@ -318,6 +422,9 @@ namespace events
 
 	private:
 		uint8_t type_;
+#ifdef FASTARDUINO_INSTRUMENTATION
+		instrumentation::Stats stats_;
+#endif
 		friend class Dispatcher<EVENT>;
 	};
 };
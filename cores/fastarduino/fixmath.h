@@ -0,0 +1,248 @@
+//   Copyright 2016-2023 Jean-Francois Poilpret
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+/// @cond api
+
+/**
+ * @file
+ * Fixed-point math API, aimed at replacing floating-point math (and the large
+ * and slow AVR floating-point library) in computation-intensive code, e.g.
+ * sensor fusion.
+ */
+#ifndef FIXMATH_HH
+#define FIXMATH_HH
+
+#include <avr/pgmspace.h>
+#include "defines.h"
+
+/**
+ * Defines fixed-point math API.
+ *
+ * The following conventions are used throughout this namespace:
+ * - **Q15** values are `int16_t` representing a real value in range [-1, 1[,
+ * with 1.0 represented as `32768` (saturated to `32767`)
+ * - **Q30** values are `int32_t` representing a real value in range [-2, 2[,
+ * with 1.0 represented as `2^30`
+ * - **binary angles** are `int16_t` where a full turn (360 degrees) maps to
+ * `65536`, i.e. `-32768` is -180 degrees, `16384` is 90 degrees; binary angles
+ * naturally wrap around on overflow, which makes angle additions and
+ * differences simple and exact.
+ */
+namespace fixmath
+{
+	/** The Q15 value nearest to 1.0. */
+	static constexpr const int16_t Q15_ONE = INT16_MAX;
+	/** The Q30 value of 1.0. */
+	static constexpr const int32_t Q30_ONE = 1L << 30;
+
+	/** Binary angle of 90 degrees. */
+	static constexpr const int16_t ANGLE_90 = 16384;
+	/** Binary angle of -180 degrees (also +180 degrees). */
+	static constexpr const int16_t ANGLE_180 = INT16_MIN;
+
+	/**
+	 * Multiply 2 Q15 values.
+	 * @return @p a * @p b as a Q15 value
+	 */
+	inline int16_t mul_q15(int16_t a, int16_t b)
+	{
+		return int16_t((int32_t(a) * b) >> 15);
+	}
+
+	/**
+	 * Multiply 2 Q30 values.
+	 * This performs only two 16x16 bits multiplications: only the 16 most
+	 * significant bits of @p a are used, hence @p a precision is reduced to
+	 * `2^-14` whereas @p b precision is fully kept; this is well suited when
+	 * @p b is much smaller than @p a.
+	 * @return @p a * @p b as a Q30 value
+	 */
+	inline int32_t mul_q30(int32_t a, int32_t b)
+	{
+		const int16_t high = int16_t(a >> 16);
+		return ((int32_t(high) * int16_t(b >> 16)) << 2) + ((int32_t(high) * uint16_t(b)) >> 14);
+	}
+
+	/**
+	 * Saturate a 32 bits value to the range of a Q15 value, i.e.
+	 * [`-Q15_ONE`, `Q15_ONE`]; the result can thus always be safely negated.
+	 */
+	inline int16_t saturate_q15(int32_t value)
+	{
+		if (value > Q15_ONE) return Q15_ONE;
+		if (value < -Q15_ONE) return -Q15_ONE;
+		return int16_t(value);
+	}
+
+	/**
+	 * Compute the integer square root of @p value, i.e. the largest integer
+	 * whose square is less than or equal to @p value.
+	 * This uses a bitwise algorithm (no multiplication, no division) with
+	 * 16 iterations at most.
+	 */
+	inline uint16_t isqrt(uint32_t value)
+	{
+		uint32_t result = 0;
+		uint32_t bit = 1UL << 30;
+		while (bit > value) bit >>= 2;
+		while (bit)
+		{
+			if (value >= result + bit)
+			{
+				value -= result + bit;
+				result = (result >> 1) + bit;
+			}
+			else
+				result >>= 1;
+			bit >>= 2;
+		}
+		return uint16_t(result);
+	}
+
+	/**
+	 * Compute the inverse of the norm of 3D vector (@p x, @p y, @p z), as a
+	 * Q30 value, so that each coordinate multiplied by the result, and shifted
+	 * right by 15 bits, produces the Q15 coordinates of the unit vector with
+	 * the same direction.
+	 * This needs one square root and one division.
+	 * @return the inverse of the norm, or `0` if the vector is null
+	 */
+	inline int32_t inverse_norm(int16_t x, int16_t y, int16_t z)
+	{
+		const uint32_t norm2 = uint32_t(int32_t(x) * x) + uint32_t(int32_t(y) * y) + uint32_t(int32_t(z) * z);
+		if (norm2 == 0) return 0;
+		return int32_t((1UL << 30) / isqrt(norm2));
+	}
+
+	/**
+	 * Convert a binary angle to tenths of degrees, in range [-1800, 1800[.
+	 */
+	constexpr int16_t to_deci_degrees(int16_t angle)
+	{
+		return int16_t((int32_t(angle) * 3600L) >> 16);
+	}
+
+	/**
+	 * Convert an angle in tenths of degrees to a binary angle.
+	 */
+	constexpr int16_t from_deci_degrees(int16_t deci_degrees)
+	{
+		return int16_t((int32_t(deci_degrees) * 65536L) / 3600L);
+	}
+
+	/**
+	 * Polar coordinates of a 2D vector, as computed by `to_polar()`.
+	 */
+	struct Polar
+	{
+		/** The magnitude of the vector (same scale as cartesian coordinates). */
+		uint16_t magnitude;
+		/** The binary angle of the vector. */
+		int16_t angle;
+	};
+
+	/// @cond notdocumented
+	namespace cordic_impl
+	{
+		// atan(2^-i) as binary angles
+		static constexpr uint16_t ATAN[] PROGMEM =
+		{
+			8192, 4836, 2555, 1297, 651, 326, 163, 81, 41, 20, 10, 5, 3, 1, 1
+		};
+		static constexpr uint8_t ITERATIONS = sizeof(ATAN) / sizeof(ATAN[0]);
+		// CORDIC gain compensation factor (0.60725) in Q16
+		static constexpr uint32_t GAIN = 39797UL;
+		// Left shift of inputs to improve precision while not overflowing int32
+		static constexpr uint8_t SCALE = 14;
+	}
+	/// @endcond
+
+	/**
+	 * Convert cartesian coordinates to polar coordinates, with CORDIC algorithm
+	 * (vectoring mode), using only additions and shifts, 15 iterations.
+	 * Precision of the resulting angle is about 0.01 degree.
+	 * @param x the X coordinate
+	 * @param y the Y coordinate
+	 * @return the polar coordinates of (@p x, @p y); for (0, 0), both
+	 * magnitude and angle are 0.
+	 */
+	inline Polar to_polar(int16_t x, int16_t y)
+	{
+		using namespace cordic_impl;
+		if (x == 0 && y == 0) return Polar{0, 0};
+		int32_t cx = int32_t(x) << SCALE;
+		int32_t cy = int32_t(y) << SCALE;
+		uint16_t angle = 0;
+		// CORDIC converges only for angles in [-99.9, 99.9] degrees
+		if (cx < 0)
+		{
+			cx = -cx;
+			cy = -cy;
+			angle = uint16_t(ANGLE_180);
+		}
+		for (uint8_t i = 0; i < ITERATIONS; ++i)
+		{
+			const int32_t dx = cx >> i;
+			const int32_t dy = cy >> i;
+			const uint16_t step = pgm_read_word(&ATAN[i]);
+			if (cy > 0)
+			{
+				cx += dy;
+				cy -= dx;
+				angle += step;
+			}
+			else
+			{
+				cx -= dy;
+				cy += dx;
+				angle -= step;
+			}
+		}
+		const uint16_t magnitude = uint16_t(((uint32_t(cx) >> SCALE) * GAIN) >> 16);
+		return Polar{magnitude, int16_t(angle)};
+	}
+
+	/**
+	 * Compute the arc tangent of @p y / @p x, using CORDIC algorithm.
+	 * @return the binary angle, in range [-180, 180[ degrees, of vector (@p x, @p y)
+	 * @sa to_polar()
+	 */
+	inline int16_t atan2(int16_t y, int16_t x)
+	{
+		return to_polar(x, y).angle;
+	}
+
+	/**
+	 * Compute the magnitude of vector (@p x, @p y), i.e. `sqrt(x^2 + y^2)`,
+	 * using CORDIC algorithm.
+	 * @sa to_polar()
+	 */
+	inline uint16_t hypot(int16_t x, int16_t y)
+	{
+		return to_polar(x, y).magnitude;
+	}
+
+	/**
+	 * Compute the arc sine of a Q15 value.
+	 * @return the binary angle, in range [-90, 90] degrees, whose sine is @p sine
+	 */
+	inline int16_t asin(int16_t sine)
+	{
+		const uint16_t cosine = isqrt((1UL << 30) - uint32_t(int32_t(sine) * sine));
+		return atan2(sine, cosine > uint16_t(Q15_ONE) ? Q15_ONE : int16_t(cosine));
+	}
+}
+
+#endif /* FIXMATH_HH */
+/// @endcond
@@ -47,7 +47,7 @@ namespace flash
 	 * @return a pointer to @p buffer
 	 */
 	template<typename T = uint8_t>
-	T* read_flash(uint16_t address, T* buffer, uint8_t size)
+	T* read_flash(uintptr_t address, T* buffer, uint8_t size)
 	{
 		uint8_t* ptr = (uint8_t*) buffer;
 		for (size_t i = 0; i < (size * sizeof(T)); ++i) *ptr++ = pgm_read_byte(address++);
@@ -64,7 +64,7 @@ namespace flash
 	 * @param item the item to read from flash storage
 	 * @return a reference to read @p item
 	 */
-	template<typename T> T& read_flash(uint16_t address, T& item)
+	template<typename T> T& read_flash(uintptr_t address, T& item)
 	{
 		uint8_t* ptr = (uint8_t*) &item;
 		for (size_t i = 0; i < sizeof(T); ++i) *ptr++ = pgm_read_byte(address++);
@@ -99,7 +99,7 @@ namespace flash
 	 */
 	template<typename T> T& read_flash(const T* address, T& item)
 	{
-		return read_flash((uint16_t) address, item);
+		return read_flash((uintptr_t) address, item);
 	}
 
 	/**
@@ -115,7 +115,7 @@ namespace flash
 		 * 
 		 * @param flash_buffer a pointer to the first item in Flash memory
 		 */
-		explicit FlashReader(const T* flash_buffer) : address_{uint16_t(flash_buffer)} {}
+		explicit FlashReader(const T* flash_buffer) : address_{uintptr_t(flash_buffer)} {}
 
 		/**
 		 * Get the enxt item read from memory.
@@ -131,7 +131,7 @@ namespace flash
 		}
 
 	private:
-		uint16_t address_;
+		uintptr_t address_;
 	};
 }
 
@@ -738,6 +738,303 @@ namespace gpio
 	 */
 	template<board::ExternalInterruptPin EPIN_>
 	using FAST_EXT_PIN = typename FastPinType<board::EXT_PIN<EPIN_>()>::TYPE;
+
+	/// @cond notdocumented
+	namespace gpio_group_impl
+	{
+		template<uint8_t SIZE> struct Value_trait
+		{
+			using TYPE = uint32_t;
+		};
+		template<> struct Value_trait<1>
+		{
+			using TYPE = uint8_t;
+		};
+		template<> struct Value_trait<2>
+		{
+			using TYPE = uint16_t;
+		};
+	}
+	/// @endcond
+
+	/**
+	 * API that manipulates a group of digital IO pins, possibly spanning
+	 * several ports, as one logical N-bit value.
+	 * All port masks and bits shuffling are computed at compile-time, so that
+	 * writing a value to the group produces only one read-modify-write per 
+	 * port involved, and toggling pins produces only one write per port.
+	 * When pins of one port are consecutive and ordered in the group, the
+	 * bits shuffle for this port is reduced to one shift.
+	 * 
+	 * The following snippet demonstrates usage of `FastPinGroup` for a 4-bit
+	 * parallel LCD bus spread over 2 ports:
+	 * @code
+	 * using BUS = gpio::FastPinGroup<
+	 *     board::DigitalPin::D6_PD6, board::DigitalPin::D7_PD7, 
+	 *     board::DigitalPin::D8_PB0, board::DigitalPin::D9_PB1>;
+	 * BUS bus{gpio::PinMode::OUTPUT};
+	 * bus.set(0x0A);  // D7 and D9 set, D6 and D8 cleared
+	 * @endcode
+	 * 
+	 * @note Like `FastMaskedPort`, writing a value is not atomic; if an ISR may
+	 * modify other pins of the same ports, then `set()` must be called within a
+	 * `synchronized` block (this is not needed for `toggle()`).
+	 * 
+	 * @tparam PINS_ the list of pins in this group, bit `0` of the logical 
+	 * value maps to the first pin; at most 32 pins can be in a group and 
+	 * each pin must appear only once.
+	 * @sa FastPin
+	 * @sa FastMaskedPort
+	 */
+	template<board::DigitalPin... PINS_> class FastPinGroup
+	{
+		static_assert(sizeof...(PINS_) > 0, "FastPinGroup must contain at least one pin");
+		static_assert(sizeof...(PINS_) <= 32, "FastPinGroup must contain at most 32 pins");
+
+	public:
+		/** The number of pins in this group. */
+		static constexpr const uint8_t SIZE = sizeof...(PINS_);
+
+		/**
+		 * The type of the logical value of this group, `uint8_t`, `uint16_t`
+		 * or `uint32_t` depending on `SIZE`.
+		 */
+		using VALUE = typename gpio_group_impl::Value_trait<(SIZE + 7) / 8>::TYPE;
+
+	private:
+		static constexpr const board::DigitalPin PINS[] = {PINS_...};
+
+		template<board::DigitalPin PIN> static constexpr board::Port port_of()
+		{
+			return board_traits::DigitalPin_trait<PIN>::PORT;
+		}
+
+		template<board::DigitalPin PIN> static constexpr uint8_t bit_of()
+		{
+			return board_traits::DigitalPin_trait<PIN>::BIT;
+		}
+
+		static constexpr uint8_t index_of(board::DigitalPin pin)
+		{
+			for (uint8_t i = 0; i < SIZE; ++i)
+				if (PINS[i] == pin) return i;
+			return SIZE;
+		}
+
+		static constexpr bool unique_pins()
+		{
+			for (uint8_t i = 0; i < SIZE; ++i)
+				if (index_of(PINS[i]) != i) return false;
+			return true;
+		}
+
+		// Index of the first pin in the group that belongs to port P
+		template<board::Port P> static constexpr uint8_t first_index()
+		{
+			uint8_t index = SIZE;
+			// Keep the lowest index among all pins of port P
+			((index = (port_of<PINS_>() == P && index_of(PINS_) < index) ? index_of(PINS_) : index), ...);
+			return index;
+		}
+
+		template<board::Port P> static constexpr uint8_t port_mask()
+		{
+			return ((port_of<PINS_>() == P ? bits::BV8(bit_of<PINS_>()) : 0) | ...);
+		}
+
+		// Check if all pins of port P have the same shift between their index
+		// in the group and their bit in the port
+		template<board::Port P> static constexpr bool aligned()
+		{
+			constexpr int8_t SHIFT = shift<P>();
+			return ((port_of<PINS_>() != P || int8_t(bit_of<PINS_>()) - int8_t(index_of(PINS_)) == SHIFT) && ...);
+		}
+
+		template<board::Port P> static constexpr int8_t shift()
+		{
+			constexpr uint8_t FIRST = first_index<P>();
+			return int8_t(board_traits::DigitalPin_trait<PINS[FIRST]>::BIT) - int8_t(FIRST);
+		}
+
+		// Convert logical group value to bits of port P
+		template<board::Port P> static uint8_t to_port(VALUE value)
+		{
+			constexpr uint8_t MASK = port_mask<P>();
+			if constexpr (aligned<P>())
+			{
+				constexpr int8_t SHIFT = shift<P>();
+				if constexpr (SHIFT >= 0)
+					return uint8_t(value << SHIFT) & MASK;
+				else
+					return uint8_t(value >> -SHIFT) & MASK;
+			}
+			else
+				return ((port_of<PINS_>() == P && (value & (VALUE(1) << index_of(PINS_)))
+						? bits::BV8(bit_of<PINS_>()) : 0) | ...);
+		}
+
+		// Convert bits of port P to logical group value
+		template<board::Port P> static VALUE from_port(uint8_t port)
+		{
+			constexpr uint8_t MASK = port_mask<P>();
+			if constexpr (aligned<P>())
+			{
+				constexpr int8_t SHIFT = shift<P>();
+				if constexpr (SHIFT >= 0)
+					return VALUE(port & MASK) >> SHIFT;
+				else
+					return VALUE(port & MASK) << -SHIFT;
+			}
+			else
+				return ((port_of<PINS_>() == P && (port & bits::BV8(bit_of<PINS_>()))
+						? VALUE(VALUE(1) << index_of(PINS_)) : VALUE(0)) | ...);
+		}
+
+		// The following methods operate on the port of PIN, only when PIN is 
+		// the first pin of the group in this port; this ensures that each port 
+		// is accessed only once.
+		template<board::DigitalPin PIN> static constexpr bool is_first()
+		{
+			return first_index<port_of<PIN>()>() == index_of(PIN);
+		}
+
+		template<board::DigitalPin PIN> static void set_port(VALUE value)
+		{
+			if constexpr (is_first<PIN>())
+			{
+				constexpr board::Port P = port_of<PIN>();
+				constexpr uint8_t MASK = port_mask<P>();
+				using TRAIT = board_traits::Port_trait<P>;
+				if constexpr (MASK == TRAIT::DPIN_MASK)
+					TRAIT::PORT = to_port<P>(value);
+				else
+					TRAIT::PORT = uint8_t(TRAIT::PORT & bits::COMPL(MASK)) | to_port<P>(value);
+			}
+		}
+
+		template<board::DigitalPin PIN> static void toggle_port(VALUE value)
+		{
+			if constexpr (is_first<PIN>())
+			{
+				constexpr board::Port P = port_of<PIN>();
+				board_traits::Port_trait<P>::PIN = to_port<P>(value);
+			}
+		}
+
+		template<board::DigitalPin PIN> static VALUE get_port()
+		{
+			if constexpr (is_first<PIN>())
+			{
+				constexpr board::Port P = port_of<PIN>();
+				return from_port<P>(board_traits::Port_trait<P>::PIN);
+			}
+			else
+				return 0;
+		}
+
+		template<board::DigitalPin PIN> static void set_port_mode(PinMode mode)
+		{
+			if constexpr (is_first<PIN>())
+			{
+				constexpr board::Port P = port_of<PIN>();
+				constexpr uint8_t MASK = port_mask<P>();
+				using TRAIT = board_traits::Port_trait<P>;
+				if (mode == PinMode::OUTPUT)
+					TRAIT::DDR |= MASK;
+				else
+					TRAIT::DDR &= bits::COMPL(MASK);
+				if (mode == PinMode::INPUT_PULLUP)
+					TRAIT::PORT |= MASK;
+				else if (mode == PinMode::INPUT)
+					TRAIT::PORT &= bits::COMPL(MASK);
+			}
+		}
+
+	public:
+		/// @cond notdocumented
+		FastPinGroup(const FastPinGroup&) = default;
+		FastPinGroup& operator=(const FastPinGroup&) = default;
+		/// @endcond
+
+		/**
+		 * Construct a `FastPinGroup` without any physical setup on target MCU.
+		 * This is useful if default pins direction and value are OK for you and 
+		 * you want to avoid calling mode setup on target MCU.
+		 */
+		FastPinGroup() INLINE
+		{
+			static_assert(unique_pins(), "each pin must appear only once in FastPinGroup");
+		}
+
+		/**
+		 * Construct a `FastPinGroup` with the given mode and initial value
+		 * for all its pins.
+		 * The pins mode are forced on the target MCU.
+		 * 
+		 * @param mode the mode of all pins of this group
+		 * @param value the initial logical value of this group, if 
+		 * `mode == PinMode::OUTPUT`; not used otherwise.
+		 * @sa set_mode()
+		 */
+		explicit FastPinGroup(PinMode mode, VALUE value = 0) INLINE
+		{
+			static_assert(unique_pins(), "each pin must appear only once in FastPinGroup");
+			set_mode(mode, value);
+		}
+
+		/**
+		 * Set mode (direction) and value (if output) of all pins of this group.
+		 * 
+		 * @param mode the mode of all pins of this group
+		 * @param value the initial logical value of this group, if 
+		 * `mode == PinMode::OUTPUT`; not used otherwise.
+		 */
+		void set_mode(PinMode mode, VALUE value = 0) INLINE
+		{
+			if (mode == PinMode::OUTPUT) set(value);
+			(set_port_mode<PINS_>(mode), ...);
+		}
+
+		/**
+		 * Set levels of all pins of this group at once.
+		 * This generates one read-modify-write per port involved in this group,
+		 * or only one write when the group covers all pins of a port.
+		 * 
+		 * @param value the logical value to set; each bit sets the level of 
+		 * the matching pin (bit `0` for the first pin of the group)
+		 */
+		void set(VALUE value) INLINE
+		{
+			(set_port<PINS_>(value), ...);
+		}
+
+		/**
+		 * Toggle levels of selected pins of this group.
+		 * This generates only one write (to PIN register) per port involved in 
+		 * this group, and is not disturbed by ISR modifying other pins of 
+		 * the same ports.
+		 * 
+		 * @param value the logical mask of pins to toggle; each `1` bit
+		 * toggles the level of the matching pin (bit `0` for the first pin of 
+		 * the group)
+		 */
+		void toggle(VALUE value) INLINE
+		{
+			(toggle_port<PINS_>(value), ...);
+		}
+
+		/**
+		 * Return the current levels of all pins of this group.
+		 * This generates only one read per port involved in this group.
+		 * 
+		 * @return the logical value, where each bit is the level of the 
+		 * matching pin (bit `0` for the first pin of the group)
+		 */
+		VALUE value() INLINE
+		{
+			return (get_port<PINS_>() | ...);
+		}
+	};
 }
 
 #endif /* FASTIO_HH */
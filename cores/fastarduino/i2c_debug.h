@@ -21,9 +21,19 @@
 #ifndef I2C_DEBUG_HH
 #define I2C_DEBUG_HH
 
+#include "boards/board_traits.h"
 #include "flash.h"
 #include "i2c_handler_common.h"
 #include "i2c_status.h"
+#include "queue.h"
+#include "streambuf.h"
+
+#ifndef FASTARDUINO_I2C_TRACE_TIMER
+/**
+ * The timer used by `i2c::debug::I2CBusTracer` to timestamp I2C bus events.
+ */
+#define FASTARDUINO_I2C_TRACE_TIMER board::Timer::TIMER1
+#endif
 
 namespace i2c
 {
@@ -445,6 +455,162 @@ namespace i2c::debug
 			:	i2c::status::I2CStatusLiveLogger<OSTREAM>{out, trace, hex_status},
 				I2CDebugLiveLogger<OSTREAM>{out, debug} {}
 	};
+
+	/**
+	 * Class recording timestamped I2C bus events (start, slave address, data,
+	 * ack/nack, stop and unexpected status) into a ring buffer, for streaming
+	 * to a host, where `make/i2c-trace-decode.py` reconstructs transactions and
+	 * computes per-device latency and bus utilization.
+	 * 
+	 * Contrarily to `I2CDebugStatusRecorder`, recording is minimal (no
+	 * filtering, no formatting), hence it can be used with asynchronous
+	 * I2C Managers without disturbing bus timings too much; it must be attached
+	 * to an I2C Manager as both its debug and status hook:
+	 * @code
+	 * using TRACER = i2c::debug::I2CBusTracer<64>;
+	 * using MANAGER = i2c::I2CAsyncStatusDebugManager<
+	 *     i2c::I2CMode::FAST, i2c::I2CErrorPolicy::CLEAR_ALL_COMMANDS, TRACER&, TRACER&>;
+	 * TRACER tracer;
+	 * MANAGER manager{i2c_buffer, tracer, tracer};
+	 * tracer.begin();
+	 * ...
+	 * // In main loop
+	 * tracer.dump(uatx.out().rdbuf());
+	 * @endcode
+	 * 
+	 * Each bus event is recorded as 4 bytes (timestamp, event, data), and streamed
+	 * in binary as 5-byte records:
+	 * 
+	 *     0x5A | timestamp (2 bytes) | event | data
+	 * 
+	 * where event is an `i2c::DebugStatus` value, `STATUS_ERROR` (data is the
+	 * unexpected status) or `DROPPED` (data is the number of events lost because
+	 * the ring buffer was full).
+	 * 
+	 * Timestamps are the counter of a free-running timer, `board::Timer::TIMER1`
+	 * by default; this can be changed by defining `FASTARDUINO_I2C_TRACE_TIMER`.
+	 * 
+	 * @tparam SIZE the size of the ring buffer, in number of bus events
+	 * 
+	 * @sa i2c::I2CAsyncStatusDebugManager
+	 * @sa i2c::I2CSyncStatusDebugManager
+	 */
+	template<uint8_t SIZE> class I2CBusTracer
+	{
+	private:
+		using TRAIT = board_traits::Timer_trait<FASTARDUINO_I2C_TRACE_TIMER>;
+
+		struct Record
+		{
+			uint16_t timestamp;
+			uint8_t event;
+			uint8_t data;
+		};
+
+	public:
+		/** The type of prescaler of the trace timer. */
+		using PRESCALER = typename TRAIT::TIMER_PRESCALER;
+
+		/** The first byte of every streamed record. */
+		static constexpr const uint8_t SYNC = 0x5A;
+		/** The size of every streamed record. */
+		static constexpr const uint8_t RECORD_SIZE = 5;
+		/** Event recorded when an I2C status is not the expected one. */
+		static constexpr const uint8_t STATUS_ERROR = 0x0E;
+		/** Event recorded when some events were lost (ring buffer full). */
+		static constexpr const uint8_t DROPPED = 0x0F;
+
+		I2CBusTracer() = default;
+		I2CBusTracer(const I2CBusTracer&) = delete;
+		I2CBusTracer& operator=(const I2CBusTracer&) = delete;
+
+		/**
+		 * Start the trace timer in normal mode with @p prescaler, and clear
+		 * all recorded events.
+		 * @param prescaler the prescaler value for the trace timer; the default
+		 * gives 4us ticks at 16MHz, which can measure transactions up to 262ms.
+		 * @param start_timer if `false`, the trace timer is not started by this
+		 * method, e.g. because it is already running in normal mode for other
+		 * purposes
+		 */
+		void begin(PRESCALER prescaler = PRESCALER::DIV_64, bool start_timer = true)
+		{
+			synchronized
+			{
+				if (start_timer)
+				{
+					if (!TRAIT::TCCRA.is_no_reg()) TRAIT::TCCRA = 0;
+					TRAIT::TCCRB = TRAIT::TCCRB_prescaler(prescaler);
+					TRAIT::TCNT = 0;
+				}
+				queue_.clear_();
+				dropped_ = 0;
+			}
+		}
+
+		/**
+		 * Stream as many recorded events as possible to @p out, in binary, without
+		 * blocking. This should be called regularly, e.g. in the main loop.
+		 * @param out the output buffer (e.g. from `serial::hard::UATX`)
+		 * @return the number of streamed events
+		 */
+		uint8_t dump(streams::ostreambuf& out)
+		{
+			// Flush pending lost events marker if no event occurred since
+			synchronized
+			{
+				if (dropped_ && !queue_.full_())
+				{
+					queue_.push_(Record{TRAIT::TCNT, DROPPED, dropped_});
+					dropped_ = 0;
+				}
+			}
+			uint8_t count = 0;
+			Record record;
+			while (out.queue().free() >= RECORD_SIZE && queue_.pull(record))
+			{
+				const uint8_t bytes[RECORD_SIZE] = {
+					SYNC, uint8_t(record.timestamp), uint8_t(record.timestamp >> 8), record.event, record.data};
+				out.sputn((const char*) bytes, RECORD_SIZE);
+				++count;
+			}
+			return count;
+		}
+
+		/// @cond notdocumented
+		void operator()(i2c::DebugStatus status, uint8_t data)
+		{
+			record_(uint8_t(status), data);
+		}
+
+		void operator()(i2c::Status expected, i2c::Status actual)
+		{
+			if (expected != actual) record_(STATUS_ERROR, uint8_t(actual));
+		}
+		/// @endcond
+
+	private:
+		void record_(uint8_t event, uint8_t data)
+		{
+			const uint16_t now = TRAIT::TCNT;
+			if (dropped_)
+			{
+				// Keep room for the lost events marker first
+				if (queue_.free_() < 2)
+				{
+					if (dropped_ < 0xFF) ++dropped_;
+					return;
+				}
+				queue_.push_(Record{now, DROPPED, dropped_});
+				dropped_ = 0;
+			}
+			if (!queue_.push_(Record{now, event, data})) dropped_ = 1;
+		}
+
+		Record buffer_[SIZE];
+		containers::Queue<Record> queue_{buffer_};
+		uint8_t dropped_ = 0;
+	};
 }
 
 #endif /* I2C_DEBUG_HH */
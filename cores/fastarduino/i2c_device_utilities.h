@@ -21,6 +21,8 @@
 #ifndef I2C_DEVICE_UTILITIES_H
 #define I2C_DEVICE_UTILITIES_H
 
+#include <string.h>
+#include "bits.h"
 #include "flash.h"
 #include "functors.h"
 #include "future.h"
@@ -47,6 +49,11 @@ namespace i2c
 			return register_;
 		}
 
+		const T& value() const
+		{
+			return value_;
+		}
+
 	private:
 		uint8_t register_{};
 		T value_{}; 
@@ -823,10 +830,642 @@ namespace i2c
 		return (future.await() == future::FutureStatus::READY);
 	}
 
-#ifdef EXPERIMENTAL_API
+	/**
+	 * Compile-time description of the registers of an I2C device that can be
+	 * shadowed by a `RegisterShadow`, i.e. registers whose last value read from
+	 * or written to the device is kept in SRAM and reused, instead of reading
+	 * the device again or writing the same value again.
+	 *
+	 * Shadowed registers are consecutive, from @p FIRST_ to `FIRST_ + COUNT_ - 1`.
+	 * Among them, the registers that can be changed by the device itself (status,
+	 * measures, interrupt flags...) must be declared volatile: they are never
+	 * shadowed. Registers outside this range are never shadowed either.
+	 *
+	 * Typical usage is through `using` statement as in the following snippet:
+	 * @code
+	 * // MCP23017 (IOCON.BANK = 0): all registers but INTF, INTCAP and GPIO are configuration
+	 * using REGISTERS = i2c::RegisterMap<0x00, 0x16, 0x0E, 0x0F, 0x10, 0x11, 0x12, 0x13>;
+	 * @endcode
+	 *
+	 * @tparam FIRST_ the address of the first shadowed register
+	 * @tparam COUNT_ the number of consecutive shadowed registers
+	 * @tparam VOLATILES_ the addresses of volatile registers, in the range of
+	 * shadowed registers
+	 *
+	 * @sa RegisterShadow
+	 * @sa CachedI2CDevice
+	 */
+	template<uint8_t FIRST_, uint8_t COUNT_, uint8_t... VOLATILES_> struct RegisterMap
+	{
+		static_assert(COUNT_ > 0, "COUNT_ must be at least 1");
+		static_assert(uint16_t(FIRST_) + COUNT_ <= 256U, "FIRST_ + COUNT_ must not exceed 256");
+
+		/** The address of the first shadowed register. */
+		static constexpr const uint8_t FIRST = FIRST_;
+		/** The number of consecutive shadowed registers. */
+		static constexpr const uint8_t COUNT = COUNT_;
+
+		/**
+		 * Tell if register @p reg is volatile, i.e. can be changed by the device
+		 * itself.
+		 */
+		static constexpr bool is_volatile(uint8_t reg)
+		{
+			return (false || ... || (reg == VOLATILES_));
+		}
+
+		/**
+		 * Tell if all @p size registers starting at @p reg are shadowed.
+		 */
+		static constexpr bool is_cached(uint8_t reg, uint8_t size = 1)
+		{
+			if (reg < FIRST || uint16_t(reg) + size > uint16_t(FIRST) + COUNT) return false;
+			for (uint8_t i = 0; i < size; ++i)
+				if (is_volatile(uint8_t(reg + i))) return false;
+			return true;
+		}
+	};
+
+	/// @cond notdocumented
+	template<typename MANAGER, typename MAP> class CachedI2CDevice;
+	/// @endcond
+
+	/**
+	 * Storage of the values of I2C device registers, as last read from or
+	 * written to the device. Each register has a *valid* flag (the value is known)
+	 * and a *dirty* flag (the value has been changed but not written to the device
+	 * yet).
+	 * This class holds no storage by itself; it is used through its `RegisterShadow`
+	 * subclass, and it is generally used indirectly through `CachedI2CDevice`.
+	 *
+	 * @sa RegisterShadow
+	 * @sa CachedI2CDevice
+	 */
+	class AbstractRegisterShadow
+	{
+	public:
+		/// @cond notdocumented
+		AbstractRegisterShadow(const AbstractRegisterShadow&) = delete;
+		AbstractRegisterShadow& operator=(const AbstractRegisterShadow&) = delete;
+		/// @endcond
+
+		/**
+		 * Forget the values of all registers; next accesses to these registers
+		 * will be performed on the device.
+		 * This should be called whenever the device content may have changed
+		 * without the shadow knowing it, e.g. after a device reset or an I2C error.
+		 */
+		void invalidate()
+		{
+			memset(flags_, 0, 2 * flags_size());
+		}
+
+		/**
+		 * Forget the values of @p size registers starting at @p reg.
+		 */
+		void invalidate(uint8_t reg, uint8_t size = 1)
+		{
+			for (uint8_t index = reg - first_; size; ++index, --size)
+			{
+				clear_flag(valid_flags(), index);
+				clear_flag(dirty_flags(), index);
+			}
+		}
+
+		/**
+		 * Tell if some registers have been changed (with `stage()`) but not
+		 * written to the device yet.
+		 */
+		bool is_dirty() const
+		{
+			const uint8_t* dirty = dirty_flags();
+			for (uint8_t i = 0; i < flags_size(); ++i)
+				if (dirty[i]) return true;
+			return false;
+		}
+
+		/**
+		 * Get the known values of @p size registers starting at @p reg.
+		 * @retval true if all values are known and were copied to @p data
+		 * @retval false if at least one value is unknown; @p data is unchanged
+		 */
+		bool get(uint8_t reg, uint8_t* data, uint8_t size) const
+		{
+			if (!is_valid(reg, size)) return false;
+			memcpy(data, values_ + (reg - first_), size);
+			return true;
+		}
+
+		/**
+		 * Tell if the known values of @p size registers starting at @p reg are
+		 * the same as @p data.
+		 */
+		bool is_same(uint8_t reg, const uint8_t* data, uint8_t size) const
+		{
+			return is_valid(reg, size) && (memcmp(values_ + (reg - first_), data, size) == 0);
+		}
+
+		/**
+		 * Record the values of @p size registers starting at @p reg, as just read
+		 * from or written to the device.
+		 */
+		void update(uint8_t reg, const uint8_t* data, uint8_t size)
+		{
+			const uint8_t first = reg - first_;
+			memcpy(values_ + first, data, size);
+			for (uint8_t index = first; index < first + size; ++index)
+			{
+				set_flag(valid_flags(), index);
+				clear_flag(dirty_flags(), index);
+			}
+		}
+
+		/**
+		 * Change the values of @p size registers starting at @p reg, without
+		 * writing them to the device; they will be written later, all at once.
+		 * @retval true if at least one value was changed
+		 * @retval false if all values were already known with the same values
+		 */
+		bool stage(uint8_t reg, const uint8_t* data, uint8_t size)
+		{
+			if (is_same(reg, data, size)) return false;
+			const uint8_t first = reg - first_;
+			memcpy(values_ + first, data, size);
+			for (uint8_t index = first; index < first + size; ++index)
+			{
+				set_flag(valid_flags(), index);
+				set_flag(dirty_flags(), index);
+			}
+			return true;
+		}
+
+	protected:
+		/// @cond notdocumented
+		AbstractRegisterShadow(uint8_t first, uint8_t count, uint8_t* values, uint8_t* flags)
+			:	first_{first}, count_{count}, values_{values}, flags_{flags}
+		{
+			invalidate();
+		}
+
+		static constexpr uint8_t flags_size(uint8_t count)
+		{
+			return (count + 7) / 8;
+		}
+		/// @endcond
+
+	private:
+		uint8_t flags_size() const
+		{
+			return flags_size(count_);
+		}
+		uint8_t* valid_flags()
+		{
+			return flags_;
+		}
+		uint8_t* dirty_flags()
+		{
+			return flags_ + flags_size();
+		}
+		const uint8_t* valid_flags() const
+		{
+			return flags_;
+		}
+		const uint8_t* dirty_flags() const
+		{
+			return flags_ + flags_size();
+		}
+		static bool flag(const uint8_t* flags, uint8_t index)
+		{
+			return flags[index / 8] & bits::BV8(index % 8);
+		}
+		static void set_flag(uint8_t* flags, uint8_t index)
+		{
+			flags[index / 8] |= bits::BV8(index % 8);
+		}
+		static void clear_flag(uint8_t* flags, uint8_t index)
+		{
+			flags[index / 8] &= bits::CBV8(index % 8);
+		}
+
+		bool is_valid(uint8_t reg, uint8_t size) const
+		{
+			for (uint8_t index = reg - first_; size; ++index, --size)
+				if (!flag(valid_flags(), index)) return false;
+			return true;
+		}
+
+		// Find the next run of dirty registers, at most max_size long, starting
+		// at or after index; return the size of the run (0 if none)
+		uint8_t next_dirty(uint8_t& index, uint8_t max_size) const
+		{
+			while (index < count_ && !flag(dirty_flags(), index)) ++index;
+			uint8_t size = 0;
+			while (index + size < count_ && size < max_size && flag(dirty_flags(), index + size)) ++size;
+			return size;
+		}
+
+		void clean(uint8_t index, uint8_t size)
+		{
+			for (; size; ++index, --size) clear_flag(dirty_flags(), index);
+		}
+
+		const uint8_t* values(uint8_t index) const
+		{
+			return values_ + index;
+		}
+
+		const uint8_t first_;
+		const uint8_t count_;
+		uint8_t* const values_;
+		uint8_t* const flags_;
+
+		template<typename MANAGER, typename MAP> friend class CachedI2CDevice;
+	};
+
+	/**
+	 * Storage of the values of I2C device registers described by @p MAP, as last
+	 * read from or written to the device.
+	 * Registers are accessed by their address on the device; only registers
+	 * for which `MAP::is_cached()` is `true` shall be used.
+	 *
+	 * @tparam MAP the `RegisterMap` describing shadowed registers
+	 *
+	 * @sa RegisterMap
+	 * @sa CachedI2CDevice
+	 */
+	template<typename MAP> class RegisterShadow : public AbstractRegisterShadow
+	{
+	public:
+		/**
+		 * Create a new register shadow where all values are unknown.
+		 */
+		RegisterShadow() : AbstractRegisterShadow{MAP::FIRST, MAP::COUNT, values_, flags_} {}
+
+	private:
+		uint8_t values_[MAP::COUNT];
+		uint8_t flags_[2 * flags_size(MAP::COUNT)];
+	};
+
+	/**
+	 * Variant of `TReadRegisterFuture`, for use with `CachedI2CDevice`: when
+	 * the register is shadowed, reading it is performed on the device only if
+	 * its value is unknown; the value read is then recorded into the shadow when
+	 * `get()` is called.
+	 *
+	 * @tparam MANAGER the type of I2C Manager used to handle I2C communication
+	 * @tparam REGISTER_ the address of the register to read from the I2C device
+	 * @tparam T the type of the register to read from
+	 * @tparam FUNCTOR the type of an adequate functor to transform the register
+	 * value to a more suitable result; defaults to `functor::Identity<T>` which
+	 * does nothing.
+	 *
+	 * @sa TReadRegisterFuture
+	 * @sa CachedI2CDevice
+	 */
+	template<typename MANAGER, uint8_t REGISTER_, typename T, typename FUNCTOR = functor::Identity<T>>
+	class TCachedReadRegisterFuture : public TReadRegisterFuture<MANAGER, REGISTER_, T, FUNCTOR>
+	{
+		using PARENT = TReadRegisterFuture<MANAGER, REGISTER_, T, FUNCTOR>;
+		using RAW_FUTURE = typename MANAGER::template FUTURE<T, uint8_t>;
+		using ARG_TYPE = typename FUNCTOR::ARG_TYPE;
+
+	public:
+		/** The address of the register read by this future. */
+		static constexpr const uint8_t REGISTER = REGISTER_;
+
+		/**
+		 * Create a TCachedReadRegisterFuture future.
+		 * @param notification determines if and which notifications should be
+		 * dispatched by this future; default is none.
+		 */
+		explicit TCachedReadRegisterFuture(
+			future::FutureNotification notification = future::FutureNotification::NONE)
+			:	PARENT{notification} {}
+
+		/// @cond notdocumented
+		bool get(T& result)
+		{
+			ARG_TYPE temp;
+			if (!RAW_FUTURE::get(temp)) return false;
+			if (shadow_ != nullptr)
+			{
+				shadow_->update(REGISTER, reinterpret_cast<const uint8_t*>(&temp), sizeof(T));
+				shadow_ = nullptr;
+			}
+			result = functor::Functor<FUNCTOR>::call(temp);
+			return true;
+		}
+		/// @endcond
+
+	private:
+		static constexpr uint8_t SIZE = sizeof(T);
+		AbstractRegisterShadow* shadow_ = nullptr;
+
+		template<typename M, typename MAP> friend class CachedI2CDevice;
+	};
+
+	/**
+	 * Variant of `TWriteRegisterFuture`, for use with `CachedI2CDevice`: when
+	 * the register is shadowed, writing it is performed on the device only if
+	 * its value is unknown or different.
+	 * The register value is unknown while the write is in progress; it is
+	 * recorded into the shadow only once `await()` or `status()`, called on
+	 * this future, returns `FutureStatus::READY`.
+	 *
+	 * @tparam MANAGER the type of I2C Manager used to handle I2C communication
+	 * @tparam REGISTER_ the address of the register to write in the I2C device
+	 * @tparam T the type of the register to write to
+	 * @tparam FUNCTOR the type of an adequate functor to transform the value passed
+	 * to this future constructor to a more suitable value for the device register;
+	 * defaults to `functor::Identity<T>` which does nothing.
+	 *
+	 * @sa TWriteRegisterFuture
+	 * @sa CachedI2CDevice
+	 */
+	template<typename MANAGER, uint8_t REGISTER_, typename T, typename FUNCTOR = functor::Identity<T>>
+	class TCachedWriteRegisterFuture : public TWriteRegisterFuture<MANAGER, REGISTER_, T, FUNCTOR>
+	{
+		using PARENT = TWriteRegisterFuture<MANAGER, REGISTER_, T, FUNCTOR>;
+		using ARG_TYPE = typename FUNCTOR::ARG_TYPE;
+
+	public:
+		/** The address of the register written by this future. */
+		static constexpr const uint8_t REGISTER = REGISTER_;
+
+		/**
+		 * Create a TCachedWriteRegisterFuture future.
+		 * @param value the value to write to the register in the I2C device
+		 * @param notification determines if and which notifications should be
+		 * dispatched by this future; default is none.
+		 */
+		explicit TCachedWriteRegisterFuture(const ARG_TYPE& value = ARG_TYPE{},
+			future::FutureNotification notification = future::FutureNotification::NONE)
+			:	PARENT{value, notification} {}
+
+		/// @cond notdocumented
+		future::FutureStatus status()
+		{
+			return update_shadow(PARENT::status());
+		}
+
+		future::FutureStatus await()
+		{
+			return update_shadow(PARENT::await());
+		}
+		/// @endcond
+
+	private:
+		static constexpr uint8_t SIZE = sizeof(T);
+
+		const uint8_t* data() const
+		{
+			return reinterpret_cast<const uint8_t*>(&this->get_input().value());
+		}
+
+		future::FutureStatus update_shadow(future::FutureStatus status)
+		{
+			if (shadow_ != nullptr && status != future::FutureStatus::NOT_READY)
+			{
+				// On error, register value stays unknown
+				if (status == future::FutureStatus::READY) shadow_->update(REGISTER, data(), SIZE);
+				shadow_ = nullptr;
+			}
+			return status;
+		}
+
+		AbstractRegisterShadow* shadow_ = nullptr;
+
+		template<typename M, typename MAP> friend class CachedI2CDevice;
+	};
+
+	/**
+	 * Base class for I2C devices drivers that want to avoid useless I2C
+	 * transactions, by shadowing the values of the device configuration
+	 * registers:
+	 * - reading a shadowed register, whose value is already known, does not
+	 * perform any I2C transaction
+	 * - writing a shadowed register with its current value does not perform
+	 * any I2C transaction
+	 * - several shadowed registers can be changed with `deferred_write()`, then
+	 * written all at once with `flush()`: consecutive registers are written in
+	 * one I2C transaction (the device must support register address
+	 * auto-increment)
+	 *
+	 * Accesses to registers not shadowed (as defined by @p MAP) are always
+	 * performed on the device; this is determined at compile-time.
+	 *
+	 * Drivers opt in by subclassing `CachedI2CDevice` instead of `I2CDevice`,
+	 * and using `TCachedReadRegisterFuture` and `TCachedWriteRegisterFuture`
+	 * with `cached_*` methods:
+	 * @code
+	 * template<typename MANAGER>
+	 * class MyDevice : public i2c::CachedI2CDevice<MANAGER, i2c::RegisterMap<0x00, 0x03>>
+	 * {
+	 *     using SetModeFuture = i2c::TCachedWriteRegisterFuture<MANAGER, MODE_REGISTER, uint8_t>;
+	 *     bool set_mode(uint8_t mode) {
+	 *         return this->template cached_sync_write<SetModeFuture>(mode);
+	 *     }
+	 *     ...
+	 * };
+	 * @endcode
+	 *
+	 * @warning When a register read or write is avoided thanks to the shadow, the
+	 * future is updated immediately (not from an ISR), hence its listeners are
+	 * notified from the caller context.
+	 * @warning A failed `cached_async_write()` leaves its register unknown, but
+	 * after any other I2C error (e.g. device reset), the driver should call
+	 * `invalidate_cache()`, as device registers may then differ from their shadow.
+	 *
+	 * @tparam MANAGER the type of I2C Manager used to handle I2C communication
+	 * @tparam MAP the `RegisterMap` describing shadowed registers
+	 *
+	 * @sa RegisterMap
+	 * @sa TCachedReadRegisterFuture
+	 * @sa TCachedWriteRegisterFuture
+	 */
+	template<typename MANAGER, typename MAP>
+	class CachedI2CDevice : public I2CDevice<MANAGER>
+	{
+		using PARENT = I2CDevice<MANAGER>;
+		using ABSTRACT_FUTURE = typename MANAGER::ABSTRACT_FUTURE;
+
+		// Maximum number of registers written in one I2C transaction by flush()
+		static constexpr uint8_t MAX_FLUSH_SIZE = (MAP::COUNT < 16 ? MAP::COUNT : 16);
+
+	public:
+		/**
+		 * Forget the values of all registers; next accesses to these registers
+		 * will be performed on the device.
+		 */
+		void invalidate_cache()
+		{
+			shadow_.invalidate();
+		}
+
+		/**
+		 * Forget the values of @p size registers starting at @p reg; this must
+		 * be called when these registers are written without the cache, e.g.
+		 * with a `TWriteMultiRegisterFuture`.
+		 */
+		void invalidate_cache(uint8_t reg, uint8_t size = 1)
+		{
+			for (; size; ++reg, --size)
+				if (MAP::is_cached(reg)) shadow_.invalidate(reg);
+		}
+
+		/**
+		 * Write all registers changed by `deferred_write()` to the device,
+		 * with one I2C transaction per group of consecutive registers.
+		 * @warning Blocking API!
+		 *
+		 * @retval true if all changed registers were written successfully
+		 * @retval false if an error occurred; registers not written yet are kept
+		 * for next call
+		 */
+		bool flush()
+		{
+			uint8_t index = 0;
+			uint8_t size;
+			while ((size = shadow_.next_dirty(index, MAX_FLUSH_SIZE)) != 0)
+			{
+				FlushFuture future{uint8_t(MAP::FIRST + index), shadow_.values(index), size};
+				if (this->async_write(future) != 0) return false;
+				if (future.await() != future::FutureStatus::READY) return false;
+				shadow_.clean(index, size);
+				index += size;
+			}
+			return true;
+		}
+
+	protected:
+		/// @cond notdocumented
+		template<I2CMode MODE>
+		CachedI2CDevice(MANAGER& manager, uint8_t device, Mode<MODE> mode, bool auto_stop)
+			:	PARENT{manager, device, mode, auto_stop} {}
+		/// @endcond
+
+		/**
+		 * Same as `I2CDevice::async_read()` for a `TCachedReadRegisterFuture`,
+		 * except that @p future is immediately updated, and no I2C transaction
+		 * is launched, if its register value is known.
+		 * @warning Asynchronous API!
+		 *
+		 * @sa cached_sync_read()
+		 */
+		template<typename F> int cached_async_read(F& future)
+		{
+			if constexpr (MAP::is_cached(F::REGISTER, F::SIZE))
+			{
+				uint8_t data[F::SIZE];
+				if (shadow_.get(F::REGISTER, data, F::SIZE))
+				{
+					synchronized future.set_future_value_(data, F::SIZE);
+					return 0;
+				}
+				future.shadow_ = &shadow_;
+			}
+			return this->async_read(future);
+		}
+
+		/**
+		 * Same as `I2CDevice::sync_read()` for a `TCachedReadRegisterFuture`,
+		 * except that no I2C transaction is performed if the register value is
+		 * known.
+		 * @warning Blocking API!
+		 *
+		 * @sa cached_async_read()
+		 */
+		template<typename F, typename T = uint8_t> bool cached_sync_read(T& result)
+		{
+			F future{};
+			if (cached_async_read(future) != 0) return false;
+			return future.get(result);
+		}
+
+		/**
+		 * Same as `I2CDevice::async_write()` for a `TCachedWriteRegisterFuture`,
+		 * except that @p future is immediately updated, and no I2C transaction
+		 * is launched, if the register value is already the value to write.
+		 * @warning Asynchronous API!
+		 *
+		 * @sa cached_sync_write()
+		 */
+		template<typename F> int cached_async_write(F& future)
+		{
+			if constexpr (MAP::is_cached(F::REGISTER, F::SIZE))
+			{
+				if (shadow_.is_same(F::REGISTER, future.data(), F::SIZE))
+				{
+					synchronized future.set_future_finish_();
+					return 0;
+				}
+				// Register value is unknown until the write is known to have succeeded
+				shadow_.invalidate(F::REGISTER, F::SIZE);
+				const int error = this->async_write(future);
+				if (error == 0) future.shadow_ = &shadow_;
+				return error;
+			}
+			else
+				return this->async_write(future);
+		}
+
+		/**
+		 * Same as `I2CDevice::sync_write()` for a `TCachedWriteRegisterFuture`,
+		 * except that no I2C transaction is performed if the register value is
+		 * already @p value.
+		 * @warning Blocking API!
+		 *
+		 * @sa cached_async_write()
+		 */
+		template<typename F, typename T = uint8_t> bool cached_sync_write(const T& value)
+		{
+			F future{value};
+			if (cached_async_write(future) != 0) return false;
+			return (future.await() == future::FutureStatus::READY);
+		}
+
+		/**
+		 * Change the value of a shadowed register, without writing it to the
+		 * device; it will be written by next call to `flush()`.
+		 *
+		 * @tparam F the `TCachedWriteRegisterFuture` type for the register;
+		 * the register must be shadowed.
+		 * @param value the new value of the register
+		 * @retval true if the register value was changed
+		 * @retval false if the register already had @p value
+		 *
+		 * @sa flush()
+		 */
+		template<typename F, typename T = uint8_t> bool deferred_write(const T& value)
+		{
+			static_assert(MAP::is_cached(F::REGISTER, F::SIZE), "F register must be shadowed");
+			const F future{value};
+			return shadow_.stage(F::REGISTER, future.data(), F::SIZE);
+		}
+
+	private:
+		// Future used by flush() to write consecutive registers at once
+		class FlushFuture : public ABSTRACT_FUTURE
+		{
+		public:
+			FlushFuture(uint8_t reg, const uint8_t* data, uint8_t size)
+				:	ABSTRACT_FUTURE{nullptr, 0, input_, uint8_t(size + 1)}
+			{
+				input_[0] = reg;
+				memcpy(input_ + 1, data, size);
+			}
+
+		private:
+			uint8_t input_[1 + MAX_FLUSH_SIZE];
+		};
+
+		RegisterShadow<MAP> shadow_;
+	};
+
 	/**
 	 * This namespace contains action codes for use in flash memory configuration arrays
-	 * used by ComplexI2CFuturesGroup.
+	 * used by ComplexI2CFuturesGroup or by device-specific asynchronous sequencers
+	 * (e.g. `devices::vl53l0x::VL53L0XAsync`).
 	 * 
 	 * For all I2C futures using flash read-only date to write to device, the following
 	 * convention is used:
@@ -891,6 +1530,7 @@ namespace i2c
 		}
 	}
 
+#ifdef EXPERIMENTAL_API
 	//FIXME wont't work in SYNC mode (too many recursion calls through future listeners)!!!
 	template<typename MANAGER> class ComplexI2CFuturesGroup : public AbstractI2CFuturesGroup<MANAGER>
 	{
@@ -0,0 +1,613 @@
+//   Copyright 2016-2023 Jean-Francois Poilpret
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+/// @cond api
+
+/**
+ * @file
+ * ATmega I2C slave API. This allows an ATmega MCU to act as an I2C device,
+ * exposing a register file to an I2C master on the bus.
+ */
+#ifndef I2C_SLAVE_HH
+#define I2C_SLAVE_HH
+
+#include <string.h>
+#include "boards/board.h"
+#include "boards/board_traits.h"
+#include "bits.h"
+#include "interrupts.h"
+#include "utilities.h"
+
+// Prevent inclusion for ATtiny architecture
+#ifndef TWCR
+#error "i2c_slave.h cannot be included in an ATtiny program!"
+#endif
+
+/**
+ * Register the necessary ISR (Interrupt Service Routine) for an `i2c::I2CSlave`
+ * to work properly.
+ *
+ * @param SLAVE the actual `i2c::I2CSlave` type
+ */
+#define REGISTER_I2C_SLAVE_ISR(SLAVE)                               \
+ISR(TWI_vect)                                                       \
+{                                                                   \
+	i2c::slave_isr_handler::i2c_change<SLAVE>();                    \
+}
+
+/**
+ * Register the necessary ISR (Interrupt Service Routine) for an `i2c::I2CSlave`
+ * to work properly, along with a callback function that will be called
+ * everytime an I2C master has written to or read from the register file.
+ *
+ * @param SLAVE the actual `i2c::I2CSlave` type
+ * @param CALLBACK the function that will be called when the interrupt is
+ * triggered; it should follow this prototype:
+ * `void f(I2CSlaveCallback callback, uint8_t reg, uint8_t count)`
+ *
+ * @sa i2c::I2CSlaveCallback
+ */
+#define REGISTER_I2C_SLAVE_ISR_FUNCTION(SLAVE, CALLBACK)            \
+ISR(TWI_vect)                                                       \
+{                                                                   \
+	i2c::slave_isr_handler::i2c_change_function<SLAVE, CALLBACK>(); \
+}
+
+/**
+ * Register the necessary ISR (Interrupt Service Routine) for an `i2c::I2CSlave`
+ * to work properly, along with a callback method that will be called
+ * everytime an I2C master has written to or read from the register file.
+ *
+ * @param SLAVE the actual `i2c::I2CSlave` type
+ * @param HANDLER the class holding the callback method
+ * @param CALLBACK the method of @p HANDLER that will be called when the interrupt
+ * is triggered; this must be a proper PTMF (pointer to member function); it should
+ * follow this prototype: `void f(I2CSlaveCallback callback, uint8_t reg, uint8_t count)`
+ *
+ * @sa i2c::I2CSlaveCallback
+ */
+#define REGISTER_I2C_SLAVE_ISR_METHOD(SLAVE, HANDLER, CALLBACK)                \
+ISR(TWI_vect)                                                                  \
+{                                                                              \
+	i2c::slave_isr_handler::i2c_change_method<SLAVE, HANDLER, CALLBACK>();     \
+}
+
+/**
+ * This macro shall be used in a class containing a private callback method,
+ * registered by `REGISTER_I2C_SLAVE_ISR_METHOD`.
+ * It declares the class where it is used as a friend of all necessary functions
+ * so that the private callback method can be called properly.
+ */
+#define DECL_I2C_SLAVE_ISR_HANDLERS_FRIEND		\
+	friend struct i2c::slave_isr_handler;		\
+	DECL_TWI_FRIENDS
+
+namespace i2c
+{
+	/**
+	 * Type passed to I2C slave ISR registered callbacks, when an I2C master has
+	 * completed a transaction with the register file of an `I2CSlave`.
+	 * Callbacks are called from the ISR, after the MCU has been released from
+	 * the current transaction, but before next transaction can be handled:
+	 * they shall be as short as possible in order to avoid I2C clock stretching.
+	 */
+	enum class I2CSlaveCallback : uint8_t
+	{
+		/** Nothing happened; callbacks are never called with this value. */
+		NONE = 0,
+		/**
+		 * The master has written `count` read-write registers, starting at
+		 * register `reg`, when addressing this slave.
+		 */
+		WRITE,
+		/**
+		 * The master has written `count` read-write registers, starting at
+		 * register `reg`, through a general call (address `0x00`).
+		 */
+		GENERAL_CALL,
+		/**
+		 * The master has read `count` registers, starting at register `reg`.
+		 */
+		READ
+	};
+
+	/**
+	 * Interrupt-driven I2C slave for ATmega MCU, emulating a register file,
+	 * just like most I2C devices do:
+	 * - the first byte written by the master, in each write transaction, is the
+	 * register address pointer; it is automatically incremented after each byte
+	 * written or read.
+	 * - next bytes written by the master are stored into successive registers
+	 * - bytes read by the master are read from successive registers, starting
+	 * at the current register pointer (i.e. the usual way to read registers is
+	 * to write the register address, then repeat START and read)
+	 *
+	 * The register file is made of 2 consecutive regions:
+	 * - @p RO_SIZE_ read-only registers, at addresses `[0, RO_SIZE_)`: these are
+	 * written by the program with `set()` and become visible to the master only
+	 * after `publish()` has been called; they are double-buffered so that the
+	 * master always reads a consistent snapshot of all read-only registers,
+	 * even for multi-bytes values. Master writes to these registers are ignored.
+	 * - @p RW_SIZE_ read-write registers, at addresses `[RO_SIZE_, RO_SIZE_ + RW_SIZE_)`:
+	 * these can be written by the master and read by the program with `get()`,
+	 * or written by the program with `set()` (e.g. for initialization)
+	 *
+	 * Reading beyond the last register returns `0xFF`.
+	 *
+	 * The slave can respond to several addresses (through the MCU TWI address
+	 * mask register) and to general calls, as defined by `begin()`.
+	 *
+	 * The ISR only performs direct register accesses, without any copy, hence
+	 * the clock is stretched only for a few µs per byte, which allows serving
+	 * back-to-back reads from a 400kHz I2C master.
+	 *
+	 * @code
+	 * // 4 bytes of measures, 2 bytes of configuration
+	 * using SLAVE = i2c::I2CSlave<4, 2>;
+	 * REGISTER_I2C_SLAVE_ISR(SLAVE)
+	 *
+	 * int main() {
+	 *     board::init();
+	 *     sei();
+	 *     SLAVE slave;
+	 *     slave.begin(0x42);
+	 *     while (true) {
+	 *         slave.set(0, measure1());
+	 *         slave.set(2, measure2());
+	 *         slave.publish();
+	 *         uint8_t config;
+	 *         slave.get(4, config);
+	 *         ...
+	 *     }
+	 * }
+	 * @endcode
+	 *
+	 * @warning You need to register the proper ISR for this class to work properly.
+	 * An ATmega MCU cannot act as an I2C slave and an asynchronous I2C master at
+	 * the same time, as both use the same ISR.
+	 *
+	 * @tparam RO_SIZE_ the number of read-only registers
+	 * @tparam RW_SIZE_ the number of read-write registers
+	 *
+	 * @sa REGISTER_I2C_SLAVE_ISR()
+	 * @sa REGISTER_I2C_SLAVE_ISR_FUNCTION()
+	 * @sa REGISTER_I2C_SLAVE_ISR_METHOD()
+	 */
+	template<uint8_t RO_SIZE_, uint8_t RW_SIZE_> class I2CSlave
+	{
+		static_assert(RO_SIZE_ + RW_SIZE_ > 0, "I2CSlave must have at least one register");
+		static_assert(RO_SIZE_ + RW_SIZE_ < 256, "I2CSlave must have less than 256 registers");
+
+		using I2C_TRAIT = board_traits::TWI_trait;
+		using REG8 = board_traits::REG8;
+
+	public:
+		/** The number of read-only registers, starting at address `0`. */
+		static constexpr const uint8_t RO_SIZE = RO_SIZE_;
+		/** The number of read-write registers, starting at address `RO_SIZE`. */
+		static constexpr const uint8_t RW_SIZE = RW_SIZE_;
+		/** The total number of registers. */
+		static constexpr const uint8_t SIZE = RO_SIZE_ + RW_SIZE_;
+
+		/**
+		 * Create a new I2C slave, with all registers set to `0`.
+		 * The slave is not active until `begin()` is called.
+		 *
+		 * @sa begin()
+		 */
+		I2CSlave()
+		{
+			interrupt::register_handler(*this);
+		}
+
+		/// @cond notdocumented
+		I2CSlave(const I2CSlave&) = delete;
+		I2CSlave& operator=(const I2CSlave&) = delete;
+		/// @endcond
+
+		/**
+		 * Enable MCU I2C slave mode, with the given I2C address(es).
+		 * This method is synchronized.
+		 *
+		 * @param address the 7-bit I2C address of this slave
+		 * @param mask a 7-bit mask of @p address bits that are ignored when
+		 * matching an address on the bus, in order to respond to several
+		 * addresses; the actually matched address can be obtained with
+		 * `address()`. This is ignored on MCU without TWI address mask register.
+		 * @param general_call `true` if this slave shall also respond to general
+		 * calls (address `0x00`)
+		 *
+		 * @sa end()
+		 * @sa begin_()
+		 */
+		void begin(uint8_t address, uint8_t mask = 0, bool general_call = false)
+		{
+			synchronized begin_(address, mask, general_call);
+		}
+
+		/**
+		 * Disable MCU I2C slave mode.
+		 * This method is synchronized.
+		 * @sa begin()
+		 * @sa end_()
+		 */
+		void end()
+		{
+			synchronized end_();
+		}
+
+		/**
+		 * Enable MCU I2C slave mode, with the given I2C address(es).
+		 * This method is NOT synchronized.
+		 *
+		 * @param address the 7-bit I2C address of this slave
+		 * @param mask a 7-bit mask of @p address bits that are ignored when
+		 * matching an address on the bus
+		 * @param general_call `true` if this slave shall also respond to general
+		 * calls (address `0x00`)
+		 *
+		 * @sa end_()
+		 * @sa begin()
+		 */
+		void begin_(uint8_t address, uint8_t mask UNUSED = 0, bool general_call = false)
+		{
+			// 1. set SDA/SCL pullups
+			I2C_TRAIT::PORT |= I2C_TRAIT::SCL_SDA_MASK;
+			// 2. set slave address(es)
+			TWAR_ = uint8_t(address << 1) | (general_call ? bits::BV8(TWGCE) : 0);
+#ifdef TWAMR
+			TWAMR_ = uint8_t(mask << 1);
+#endif
+			address_ = address;
+			reading_ = false;
+			pending_ = false;
+			// 3. Enable TWI and slave address recognition
+			TWCR_ = bits::BV8(TWEN, TWIE, TWEA, TWINT);
+		}
+
+		/**
+		 * Disable MCU I2C slave mode.
+		 * This method is NOT synchronized.
+		 * @sa begin_()
+		 * @sa end()
+		 */
+		void end_()
+		{
+			// 1. Disable TWI
+			TWCR_ = 0;
+			TWAR_ = 0;
+			// 2. remove SDA/SCL pullups
+			I2C_TRAIT::PORT &= bits::COMPL(I2C_TRAIT::SCL_SDA_MASK);
+		}
+
+		/**
+		 * The 7-bit address by which this slave was last addressed by the master.
+		 * This is useful only when this slave responds to several addresses.
+		 */
+		uint8_t address() const
+		{
+			return address_;
+		}
+
+		/**
+		 * Set the value of @p size consecutive registers starting at @p reg.
+		 * All registers must be either read-only or read-write.
+		 *
+		 * Read-only registers set by this method will be visible to the master
+		 * only after `publish()` is called. If a publication, deferred because
+		 * the master was reading at that time, is still pending, then it is
+		 * cancelled, and `publish()` shall be called again.
+		 *
+		 * Read-write registers set by this method are immediately visible to the
+		 * master.
+		 *
+		 * @param reg the address of the first register to set
+		 * @param data pointer to the new values of registers
+		 * @param size the number of registers to set
+		 * @retval true if registers were set
+		 * @retval false if registers were not in the same region, or beyond
+		 * the last register
+		 *
+		 * @sa publish()
+		 */
+		bool set(uint8_t reg, const uint8_t* data, uint8_t size)
+		{
+			if (uint16_t(reg) + size <= RO_SIZE)
+			{
+				prepare_back_();
+				memcpy(back_() + reg, data, size);
+				return true;
+			}
+			if (reg >= RO_SIZE && uint16_t(reg) + size <= SIZE)
+			{
+				synchronized memcpy(rw_ + (reg - RO_SIZE), data, size);
+				return true;
+			}
+			return false;
+		}
+
+		/**
+		 * Set the value of consecutive registers starting at @p reg, from a
+		 * value of any type @p T; @p value is copied as is, i.e. with the
+		 * MCU little-endian byte order.
+		 *
+		 * @sa set(uint8_t, const uint8_t*, uint8_t)
+		 */
+		template<typename T> bool set(uint8_t reg, const T& value)
+		{
+			return set(reg, reinterpret_cast<const uint8_t*>(&value), sizeof(T));
+		}
+
+		/**
+		 * Make all read-only registers, set by `set()` since last call, visible
+		 * to the master at once.
+		 * If the master is currently reading, publication is deferred to the
+		 * end of the current read transaction, in order to ensure the master
+		 * reads consistent values.
+		 */
+		void publish()
+		{
+			synchronized
+			{
+				if (reading_)
+					pending_ = true;
+				else
+					swap_();
+			}
+		}
+
+		/**
+		 * Get the value of @p size consecutive registers starting at @p reg.
+		 * Values of read-only registers are the last values set by `set()`,
+		 * even if not published yet.
+		 * Values of read-write registers are the last values written by the master
+		 * or by `set()`.
+		 *
+		 * @param reg the address of the first register to get
+		 * @param data pointer to a buffer receiving the values of registers
+		 * @param size the number of registers to get
+		 * @retval true if registers were read
+		 * @retval false if registers were not in the same region, or beyond
+		 * the last register
+		 */
+		bool get(uint8_t reg, uint8_t* data, uint8_t size)
+		{
+			if (uint16_t(reg) + size <= RO_SIZE)
+			{
+				// After a swap, back buffer is stale until next set()
+				synchronized memcpy(data, (stale_ ? front_ : back_()) + reg, size);
+				return true;
+			}
+			if (reg >= RO_SIZE && uint16_t(reg) + size <= SIZE)
+			{
+				synchronized memcpy(data, rw_ + (reg - RO_SIZE), size);
+				return true;
+			}
+			return false;
+		}
+
+		/**
+		 * Get the value of consecutive registers starting at @p reg, as a
+		 * value of any type @p T.
+		 *
+		 * @sa get(uint8_t, uint8_t*, uint8_t)
+		 */
+		template<typename T> bool get(uint8_t reg, T& value)
+		{
+			return get(reg, reinterpret_cast<uint8_t*>(&value), sizeof(T));
+		}
+
+	private:
+		// Status codes in slave modes (ATmega328P datasheet, tables 22-4 and 22-5)
+		static constexpr const uint8_t SR_SLA_ACK = 0x60;
+		static constexpr const uint8_t SR_ARB_LOST_SLA_ACK = 0x68;
+		static constexpr const uint8_t SR_GCALL_ACK = 0x70;
+		static constexpr const uint8_t SR_ARB_LOST_GCALL_ACK = 0x78;
+		static constexpr const uint8_t SR_DATA_ACK = 0x80;
+		static constexpr const uint8_t SR_GCALL_DATA_ACK = 0x90;
+		static constexpr const uint8_t SR_STOP = 0xA0;
+		static constexpr const uint8_t ST_SLA_ACK = 0xA8;
+		static constexpr const uint8_t ST_ARB_LOST_SLA_ACK = 0xB0;
+		static constexpr const uint8_t ST_DATA_ACK = 0xB8;
+		static constexpr const uint8_t ST_DATA_NACK = 0xC0;
+		static constexpr const uint8_t ST_LAST_DATA = 0xC8;
+		static constexpr const uint8_t BUS_ERROR = 0x00;
+
+		static constexpr const REG8 TWAR_{TWAR};
+#ifdef TWAMR
+		static constexpr const REG8 TWAMR_{TWAMR};
+#endif
+		static constexpr const REG8 TWSR_{TWSR};
+		static constexpr const REG8 TWCR_{TWCR};
+		static constexpr const REG8 TWDR_{TWDR};
+
+		// Arrays cannot be empty, even when a region has no register
+		static constexpr uint8_t RO_STORAGE = (RO_SIZE_ ? RO_SIZE_ : 1);
+		static constexpr uint8_t RW_STORAGE = (RW_SIZE_ ? RW_SIZE_ : 1);
+
+		uint8_t* back_()
+		{
+			return (front_ == ro_[0] ? ro_[1] : ro_[0]);
+		}
+
+		// Called only from ISR or synchronized code
+		void swap_()
+		{
+			front_ = back_();
+			stale_ = true;
+		}
+
+		// Ensure back buffer contains last published values and cancel any
+		// deferred publication, so that ISR cannot swap buffers anymore
+		void prepare_back_()
+		{
+			synchronized pending_ = false;
+			if (stale_)
+			{
+				memcpy(back_(), front_, RO_SIZE);
+				stale_ = false;
+			}
+		}
+
+		uint8_t next_byte_()
+		{
+			const uint8_t reg = pointer_;
+			if (reg >= SIZE) return 0xFF;
+			pointer_ = reg + 1;
+			if (reg < RO_SIZE) return front_[reg];
+			return rw_[reg - RO_SIZE];
+		}
+
+		void ack_()
+		{
+			TWCR_ = bits::BV8(TWEN, TWIE, TWEA, TWINT);
+		}
+
+		I2CSlaveCallback i2c_change()
+		{
+			switch (TWSR_ & bits::BV8(TWS3, TWS4, TWS5, TWS6, TWS7))
+			{
+				case SR_SLA_ACK:
+				case SR_ARB_LOST_SLA_ACK:
+				address_ = TWDR_ >> 1;
+				general_call_ = false;
+				expect_pointer_ = true;
+				count_ = 0;
+				break;
+
+				case SR_GCALL_ACK:
+				case SR_ARB_LOST_GCALL_ACK:
+				general_call_ = true;
+				expect_pointer_ = true;
+				count_ = 0;
+				break;
+
+				case SR_DATA_ACK:
+				case SR_GCALL_DATA_ACK:
+				{
+					const uint8_t data = TWDR_;
+					const uint8_t reg = pointer_;
+					if (expect_pointer_)
+					{
+						pointer_ = data;
+						expect_pointer_ = false;
+					}
+					else if (reg < SIZE)
+					{
+						if (reg >= RO_SIZE)
+						{
+							rw_[reg - RO_SIZE] = data;
+							if (!count_++) first_ = reg;
+						}
+						pointer_ = reg + 1;
+					}
+					break;
+				}
+
+				case SR_STOP:
+				ack_();
+				if (!count_) return I2CSlaveCallback::NONE;
+				return (general_call_ ? I2CSlaveCallback::GENERAL_CALL : I2CSlaveCallback::WRITE);
+
+				case ST_SLA_ACK:
+				case ST_ARB_LOST_SLA_ACK:
+				address_ = TWDR_ >> 1;
+				reading_ = true;
+				first_ = pointer_;
+				count_ = 0;
+				[[fallthrough]];
+
+				case ST_DATA_ACK:
+				TWDR_ = next_byte_();
+				++count_;
+				break;
+
+				case ST_DATA_NACK:
+				case ST_LAST_DATA:
+				ack_();
+				reading_ = false;
+				if (pending_)
+				{
+					pending_ = false;
+					swap_();
+				}
+				return I2CSlaveCallback::READ;
+
+				case BUS_ERROR:
+				// Release the bus and reset TWI
+				TWCR_ = bits::BV8(TWEN, TWIE, TWEA, TWINT, TWSTO);
+				reading_ = false;
+				return I2CSlaveCallback::NONE;
+			}
+			ack_();
+			return I2CSlaveCallback::NONE;
+		}
+
+		uint8_t ro_[2][RO_STORAGE] = {};
+		uint8_t rw_[RW_STORAGE] = {};
+		uint8_t* volatile front_ = ro_[0];
+		volatile bool stale_ = false;
+		volatile bool pending_ = false;
+		volatile bool reading_ = false;
+
+		// Used by ISR only (or begin_())
+		uint8_t address_ = 0;
+		uint8_t pointer_ = 0;
+		uint8_t first_ = 0;
+		uint8_t count_ = 0;
+		bool expect_pointer_ = false;
+		bool general_call_ = false;
+
+		friend struct slave_isr_handler;
+	};
+
+	/// @cond notdocumented
+	struct slave_isr_handler
+	{
+		template<typename SLAVE>
+		static void i2c_change()
+		{
+			interrupt::HandlerHolder<SLAVE>::handler()->i2c_change();
+		}
+
+		template<typename SLAVE, void (*CALLBACK_)(I2CSlaveCallback, uint8_t, uint8_t)>
+		static void i2c_change_function()
+		{
+			SLAVE* slave = interrupt::HandlerHolder<SLAVE>::handler();
+			I2CSlaveCallback callback = slave->i2c_change();
+			if (callback != I2CSlaveCallback::NONE)
+			{
+				CALLBACK_(callback, slave->first_, slave->count_);
+			}
+		}
+
+		template<typename SLAVE, typename HANDLER_,
+			void (HANDLER_::*CALLBACK_)(I2CSlaveCallback, uint8_t, uint8_t)>
+		static void i2c_change_method()
+		{
+			using interrupt::CallbackHandler;
+			SLAVE* slave = interrupt::HandlerHolder<SLAVE>::handler();
+			I2CSlaveCallback callback = slave->i2c_change();
+			if (callback != I2CSlaveCallback::NONE)
+			{
+				using HANDLER = CallbackHandler<void (HANDLER_::*)(I2CSlaveCallback, uint8_t, uint8_t), CALLBACK_>;
+				HANDLER::call(callback, slave->first_, slave->count_);
+			}
+		}
+	};
+	/// @endcond
+}
+
+#endif /* I2C_SLAVE_HH */
+/// @endcond
@@ -0,0 +1,221 @@
+//   Copyright 2016-2023 Jean-Francois Poilpret
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+/// @cond api
+
+/**
+ * @file
+ * Opt-in instrumentation of queues and event loop, to right-size queues and
+ * buffers from actual figures.
+ *
+ * Instrumentation is enabled by defining `FASTARDUINO_INSTRUMENTATION` when
+ * building FastArduino library and your program, e.g.
+ * `make ADDITIONAL_CXX_OPTIONS=-DFASTARDUINO_INSTRUMENTATION`; since this
+ * changes the layout of some classes, FastArduino library must be rebuilt
+ * with the same option. In this case:
+ * - every `containers::Queue` (hence also every `streams::ostreambuf` and
+ * `streams::istreambuf`, used by UART classes) records its high-water mark
+ * and the number of items that could not be pushed because it was full
+ * - every `events::Event` records the time it was created (i.e. generally
+ * pushed to the events queue, e.g. from an ISR)
+ * - every `events::Dispatcher` records latency of dispatched events, from
+ * their creation to their dispatch
+ * - every `events::EventHandler` and `events::Job` records its execution time
+ *
+ * When `FASTARDUINO_INSTRUMENTATION` is not defined, nothing is recorded,
+ * no class gets bigger and all statistics are empty.
+ *
+ * Times are measured in ticks of a free-running timer, `board::Timer::TIMER1`
+ * by default; this can be changed by defining `FASTARDUINO_INSTRUMENTATION_TIMER`,
+ * e.g. `-DFASTARDUINO_INSTRUMENTATION_TIMER=board::Timer::TIMER3`.
+ * This timer must run in normal mode; it can be started by
+ * `instrumentation::begin()`. Measured times wrap around the timer maximum
+ * counter value, hence the prescaler must be selected according to the
+ * longest expected latency.
+ *
+ * All statistics can be reported, as tab-separated tables, to any `ostream`
+ * (e.g. from a `serial::hard::UATX`):
+ * @code
+ * // Build with ADDITIONAL_CXX_OPTIONS=-DFASTARDUINO_INSTRUMENTATION
+ * instrumentation::begin(instrumentation::PRESCALER::DIV_64);
+ * ...
+ * instrumentation::dump_queue(out, F("events"), event_queue);
+ * instrumentation::dump_queue(out, F("uart tx"), uart.out().rdbuf().queue());
+ * instrumentation::dump_dispatcher(out, dispatcher);
+ * instrumentation::dump_scheduler(out, scheduler);
+ * @endcode
+ */
+#ifndef INSTRUMENTATION_HH
+#define INSTRUMENTATION_HH
+
+#include "boards/board_traits.h"
+#include "flash.h"
+#include "utilities.h"
+
+#ifndef FASTARDUINO_INSTRUMENTATION_TIMER
+/**
+ * The timer used by instrumentation to measure latencies and execution times.
+ */
+#define FASTARDUINO_INSTRUMENTATION_TIMER board::Timer::TIMER1
+#endif
+
+/**
+ * Defines API to start instrumentation and report its statistics.
+ * @sa instrumentation.h
+ */
+namespace instrumentation
+{
+	/// @cond notdocumented
+	using TRAIT = board_traits::Timer_trait<FASTARDUINO_INSTRUMENTATION_TIMER>;
+	using TIMER_TYPE = typename TRAIT::TYPE;
+	/// @endcond
+
+	/** The type of prescaler of the instrumentation timer. */
+	using PRESCALER = typename TRAIT::TIMER_PRESCALER;
+
+	/**
+	 * Statistics of a measured duration (latency or execution time), in ticks
+	 * of the instrumentation timer.
+	 */
+	struct Stats
+	{
+		/** Number of measures. */
+		uint32_t count = 0UL;
+		/** Total duration of all measures. */
+		uint32_t total = 0UL;
+		/** Minimum duration. */
+		uint16_t min = 0xFFFFU;
+		/** Maximum duration. */
+		uint16_t max = 0U;
+
+		/// @cond notdocumented
+		void add_(uint16_t duration) INLINE
+		{
+			++count;
+			total += duration;
+			if (duration < min) min = duration;
+			if (duration > max) max = duration;
+		}
+		/// @endcond
+	};
+
+	/**
+	 * Start the instrumentation timer in normal mode, with @p prescaler.
+	 * You do not need to call this function if the instrumentation timer is
+	 * already running in normal mode for other purposes.
+	 * No interrupt is enabled for this timer.
+	 * This does nothing when `FASTARDUINO_INSTRUMENTATION` is not defined.
+	 * @param prescaler the prescaler value for the instrumentation timer
+	 */
+	inline void begin(UNUSED PRESCALER prescaler = PRESCALER::NO_PRESCALING)
+	{
+#ifdef FASTARDUINO_INSTRUMENTATION
+		synchronized
+		{
+			if (!TRAIT::TCCRA.is_no_reg()) TRAIT::TCCRA = 0;
+			TRAIT::TCCRB = TRAIT::TCCRB_prescaler(prescaler);
+			TRAIT::TCNT = 0;
+		}
+#endif
+	}
+
+	/// @cond notdocumented
+	inline uint16_t now_() INLINE;
+	inline uint16_t now_()
+	{
+		return TRAIT::TCNT;
+	}
+
+	inline uint16_t since_(uint16_t start) INLINE;
+	inline uint16_t since_(uint16_t start)
+	{
+		return TIMER_TYPE(TRAIT::TCNT - start);
+	}
+
+	template<typename OSTREAM> void dump_stats_(OSTREAM& out, const Stats& stats)
+	{
+		const uint16_t min = (stats.count ? stats.min : 0U);
+		const uint32_t avg = (stats.count ? stats.total / stats.count : 0UL);
+		out << '\t' << stats.count << '\t' << min << '\t' << stats.max << '\t' << avg << '\n';
+	}
+	/// @endcond
+
+	/**
+	 * Output one line with statistics @p stats, named @p name, to @p out:
+	 * name, count, min, max and average duration (tab-separated).
+	 */
+	template<typename OSTREAM> void dump(OSTREAM& out, const flash::FlashStorage* name, const Stats& stats)
+	{
+		out << name;
+		dump_stats_(out, stats);
+	}
+
+	/**
+	 * Output one line with statistics of @p queue, named @p name, to @p out:
+	 * name, size, high-water mark and overflows count (tab-separated).
+	 * @param out the output stream
+	 * @param name the name of the queue
+	 * @param queue the queue, e.g. an events queue or the queue of a
+	 * `streams::ostreambuf`
+	 * @sa containers::Queue::max_items()
+	 * @sa containers::Queue::overflows()
+	 */
+	template<typename OSTREAM, typename QUEUE>
+	void dump_queue(OSTREAM& out, const flash::FlashStorage* name, const QUEUE& queue)
+	{
+		out	<< F("queue\t") << name << '\t' << queue.size() << '\t' << queue.max_items() << '\t'
+			<< queue.overflows() << '\n';
+	}
+
+	/**
+	 * Output statistics of @p dispatcher to @p out: latency of all dispatched
+	 * events, then execution time of each registered handler (with its type).
+	 * @param out the output stream
+	 * @param dispatcher the `events::Dispatcher` to report
+	 * @sa events::Dispatcher::latency()
+	 * @sa events::EventHandler::stats()
+	 */
+	template<typename OSTREAM, typename DISPATCHER> void dump_dispatcher(OSTREAM& out, DISPATCHER& dispatcher)
+	{
+		out << F("dispatch\tcount\tmin\tmax\tavg\n");
+		dump(out, F("latency"), dispatcher.latency());
+		dispatcher.traverse([&out](auto& handler)
+		{
+			out << F("type ") << uint16_t(handler.type());
+			dump_stats_(out, handler.stats());
+			return false;
+		});
+	}
+
+	/**
+	 * Output statistics of @p scheduler to @p out: execution time of each
+	 * currently scheduled job (with its period).
+	 * @param out the output stream
+	 * @param scheduler the `events::Scheduler` to report
+	 * @sa events::Job::stats()
+	 */
+	template<typename OSTREAM, typename SCHEDULER> void dump_scheduler(OSTREAM& out, SCHEDULER& scheduler)
+	{
+		out << F("job\tcount\tmin\tmax\tavg\n");
+		scheduler.traverse([&out](auto& job)
+		{
+			out << F("period ") << job.period();
+			dump_stats_(out, job.stats());
+			return false;
+		});
+	}
+}
+
+#endif /* INSTRUMENTATION_HH */
+/// @endcond
@@ -71,7 +71,7 @@
 	void CAT3(INT, INT_NUM, _vect)(void)                            \
 	{                                                               \
 		interrupt::isr_handler_int::check_int_pin<INT_NUM, PIN>();  \
-		__asm__ __volatile__("reti" ::);                            \
+		reti();                                                    \
 	}
 
 /**
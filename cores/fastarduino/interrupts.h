@@ -40,6 +40,14 @@
  * be registered with `interrupt::register_handler()` so that the defined ISR can find
  * it when it gets executed.
  * 
+ * Some FastArduino API also define a `REGISTER_XXX_ISR_STATIC` flavour, which binds
+ * the ISR to a handler instance at compile time: this instance must be a global (or
+ * static) variable, which address is known at link time, hence the ISR does not
+ * need to load (and check) the handler pointer registered by `interrupt::register_handler()`.
+ * For the hottest ISR (e.g. `timer::RTT` tick), this flavour may even generate a
+ * naked ISR, saving only the registers it actually uses, like `REGISTER_XXX_ISR_EMPTY`
+ * macros do.
+ * 
  * Note that some FastArduino API define a 3rd flavour of registration macro where
  * you don't need to specify a callback function or method, because this callback 
  * is implicitly defined by the API, e.g. `REGISTER_WATCHDOG_CLOCK_ISR()` defines
@@ -165,6 +173,18 @@ namespace interrupt
 			return CALLBACK(args...);
 		}
 	};
+
+	// Used by ISR to perform a callback to a PTMF on an instance bound at compile
+	// time (address known at link time): no handler pointer to load and check
+	template<typename T, T> struct StaticCallbackHandler;
+	template<typename HANDLER, typename RET, typename... ARGS, RET (HANDLER::*CALLBACK)(ARGS...)>
+	struct StaticCallbackHandler<RET (HANDLER::*)(ARGS...), CALLBACK>
+	{
+		template<HANDLER& INSTANCE> static RET call(ARGS... args)
+		{
+			return (INSTANCE.*CALLBACK)(args...);
+		}
+	};
 	/// @endcond
 
 	/**
@@ -218,5 +238,10 @@ namespace interrupt
 
 /// @endcond
 
+#if defined(FASTARDUINO_ISR_PROFILE) || defined(FASTARDUINO_POWER_PROFILE)
+// All ISR defined from now on will be profiled
+#include "isr_profiler.h"
+#endif
+
 #endif /* INTERRUPTS_HH */
 /// @endcond
@@ -0,0 +1,340 @@
+//   Copyright 2016-2023 Jean-Francois Poilpret
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+/// @cond api
+
+/**
+ * @file
+ * Opt-in profiler of ISR durations, with per-vector statistics.
+ *
+ * Profiling is enabled by defining `FASTARDUINO_ISR_PROFILE` when building
+ * your program, e.g. `make ADDITIONAL_CXX_OPTIONS=-DFASTARDUINO_ISR_PROFILE`.
+ * In this case, avr-libc `ISR()` macro, which is used by all FastArduino
+ * `REGISTER_XXX_ISR()` macros, is redefined so that every ISR reads a
+ * free-running timer on entry and on exit, and updates its own statistics:
+ * number of calls, min, max and total duration, number of calls nested inside
+ * another ISR. The maximum nesting depth of all ISR is also recorded.
+ *
+ * When `FASTARDUINO_ISR_PROFILE` is not defined, `interrupt::ISRProfiler` API
+ * compiles to nothing, and ISR are not changed at all unless power profiling
+ * (`FASTARDUINO_POWER_PROFILE`, see power.h) is enabled, in which case every ISR
+ * just records itself as the source of MCU wakeup.
+ *
+ * The timer used for timestamps is `board::Timer::TIMER1` by default; this
+ * can be changed by defining `FASTARDUINO_ISR_PROFILE_TIMER`, e.g.
+ * `-DFASTARDUINO_ISR_PROFILE_TIMER=board::Timer::TIMER3`. This timer must
+ * run in normal mode (counting up to its maximum, then wrapping to 0); it can
+ * be started by `interrupt::ISRProfiler::begin()`.
+ * A 16-bit timer should be used; with a 8-bit timer, durations are counted
+ * modulo 256 ticks.
+ *
+ * Limitations:
+ * - ISR declared with `ISR_NAKED` cannot be profiled and will not work
+ * - naked ISR defined by FastArduino (empty ISR, e.g. `REGISTER_INT_ISR_EMPTY()`)
+ * are not profiled
+ * - ISR are identified by their avr-libc name, i.e. `__vector_N`, where `N`
+ * is the vector number (`0` is RESET) as listed in the MCU datasheet
+ * - durations of nested ISR are also included in the duration of the ISR
+ * they interrupted
+ *
+ * @code
+ * // Build with ADDITIONAL_CXX_OPTIONS=-DFASTARDUINO_ISR_PROFILE
+ * #include <fastarduino/isr_profiler.h>
+ * ...
+ * interrupt::ISRProfiler::begin();
+ * ...
+ * interrupt::ISRProfiler::dump(out);
+ * @endcode
+ */
+#ifndef ISR_PROFILER_HH
+#define ISR_PROFILER_HH
+
+#include "boards/board_traits.h"
+#include "flash.h"
+#include "utilities.h"
+
+#ifndef FASTARDUINO_ISR_PROFILE_TIMER
+/**
+ * The timer used by ISR profiler to timestamp ISR entry and exit.
+ */
+#define FASTARDUINO_ISR_PROFILE_TIMER board::Timer::TIMER1
+#endif
+
+namespace interrupt
+{
+	/**
+	 * Statistics of one ISR, as collected by the ISR profiler.
+	 * All durations are in ticks of the profiling timer.
+	 * @sa ISRProfiler
+	 */
+	struct ISRStatsData
+	{
+		/** Number of calls of this ISR. */
+		uint32_t count = 0UL;
+		/** Total duration of all calls of this ISR. */
+		uint32_t total = 0UL;
+		/** Minimum duration of one call of this ISR. */
+		uint16_t min = 0xFFFFU;
+		/** Maximum duration of one call of this ISR. */
+		uint16_t max = 0U;
+		/** Number of calls of this ISR that occurred while another ISR was executing. */
+		uint16_t nested = 0U;
+	};
+
+	class ISRProfiler;
+
+	/**
+	 * Statistics holder of one ISR; one instance is automatically created for
+	 * each ISR when profiling is enabled. You never need to create an instance
+	 * yourself.
+	 * @sa ISRProfiler
+	 */
+	class ISRStats
+	{
+	public:
+		/// @cond notdocumented
+		explicit ISRStats(const flash::FlashStorage* name);
+		ISRStats(const ISRStats&) = delete;
+		ISRStats& operator=(const ISRStats&) = delete;
+		/// @endcond
+
+		/**
+		 * The name of the ISR, in flash.
+		 */
+		const flash::FlashStorage* name() const
+		{
+			return name_;
+		}
+
+		/**
+		 * Return a consistent copy of the current statistics of the ISR.
+		 */
+		ISRStatsData stats() const
+		{
+			synchronized return data_;
+		}
+
+		/**
+		 * The next ISR statistics in the list of all ISR statistics, or
+		 * `nullptr` if this is the last one.
+		 */
+		const ISRStats* next() const
+		{
+			return next_;
+		}
+
+	private:
+		void enter_(bool nested) INLINE
+		{
+			++data_.count;
+			if (nested) ++data_.nested;
+		}
+
+		void exit_(uint16_t duration) INLINE
+		{
+			data_.total += duration;
+			if (duration < data_.min) data_.min = duration;
+			if (duration > data_.max) data_.max = duration;
+		}
+
+		const flash::FlashStorage* name_;
+		ISRStats* next_;
+		ISRStatsData data_;
+
+		friend class ISRProfiler;
+		template<board::Timer> friend class ISRProbe;
+	};
+
+	/**
+	 * API to start ISR profiling, reset and dump its statistics.
+	 * All methods do nothing when `FASTARDUINO_ISR_PROFILE` is not defined.
+	 */
+	class ISRProfiler
+	{
+	private:
+		using TRAIT = board_traits::Timer_trait<FASTARDUINO_ISR_PROFILE_TIMER>;
+
+	public:
+		/** The type of prescaler of the profiling timer. */
+		using PRESCALER = typename TRAIT::TIMER_PRESCALER;
+
+		ISRProfiler() = delete;
+
+		/**
+		 * Start the profiling timer in normal mode, with @p prescaler.
+		 * You do not need to call this method if the profiling timer is already
+		 * running in normal mode for other purposes.
+		 * No interrupt is enabled for this timer.
+		 * @param prescaler the prescaler value for the profiling timer; with
+		 * the default value, ISR durations are measured in CPU cycles.
+		 */
+		static void begin(UNUSED PRESCALER prescaler = PRESCALER::NO_PRESCALING)
+		{
+#ifdef FASTARDUINO_ISR_PROFILE
+			synchronized
+			{
+				if (!TRAIT::TCCRA.is_no_reg()) TRAIT::TCCRA = 0;
+				TRAIT::TCCRB = TRAIT::TCCRB_prescaler(prescaler);
+				TRAIT::TCNT = 0;
+			}
+#endif
+		}
+
+		/**
+		 * Reset statistics of all ISR.
+		 */
+		static void reset()
+		{
+#ifdef FASTARDUINO_ISR_PROFILE
+			synchronized
+			{
+				for (ISRStats* stats = head_; stats != nullptr; stats = stats->next_)
+					stats->data_ = ISRStatsData{};
+				max_depth_ = 0;
+			}
+#endif
+		}
+
+		/**
+		 * The first ISR statistics in the list of all ISR statistics, or
+		 * `nullptr` if there is none (e.g. because profiling is not enabled).
+		 */
+		static const ISRStats* first()
+		{
+			return head_;
+		}
+
+		/**
+		 * The maximum nesting depth of ISR since start or last `reset()`;
+		 * this is `1` if no ISR was ever interrupted by another ISR.
+		 */
+		static uint8_t max_depth()
+		{
+			return max_depth_;
+		}
+
+		/**
+		 * Output statistics of all ISR to @p out, as a tab-separated table
+		 * (one line per ISR), followed by the maximum nesting depth.
+		 * Average duration is calculated on the fly.
+		 * @param out the output stream
+		 */
+		template<typename OSTREAM> static void dump(UNUSED OSTREAM& out)
+		{
+#ifdef FASTARDUINO_ISR_PROFILE
+			out << F("ISR\tcount\tmin\tmax\tavg\tnested\n");
+			for (const ISRStats* stats = first(); stats != nullptr; stats = stats->next())
+			{
+				const ISRStatsData data = stats->stats();
+				const uint16_t min = (data.count ? data.min : 0U);
+				const uint32_t avg = (data.count ? data.total / data.count : 0UL);
+				out	<< stats->name() << '\t' << data.count << '\t' << min << '\t' << data.max << '\t'
+					<< avg << '\t' << data.nested << '\n';
+			}
+			out << F("max depth\t") << max_depth() << '\n';
+#endif
+		}
+
+	private:
+		static void enter_(ISRStats& stats) INLINE
+		{
+			stats.enter_(depth_ != 0);
+			if (++depth_ > max_depth_) max_depth_ = depth_;
+		}
+
+		static void exit_() INLINE
+		{
+			--depth_;
+		}
+
+		static inline ISRStats* head_ = nullptr;
+		static inline volatile uint8_t depth_ = 0;
+		static inline uint8_t max_depth_ = 0;
+
+		friend class ISRStats;
+		template<board::Timer> friend class ISRProbe;
+	};
+
+	/// @cond notdocumented
+	inline ISRStats::ISRStats(const flash::FlashStorage* name) : name_{name}, next_{ISRProfiler::head_}
+	{
+		ISRProfiler::head_ = this;
+	}
+
+	// Instantiated on the stack of each profiled ISR
+	template<board::Timer NTIMER> class ISRProbe
+	{
+		using TRAIT = board_traits::Timer_trait<NTIMER>;
+		using TYPE = typename TRAIT::TYPE;
+
+	public:
+		explicit ISRProbe(ISRStats& stats) INLINE : stats_{stats}, start_{TRAIT::TCNT}
+		{
+			ISRProfiler::enter_(stats_);
+		}
+
+		~ISRProbe() INLINE
+		{
+			stats_.exit_(TYPE(TRAIT::TCNT - start_));
+			ISRProfiler::exit_();
+		}
+
+	private:
+		ISRStats& stats_;
+		const TYPE start_;
+	};
+	/// @endcond
+}
+
+#if defined(FASTARDUINO_ISR_PROFILE) || defined(FASTARDUINO_POWER_PROFILE)
+/// @cond notdocumented
+// Redefine avr-libc ISR() macro, so that every ISR gets profiled (and/or
+// records itself as wakeup source for power profiling, see power.h).
+// The extra macro level ensures vector gets expanded (to __vector_N) before
+// being pasted or stringified.
+#undef ISR
+#define ISR(vector, ...) ISR_PROFILED_(vector, ##__VA_ARGS__)
+
+#ifdef FASTARDUINO_ISR_PROFILE
+#define ISR_STATS_(vector) static interrupt::ISRStats vector##_stats_{(const flash::FlashStorage*) vector##_name_};
+#define ISR_PROBE_(vector) interrupt::ISRProbe<FASTARDUINO_ISR_PROFILE_TIMER> probe{vector##_stats_};
+#else
+#define ISR_STATS_(vector)
+#define ISR_PROBE_(vector)
+#endif
+
+#ifdef FASTARDUINO_POWER_PROFILE
+#include "power.h"
+#define ISR_WAKEUP_(vector) power::Power::wakeup_((const flash::FlashStorage*) vector##_name_);
+#else
+#define ISR_WAKEUP_(vector)
+#endif
+
+#define ISR_PROFILED_(vector, ...)                                                                  \
+	extern "C" void vector(void) SIGNAL_HANDLER __attribute__((__INTR_ATTRS)) __VA_ARGS__;          \
+	static inline void vector##_profiled_(void) INLINE;                                             \
+	static const char vector##_name_[] PROGMEM = #vector;                                           \
+	ISR_STATS_(vector)                                                                              \
+	void vector(void)                                                                               \
+	{                                                                                               \
+		ISR_WAKEUP_(vector)                                                                         \
+		ISR_PROBE_(vector)                                                                          \
+		vector##_profiled_();                                                                       \
+	}                                                                                               \
+	static inline void vector##_profiled_(void)
+/// @endcond
+#endif
+
+#endif /* ISR_PROFILER_HH */
+/// @endcond
@@ -14,6 +14,8 @@
 
 #include "defines.h"
 
+// Host-native builds (CONF=HOST) use the host C runtime
+#ifndef FASTARDUINO_HOST
 int main() WEAK;
 int main()
 {
@@ -22,3 +24,5 @@ int main()
 
 void exit(int status) WEAK;
 void exit(int status UNUSED) {}
+
+#endif
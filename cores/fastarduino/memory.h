@@ -17,18 +17,55 @@
 /**
  * @file 
  * Utilities to check memory usage.
+ *
+ * Besides current free SRAM, this can monitor the stack high-water mark:
+ * free SRAM (between end of static variables and stack) is painted with a
+ * known pattern at startup, either by `REGISTER_STACK_PAINTER()` (best, as
+ * SRAM is painted before any constructor or `main()` is called) or by calling
+ * `memory::paint_stack()` first thing in `main()`; later on, the number of
+ * bytes still holding that pattern tells the maximum depth the stack has
+ * ever reached, including all nested ISR calls.
+ *
+ * @code
+ * REGISTER_STACK_PAINTER()
+ * ...
+ * memory::dump_sram(out);
+ * @endcode
+ *
+ * This runtime measure can be checked against the static worst-case stack
+ * analysis performed by `make STACK_USAGE=true stack-usage`.
  */
 #ifndef MEMORY_H
 #define MEMORY_H
 
 #include <stdint.h>
+#include "flash.h"
 #include "gpio.h"
 
 /// @cond notdocumented
+extern int __data_start;
+extern int __data_end;
+extern int __bss_start;
+extern int __bss_end;
 extern int __heap_start;
 extern int* __brkval;
 /// @endcond
 
+/**
+ * Register a function, executed at startup before any constructor or `main()`,
+ * that paints all free SRAM with `memory::STACK_PAINT`, for later stack
+ * high-water mark measurement.
+ * This macro must be called at most once in a program.
+ * @sa memory::stack_unused()
+ * @sa memory::paint_stack()
+ */
+#define REGISTER_STACK_PAINTER()                                                               \
+	extern "C" void fastarduino_paint_stack_() __attribute__((naked, used, section(".init3"))); \
+	void fastarduino_paint_stack_()                                                            \
+	{                                                                                          \
+		memory::paint_stack();                                                                 \
+	}
+
 /**
  * Contains a few utility method to deal with free SRAM memory.
  */
@@ -40,7 +77,7 @@ namespace memory
 	int free_mem()
 	{
 		int v;
-		return (int) &v - (__brkval == nullptr ? (int) &__heap_start : (int) __brkval);
+		return (intptr_t) &v - (__brkval == nullptr ? (intptr_t) &__heap_start : (intptr_t) __brkval);
 	}
 
 	/**
@@ -71,6 +108,83 @@ namespace memory
 		else
 			gpio::FastPinType<board::DigitalPin::LED>::set();
 	}
+
+	/**
+	 * The byte pattern used to paint free SRAM.
+	 * @sa paint_stack()
+	 */
+	static constexpr const uint8_t STACK_PAINT = 0xC5;
+
+	/// @cond notdocumented
+	inline uint8_t* heap_end_() INLINE;
+	inline uint8_t* heap_end_()
+	{
+		return (uint8_t*) (__brkval == nullptr ? &__heap_start : __brkval);
+	}
+	/// @endcond
+
+	/**
+	 * Paint all free SRAM, from the end of static variables up to the current
+	 * top of stack, with `STACK_PAINT`.
+	 * This should be called first thing in `main()`, if `REGISTER_STACK_PAINTER()`
+	 * is not used; the heap must not be in use yet.
+	 * @sa REGISTER_STACK_PAINTER()
+	 * @sa stack_unused()
+	 */
+	inline void paint_stack() INLINE;
+	inline void paint_stack()
+	{
+		// Do not use heap_end_() here: when called from .init3, .bss (hence
+		// __brkval) is not cleared yet
+		uint8_t* top = (uint8_t*) SP;
+		for (uint8_t* address = (uint8_t*) &__heap_start; address < top; ++address)
+			*address = STACK_PAINT;
+	}
+
+	/**
+	 * Return the number of bytes of SRAM that were never used by the stack
+	 * since SRAM was painted, i.e. the smallest free SRAM ever, including
+	 * during ISR calls.
+	 * @sa paint_stack()
+	 * @sa REGISTER_STACK_PAINTER()
+	 */
+	inline uint16_t stack_unused()
+	{
+		const uint8_t* address = heap_end_();
+		while (address <= (const uint8_t*) RAMEND && *address == STACK_PAINT) ++address;
+		return address - heap_end_();
+	}
+
+	/**
+	 * Return the maximum number of bytes ever used by the stack since SRAM was
+	 * painted (stack high-water mark).
+	 * @sa paint_stack()
+	 * @sa REGISTER_STACK_PAINTER()
+	 */
+	inline uint16_t stack_max_used()
+	{
+		return (uint8_t*) (RAMEND + 1) - heap_end_() - stack_unused();
+	}
+
+	/**
+	 * Output the budget of SRAM to @p out, as a tab-separated table: size of
+	 * `.data` and `.bss` sections, SRAM available to the stack, stack
+	 * high-water mark and the remaining margin (bytes never used).
+	 * SRAM must have been painted at startup for stack values to be correct.
+	 * @param out the output stream
+	 * @sa paint_stack()
+	 * @sa REGISTER_STACK_PAINTER()
+	 */
+	template<typename OSTREAM> void dump_sram(OSTREAM& out)
+	{
+		const uint16_t unused = stack_unused();
+		const uint16_t available = (uint8_t*) (RAMEND + 1) - heap_end_();
+		out	<< F("data\t") << uint16_t((uint8_t*) &__data_end - (uint8_t*) &__data_start) << '\n'
+			<< F("bss\t") << uint16_t((uint8_t*) &__bss_end - (uint8_t*) &__bss_start) << '\n'
+			<< F("stack available\t") << available << '\n'
+			<< F("stack max\t") << uint16_t(available - unused) << '\n'
+			<< F("margin\t") << unused << '\n';
+	}
 }
 
 #endif /* MEMORY_H */
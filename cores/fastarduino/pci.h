@@ -62,6 +62,26 @@
 		interrupt::isr_handler_pci::pci_function<PCI_NUM, CALLBACK, PIN, ##__VA_ARGS__>(); \
 	}
 
+/**
+ * Register the necessary ISR (Interrupt Service Routine) for a Pin Change Interrupt 
+ * vector, with a callback method bound to a global handler instance at compile time.
+ * Contrarily to `REGISTER_PCI_ISR_METHOD()`, the ISR directly uses the address of
+ * @p INSTANCE, known at link time, instead of loading the handler pointer
+ * registered with `interrupt::register_handler()`, which is not needed then.
+ * @param PCI_NUM the number of the `PCINT` vector for the given @p PIN pins
+ * @param INSTANCE the global (or static) handler instance holding the callback method
+ * @param CALLBACK the method of @p INSTANCE class that will be called when the 
+ * interrupt is triggered; this must be a proper PTMF (pointer to member function).
+ * @param PIN the `board::InterruptPin` pins for @p PCI_NUM; if any of the given 
+ * @p PIN does not match with @p PCI_NUM, compilation will fail.
+ */
+#define REGISTER_PCI_ISR_METHOD_STATIC(PCI_NUM, INSTANCE, CALLBACK, PIN, ...)       \
+	ISR(CAT3(PCINT, PCI_NUM, _vect))                                                \
+	{                                                                               \
+		interrupt::isr_handler_pci::pci_method_static<                              \
+			PCI_NUM, decltype(INSTANCE), INSTANCE, CALLBACK, PIN, ##__VA_ARGS__>(); \
+	}
+
 /**
  * Register an empty ISR (Interrupt Service Routine) for a Pin Change Interrupt 
  * vector.
@@ -76,7 +96,7 @@
 	void CAT3(PCINT, PCI_NUM, _vect)(void)                                          \
 	{                                                                               \
 		interrupt::isr_handler_pci::check_pci_pins<PCI_NUM, PIN, ##__VA_ARGS__>();  \
-		__asm__ __volatile__("reti" ::);                                            \
+		reti();                                                                    \
 	}
 
 /**
@@ -144,6 +164,16 @@ namespace interrupt
 			interrupt::CallbackHandler<void (HANDLER_::*)(), CALLBACK_>::call();
 		}
 
+		template<uint8_t PCI_NUM_, typename HANDLER_, HANDLER_& INSTANCE_, void (HANDLER_::*CALLBACK_)(),
+				 board::InterruptPin... PCIPINS_>
+		static void pci_method_static()
+		{
+			// Check pin is compliant
+			check_pci_pins<PCI_NUM_, PCIPINS_...>();
+			// Call handler back
+			interrupt::StaticCallbackHandler<void (HANDLER_::*)(), CALLBACK_>::template call<INSTANCE_>();
+		}
+
 		template<uint8_t PCI_NUM_, void (*CALLBACK_)(), board::InterruptPin... PCIPINS_> static void pci_function()
 		{
 			// Check pin is compliant
@@ -15,3 +15,14 @@
 #include "power.h"
 
 board::SleepMode power::Power::default_mode_ = board::SleepMode::IDLE;
+
+#ifdef FASTARDUINO_POWER_PROFILE
+power::Power::CLOCK_PTR power::Power::clock_ = nullptr;
+time::RTTTime power::Power::start_{0UL, 0U};
+power::SleepStats power::Power::modes_[MAX_MODES];
+power::SleepStats power::Power::sources_[FASTARDUINO_POWER_PROFILE_SOURCES];
+const flash::FlashStorage* power::Power::names_[FASTARDUINO_POWER_PROFILE_SOURCES];
+power::SleepStats power::Power::unknown_;
+volatile bool power::Power::sleeping_ = false;
+const flash::FlashStorage* volatile power::Power::source_ = nullptr;
+#endif
@@ -17,11 +17,59 @@
 /**
  * @file
  * Simple power support for AVR MCU.
+ *
+ * Opt-in energy profiling is enabled by defining `FASTARDUINO_POWER_PROFILE`
+ * when building FastArduino library and your program, e.g.
+ * `make ADDITIONAL_CXX_OPTIONS=-DFASTARDUINO_POWER_PROFILE` (FastArduino
+ * library must be rebuilt with the same option, as `time::yield()` uses
+ * `power::Power::sleep()`). In this case, every call to `power::Power::sleep()`
+ * timestamps sleep entry and exit with a clock set by `power::Power::begin_profile()`
+ * (a `timer::RTT` or a `watchdog::WatchdogRTT`), and accumulates:
+ * - sleep time (and number of sleeps) per `board::SleepMode`
+ * - sleep time (and number of wakeups) per wakeup source, i.e. the first ISR
+ * executed after MCU was awakened
+ * - total time elapsed since profiling started, hence active time and duty cycle
+ *
+ * The clock must keep counting in all sleep modes used by your program:
+ * `timer::RTT` is fine for `board::SleepMode::IDLE` (the RTT tick then shows
+ * as a wakeup source) but stops in deeper modes, where `watchdog::WatchdogRTT`
+ * should be used instead (with a coarser resolution).
+ *
+ * Wakeup sources are recorded by all ISR defined through avr-libc `ISR()`
+ * macro, hence all FastArduino `REGISTER_XXX_ISR()` macros (see isr_profiler.h);
+ * wakeups caused by naked ISR (e.g. `REGISTER_INT_ISR_EMPTY()`) are reported
+ * as "unknown".
+ *
+ * When `FASTARDUINO_POWER_PROFILE` is not defined, `power::Power::sleep()` is
+ * not changed and all profiling API compiles to nothing.
+ *
+ * @code
+ * // Build with ADDITIONAL_CXX_OPTIONS=-DFASTARDUINO_POWER_PROFILE
+ * timer::RTT<board::Timer::TIMER0> rtt;
+ * rtt.begin();
+ * power::Power::begin_profile(rtt);
+ * ...
+ * power::Power::dump_profile(out);
+ * @endcode
  */
 #ifndef POWER_HH
 #define POWER_HH
 
 #include "boards/board.h"
+#include "flash.h"
+#include "time.h"
+#include "utilities.h"
+#ifdef FASTARDUINO_POWER_PROFILE
+#include <avr/interrupt.h>
+#endif
+
+#ifndef FASTARDUINO_POWER_PROFILE_SOURCES
+/**
+ * The maximum number of distinct wakeup sources recorded by power profiling;
+ * wakeups from extra sources are reported as "unknown".
+ */
+#define FASTARDUINO_POWER_PROFILE_SOURCES 8
+#endif
 
 /**
  * Defines simple API to handle AVR power sleep modes.
@@ -32,6 +80,18 @@ namespace power
 	extern void sleep(uint8_t mode);
 	/// @endcond
 
+	/**
+	 * Energy profiling statistics of one sleep mode or one wakeup source.
+	 * @sa Power::mode_profile()
+	 */
+	struct SleepStats
+	{
+		/** Number of sleeps in this mode, or of wakeups by this source. */
+		uint32_t count = 0UL;
+		/** Total time slept in this mode, or before a wakeup by this source. */
+		time::RTTTime time{0UL, 0U};
+	};
+
 	/**
 	 * This class contains the API for handling power sleep modes.
 	 * It is not aimed for instantiation, as all its methods are static.
@@ -83,11 +143,231 @@ namespace power
 		 */
 		static void sleep(board::SleepMode mode)
 		{
+#ifdef FASTARDUINO_POWER_PROFILE
+			if (clock_ != nullptr)
+			{
+				const time::RTTTime start = clock_();
+				// Interrupts get enabled again right before entering sleep,
+				// hence the first ISR executed afterwards is the wakeup source
+				cli();
+				source_ = nullptr;
+				sleeping_ = true;
+				::power::sleep((uint8_t) mode);
+				sleeping_ = false;
+				account_(mode, clock_() - start);
+				return;
+			}
+#endif
 			::power::sleep((uint8_t) mode);
 		}
 
+		/**
+		 * Start (or restart) energy profiling, using @p clock to timestamp
+		 * sleep entry and exit; all profiling statistics are reset.
+		 * This does nothing when `FASTARDUINO_POWER_PROFILE` is not defined.
+		 * @tparam CLOCK the type of @p clock; it must provide either
+		 * `time::RTTTime time() const` (e.g. `timer::RTT`) or
+		 * `uint32_t millis() const` (e.g. `watchdog::WatchdogRTT`)
+		 * @param clock the clock, already started, that must keep counting
+		 * in all sleep modes used by the program
+		 */
+		template<typename CLOCK> static void begin_profile(UNUSED const CLOCK& clock)
+		{
+#ifdef FASTARDUINO_POWER_PROFILE
+			ProfileClock_<CLOCK>::clock_ = &clock;
+			clock_ = ProfileClock_<CLOCK>::now;
+			reset_profile();
+#endif
+		}
+
+		/**
+		 * Reset all energy profiling statistics; total time is counted again
+		 * from now.
+		 */
+		static void reset_profile()
+		{
+#ifdef FASTARDUINO_POWER_PROFILE
+			for (SleepStats& stats : modes_) stats = SleepStats{};
+			for (SleepStats& stats : sources_) stats = SleepStats{};
+			for (const flash::FlashStorage*& name : names_) name = nullptr;
+			unknown_ = SleepStats{};
+			if (clock_ != nullptr) start_ = clock_();
+#endif
+		}
+
+		/**
+		 * Energy profiling statistics of sleep @p mode (empty if
+		 * `FASTARDUINO_POWER_PROFILE` is not defined).
+		 */
+		static SleepStats mode_profile(UNUSED board::SleepMode mode)
+		{
+#ifdef FASTARDUINO_POWER_PROFILE
+			return modes_[mode_index_(mode)];
+#else
+			return SleepStats{};
+#endif
+		}
+
+		/**
+		 * Time elapsed since energy profiling started (or was reset)
+		 * (zero if `FASTARDUINO_POWER_PROFILE` is not defined).
+		 */
+		static time::RTTTime total_time()
+		{
+#ifdef FASTARDUINO_POWER_PROFILE
+			if (clock_ != nullptr) return clock_() - start_;
+#endif
+			return time::RTTTime{0UL, 0U};
+		}
+
+		/**
+		 * Total time slept, in all modes, since energy profiling started
+		 * (or was reset) (zero if `FASTARDUINO_POWER_PROFILE` is not defined).
+		 */
+		static time::RTTTime sleep_time()
+		{
+			time::RTTTime total{0UL, 0U};
+#ifdef FASTARDUINO_POWER_PROFILE
+			for (const SleepStats& stats : modes_) total = total + stats.time;
+#endif
+			return total;
+		}
+
+		/**
+		 * Output energy profiling statistics to @p out, as tab-separated
+		 * tables: sleep count, time (ms) and share of total time (per mille),
+		 * per sleep mode (as its `board::SleepMode` value) then per wakeup source
+		 * (as its vector name, e.g. `__vector_14`); then total, sleep and active
+		 * times (ms) and duty cycle, i.e. active share of total time (per mille).
+		 * This does nothing when `FASTARDUINO_POWER_PROFILE` is not defined.
+		 * @param out the output stream
+		 */
+		template<typename OSTREAM> static void dump_profile(UNUSED OSTREAM& out)
+		{
+#ifdef FASTARDUINO_POWER_PROFILE
+			const time::RTTTime total = total_time();
+			out << F("sleep mode\tcount\tms\tpermil\n");
+			for (uint8_t index = 0; index < MAX_MODES; ++index)
+				if (modes_[index].count)
+				{
+					out << uint16_t(index << MODE_SHIFT);
+					dump_stats_(out, modes_[index], total);
+				}
+			out << F("wakeup\tcount\tms\tpermil\n");
+			for (uint8_t index = 0; index < FASTARDUINO_POWER_PROFILE_SOURCES && names_[index] != nullptr; ++index)
+			{
+				out << names_[index];
+				dump_stats_(out, sources_[index], total);
+			}
+			if (unknown_.count)
+			{
+				out << F("unknown");
+				dump_stats_(out, unknown_, total);
+			}
+			const time::RTTTime sleep = sleep_time();
+			const time::RTTTime active = total - sleep;
+			out	<< F("total ms\t") << total.millis() << F("\nsleep ms\t") << sleep.millis()
+				<< F("\nactive ms\t") << active.millis() << F("\nduty cycle permil\t")
+				<< per_mille_(active.millis(), total.millis()) << '\n';
+#endif
+		}
+
+		/// @cond notdocumented
+		// Called by all ISR (see isr_profiler.h) to record the wakeup source
+		static void wakeup_(UNUSED const flash::FlashStorage* name) INLINE
+		{
+#ifdef FASTARDUINO_POWER_PROFILE
+			if (sleeping_)
+			{
+				sleeping_ = false;
+				source_ = name;
+			}
+#endif
+		}
+		/// @endcond
+
 	private:
 		static board::SleepMode default_mode_;
+
+#ifdef FASTARDUINO_POWER_PROFILE
+		using CLOCK_PTR = time::RTTTime (*)();
+
+		template<typename CLOCK> struct ProfileClock_
+		{
+			static time::RTTTime now()
+			{
+				return now_(*clock_, 0);
+			}
+
+			template<typename C> static auto now_(const C& clock, int) -> decltype(clock.time())
+			{
+				return clock.time();
+			}
+
+			template<typename C> static time::RTTTime now_(const C& clock, long)
+			{
+				return time::RTTTime{clock.millis(), 0U};
+			}
+
+			static inline const CLOCK* clock_ = nullptr;
+		};
+
+		// All sleep modes are encoded in (at most) 3 consecutive SMx bits, from SM0
+		static constexpr uint8_t MODE_SHIFT = SM0;
+		static constexpr uint8_t MAX_MODES = 8;
+
+		static uint8_t mode_index_(board::SleepMode mode)
+		{
+			return (uint8_t(mode) >> MODE_SHIFT) & (MAX_MODES - 1);
+		}
+
+		static void account_(board::SleepMode mode, const time::RTTTime& duration)
+		{
+			SleepStats& mode_stats = modes_[mode_index_(mode)];
+			++mode_stats.count;
+			mode_stats.time = mode_stats.time + duration;
+			SleepStats* source_stats = &unknown_;
+			if (source_ != nullptr)
+				for (uint8_t index = 0; index < FASTARDUINO_POWER_PROFILE_SOURCES; ++index)
+				{
+					if (names_[index] == nullptr) names_[index] = source_;
+					if (names_[index] == source_)
+					{
+						source_stats = &sources_[index];
+						break;
+					}
+				}
+			++source_stats->count;
+			source_stats->time = source_stats->time + duration;
+		}
+
+		static uint16_t per_mille_(uint32_t part, uint32_t total)
+		{
+			// Scale both values down to avoid overflow
+			while (part > 0xFFFFFFFFUL / 1000UL)
+			{
+				part >>= 1;
+				total >>= 1;
+			}
+			return (total ? uint16_t(part * 1000UL / total) : 0U);
+		}
+
+		template<typename OSTREAM>
+		static void dump_stats_(OSTREAM& out, const SleepStats& stats, const time::RTTTime& total)
+		{
+			out	<< '\t' << stats.count << '\t' << stats.time.millis() << '\t'
+				<< per_mille_(stats.time.millis(), total.millis()) << '\n';
+		}
+
+		static CLOCK_PTR clock_;
+		static time::RTTTime start_;
+		static SleepStats modes_[MAX_MODES];
+		static SleepStats sources_[FASTARDUINO_POWER_PROFILE_SOURCES];
+		static const flash::FlashStorage* names_[FASTARDUINO_POWER_PROFILE_SOURCES];
+		static SleepStats unknown_;
+		static volatile bool sleeping_;
+		static const flash::FlashStorage* volatile source_;
+#endif
 	};
 }
 
@@ -474,12 +474,62 @@ namespace containers
 			synchronized clear_();
 		}
 
+		/**
+		 * Tell the maximum number of items ever present in this queue since its
+		 * creation or last call to `reset_stats()` (queue high-water mark).
+		 * This is always `0` when `FASTARDUINO_INSTRUMENTATION` is not defined.
+		 * @sa instrumentation.h
+		 */
+		uint8_t max_items() const
+		{
+#ifdef FASTARDUINO_INSTRUMENTATION
+			synchronized return max_items_;
+#else
+			return 0;
+#endif
+		}
+
+		/**
+		 * Tell the number of items that could not be pushed to this queue
+		 * because it was full, since its creation or last call to `reset_stats()`.
+		 * This is always `0` when `FASTARDUINO_INSTRUMENTATION` is not defined.
+		 * @sa instrumentation.h
+		 */
+		uint16_t overflows() const
+		{
+#ifdef FASTARDUINO_INSTRUMENTATION
+			synchronized return overflows_;
+#else
+			return 0;
+#endif
+		}
+
+		/**
+		 * Reset `max_items()` and `overflows()` statistics of this queue.
+		 * This does nothing when `FASTARDUINO_INSTRUMENTATION` is not defined.
+		 * @sa instrumentation.h
+		 */
+		void reset_stats()
+		{
+#ifdef FASTARDUINO_INSTRUMENTATION
+			synchronized
+			{
+				max_items_ = 0;
+				overflows_ = 0;
+			}
+#endif
+		}
+
 	private:
 		T* const buffer_;
 		const uint8_t size_;
 		bool locked_;
 		volatile uint8_t head_ = 0;
 		volatile uint8_t tail_ = 0;
+#ifdef FASTARDUINO_INSTRUMENTATION
+		uint8_t max_items_ = 0;
+		uint16_t overflows_ = 0;
+#endif
 	};
 
 	/// @cond notdocumented
@@ -526,10 +576,23 @@ namespace containers
 
 	template<typename T, typename TREF> bool Queue<T, TREF>::push_(TREF item)
 	{
+#ifdef FASTARDUINO_INSTRUMENTATION
+		if (locked_) return false;
+		if (full_())
+		{
+			++overflows_;
+			return false;
+		}
+#else
 		if (locked_ || full_()) return false;
+#endif
 		buffer_[tail_] = item;
 		++tail_;
 		if (tail_ == size_) tail_ = 0;
+#ifdef FASTARDUINO_INSTRUMENTATION
+		const uint8_t items = items_();
+		if (items > max_items_) max_items_ = items;
+#endif
 		return true;
 	}
 
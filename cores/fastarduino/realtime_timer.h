@@ -47,6 +47,30 @@
 		timer::isr_handler_rtt::rtt<TIMER_NUM>(); \
 	}
 
+/**
+ * Register the necessary ISR (Interrupt Service Routine) for @p RTT, a global
+ * timer::RTT instance, to work properly.
+ * Contrarily to `REGISTER_RTT_ISR()`, the ISR is bound to @p RTT at compile time
+ * and directly increments its milliseconds counter, at an address known at link
+ * time; it is a naked ISR which saves only the one register it uses, hence
+ * much faster than the ISR generated by `REGISTER_RTT_ISR()`.
+ * 
+ * Like all naked ISR, this ISR is neither profiled by `FASTARDUINO_ISR_PROFILE`
+ * nor recorded as wakeup source by `FASTARDUINO_POWER_PROFILE`.
+ * 
+ * @param TIMER_NUM the number of the TIMER feature for the target MCU
+ * @param RTT the global (or static) `timer::RTT` instance for @p TIMER_NUM
+ * 
+ * @sa REGISTER_RTT_ISR
+ */
+#define REGISTER_RTT_ISR_STATIC(TIMER_NUM, RTT)                             \
+	extern "C" void CAT3(TIMER, TIMER_NUM, _COMPA_vect)(void) NAKED_SIGNAL; \
+	void CAT3(TIMER, TIMER_NUM, _COMPA_vect)(void)                          \
+	{                                                                       \
+		timer::isr_handler_rtt::rtt_static<TIMER_NUM, RTT>();               \
+		reti();                                                             \
+	}
+
 /**
  * Register the necessary ISR (Interrupt Service Routine) for a timer::RTT to work
  * properly, along with a callback method that will be notified every millisecond.
@@ -201,6 +225,7 @@ namespace timer
 	 * @tparam NTIMER_ the AVR timer used by this RTT
 	 * @sa board::Timer
 	 * @sa REGISTER_RTT_ISR()
+	 * @sa REGISTER_RTT_ISR_STATIC()
 	 */
 	template<board::Timer NTIMER_> class RTT : private Timer<NTIMER_>
 	{
@@ -576,6 +601,10 @@ namespace timer
 			interrupt::HandlerHolder<RTT<NTIMER>>::handler()->on_timer();
 		}
 
+		// Called from a naked ISR: increment milliseconds_ (32 bits) in place,
+		// with only r24 (and SREG) saved and restored
+		template<uint8_t TIMER_NUM_, RTT<board::Timer(TIMER_NUM_)>& RTT_> static void rtt_static() INLINE;
+
 		template<uint8_t TIMER_NUM_, typename HANDLER_, void (HANDLER_::*CALLBACK_)(uint32_t)> static void rtt_method()
 		{
 			static constexpr board::Timer NTIMER = isr_handler::check_timer<TIMER_NUM_>();
@@ -600,6 +629,35 @@ namespace timer
 			interrupt::HandlerHolder<RTTEventCallback<EVENT_, PERIOD_>>::handler()->on_rtt_change(handler->millis());
 		}
 	};
+
+	template<uint8_t TIMER_NUM_, RTT<board::Timer(TIMER_NUM_)>& RTT_> inline void isr_handler_rtt::rtt_static()
+	{
+		isr_handler::check_timer<TIMER_NUM_>();
+#ifdef FASTARDUINO_HOST
+		RTT_.on_timer();
+#else
+		__asm__ __volatile__(
+			"push r24\n\t"
+			"in r24, __SREG__\n\t"
+			"push r24\n\t"
+			"lds r24, %0\n\t"
+			"subi r24, 0xFF\n\t"
+			"sts %0, r24\n\t"
+			"lds r24, %0+1\n\t"
+			"sbci r24, 0xFF\n\t"
+			"sts %0+1, r24\n\t"
+			"lds r24, %0+2\n\t"
+			"sbci r24, 0xFF\n\t"
+			"sts %0+2, r24\n\t"
+			"lds r24, %0+3\n\t"
+			"sbci r24, 0xFF\n\t"
+			"sts %0+3, r24\n\t"
+			"pop r24\n\t"
+			"out __SREG__, r24\n\t"
+			"pop r24\n\t"
+			:: "i"(&RTT_.milliseconds_) : "memory");
+#endif
+	}
 	/// @endcond
 }
 
@@ -199,6 +199,20 @@ namespace events
 			next_time_ = when;
 		}
 
+		/**
+		 * Statistics of execution time of this job `on_schedule()`.
+		 * This is always empty when `FASTARDUINO_INSTRUMENTATION` is not defined.
+		 * @sa instrumentation.h
+		 */
+		instrumentation::Stats stats() const
+		{
+#ifdef FASTARDUINO_INSTRUMENTATION
+			return stats_;
+#else
+			return instrumentation::Stats{};
+#endif
+		}
+
 	protected:
 		/// @cond notdocumented
 		Job(const Job&) =  default;
@@ -226,6 +240,9 @@ namespace events
 	private:
 		uint32_t next_time_;
 		uint32_t period_;
+#ifdef FASTARDUINO_INSTRUMENTATION
+		instrumentation::Stats stats_;
+#endif
 
 		template<typename CLOCK, typename T> friend class Scheduler;
 	};
@@ -236,7 +253,13 @@ namespace events
 		uint32_t now = clock_.millis();
 		if (job.next_time() <= now)
 		{
+#ifdef FASTARDUINO_INSTRUMENTATION
+			const uint16_t start = instrumentation::now_();
+			job.on_schedule(now);
+			job.stats_.add_(instrumentation::since_(start));
+#else
 			job.on_schedule(now);
+#endif
 			if (!job.is_periodic()) return true;
 			job.reschedule(now + job.period());
 		}
@@ -364,6 +364,18 @@ namespace spi
 			cs_.toggle();
 		}
 
+		/**
+		 * Start a new SPI transfer to this device, right after `end_transfer()`,
+		 * without SPI configuration. This is faster than `start_transfer()`
+		 * when several transfers to this device are chained, but it must not
+		 * be used if another SPI device has been used since last `start_transfer()`.
+		 * Concretely this sets the active level on @p CS pin.
+		 */
+		void restart_transfer() INLINE
+		{
+			cs_.toggle();
+		}
+
 	private:
 		using REG8 = board_traits::REG8;
 #ifdef SPDR
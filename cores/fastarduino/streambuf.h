@@ -25,6 +25,10 @@
 #include "interrupts.h"
 #include "queue.h"
 
+// <stdio.h> defines EOF as a macro, which would clash with istreambuf::EOF
+#pragma push_macro("EOF")
+#undef EOF
+
 /**
  * Register the necessary callbacks that will be notified when a `streams::ostreambuf`
  * is put new content (character or string). This is used by hardware and software
@@ -180,7 +184,7 @@ namespace streams
 		 */
 		void sputn(const flash::FlashStorage* str)
 		{
-			uint16_t address = (uint16_t) str;
+			uintptr_t address = (uintptr_t) str;
 			while (char value = pgm_read_byte(address++)) put_(value, false);
 			on_put();
 		}
@@ -336,5 +340,7 @@ namespace streams
 	/// @endcond 
 }
 
+#pragma pop_macro("EOF")
+
 #endif /* STREAMBUF_H */
 /// @endcond
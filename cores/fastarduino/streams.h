@@ -28,6 +28,10 @@
 #include "streambuf.h"
 #include "time.h"
 
+// <stdio.h> defines EOF as a macro, which would clash with istreambuf::EOF
+#pragma push_macro("EOF")
+#undef EOF
+
 /**
  * Defines C++-like streams API, based on circular buffers for input or output.
  * Typical usage of an output "stream":
@@ -159,7 +163,7 @@ namespace streams
 		 */
 		ostream& operator<<(const void* ptr)
 		{
-			convert(streambuf_, uint16_t(ptr));
+			convert(streambuf_, uintptr_t(ptr));
 			after_insertion();
 			return *this;
 		}
@@ -729,5 +733,7 @@ namespace streams
 	}
 }
 
+#pragma pop_macro("EOF")
+
 #endif /* STREAMS_HH */
 /// @endcond
@@ -246,8 +246,8 @@ namespace time
 	{
 		if (a <= b) return RTTTime{0, 0};
 		uint32_t millis = a.millis() - b.millis();
-		if (a.micros() >= b.micros()) return RTTTime{millis, a.micros() - b.micros()};
-		return RTTTime{millis - 1, ONE_MILLI_16 + a.micros() - b.micros()};
+		if (a.micros() >= b.micros()) return RTTTime{millis, uint16_t(a.micros() - b.micros())};
+		return RTTTime{millis - 1, uint16_t(ONE_MILLI_16 + a.micros() - b.micros())};
 	}
 
 	/**
@@ -69,7 +69,7 @@
 	void CAT3(TIMER, TIMER_NUM, _COMPA_vect)(void)                              \
 	{                                                                           \
 		timer::isr_handler::check_timer<TIMER_NUM>();                           \
-		__asm__ __volatile__("reti" ::);                                        \
+		reti();                                                                \
 	}
 
 /**
@@ -112,7 +112,7 @@
 	void CAT3(TIMER, TIMER_NUM, _OVF_vect)(void)                            \
 	{                                                                       \
 		timer::isr_handler::check_timer<TIMER_NUM>();                       \
-		__asm__ __volatile__("reti" ::);                                    \
+		reti();                                                            \
 	}
 
 /**
@@ -153,7 +153,7 @@
 	void CAT3(TIMER, TIMER_NUM, _CAPT_vect)(void)                           \
 	{                                                                       \
 		timer::isr_handler::check_timer_capture<TIMER_NUM>();               \
-		__asm__ __volatile__("reti" ::);                                    \
+		reti();                                                            \
 	}
 
 /**
@@ -0,0 +1,225 @@
+//   Copyright 2016-2023 Jean-Francois Poilpret
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+/// @cond api
+
+/**
+ * @file
+ * Binary trace log with deferred formatting: format strings never get to the
+ * MCU, they are decoded on the host by `make/trace-decode.py`.
+ *
+ * Each `TRACE()` site stores its printf-like format string in a special ELF
+ * section (`.fastarduino.trace`) that is not loaded to flash, and gets a
+ * 16-bit ID, calculated at compile time as a hash of the format string.
+ * At runtime, only a small binary record is pushed to an output buffer
+ * (typically the buffer of a `serial::hard::UATX`):
+ *
+ *     0xA5 | ID (2 bytes) | timestamp (2 bytes) | arguments raw bytes
+ *
+ * The timestamp is the current counter of a free-running timer,
+ * `board::Timer::TIMER1` by default; this can be changed by defining
+ * `FASTARDUINO_TRACE_TIMER`, e.g. `-DFASTARDUINO_TRACE_TIMER=board::Timer::TIMER3`.
+ *
+ * Arguments are promoted as for printf (e.g. `uint8_t` is pushed as an `int`,
+ * `float` as a `double`), hence format specifiers must match arguments
+ * exactly as for printf; `%s` is not supported.
+ *
+ * @code
+ * REGISTER_UATX_ISR(0)
+ * REGISTER_OSTREAMBUF_LISTENERS(serial::hard::UATX<board::USART::USART0>)
+ * ...
+ * static char output_buffer[64];
+ * serial::hard::UATX<board::USART::USART0> uatx{output_buffer};
+ * uatx.begin(115200);
+ * trace::Tracer::begin(uatx.out().rdbuf());
+ * ...
+ * TRACE("speed=%u dir=%d", speed, direction);
+ * @endcode
+ *
+ * On the host, traces read from serial are decoded with:
+ *
+ *     make/trace-decode.py dist/UNO-16MHz/myapp /dev/ttyACM0
+ */
+#ifndef TRACE_HH
+#define TRACE_HH
+
+#include "boards/board_traits.h"
+#include "streambuf.h"
+#include "utilities.h"
+
+#ifndef FASTARDUINO_TRACE_TIMER
+/**
+ * The timer used by `trace::Tracer` to timestamp trace records.
+ */
+#define FASTARDUINO_TRACE_TIMER board::Timer::TIMER1
+#endif
+
+/**
+ * Push a trace record with format string @p FORMAT (a single string literal)
+ * and arguments `__VA_ARGS__` to the current `trace::Tracer` output.
+ * @p FORMAT never gets to flash, it is only kept in the ELF file for
+ * `make/trace-decode.py`.
+ * If there is not enough room in the output buffer for the whole record,
+ * the record is dropped.
+ * @sa trace::Tracer
+ */
+#define TRACE(FORMAT, ...)                                                                     \
+	do                                                                                         \
+	{                                                                                          \
+		__asm__ __volatile__(                                                                  \
+			".pushsection .fastarduino.trace,\"\",@progbits\n\t.asciz " #FORMAT "\n\t.popsection"); \
+		constexpr const uint16_t trace_id_ = trace::hash(FORMAT);                              \
+		trace::Tracer::trace(trace_id_, ##__VA_ARGS__);                                        \
+	} while (false)
+
+/**
+ * Defines API for binary tracing with deferred formatting.
+ * @sa TRACE()
+ */
+namespace trace
+{
+	/**
+	 * The hash function used to calculate trace IDs from format strings
+	 * (FNV-1a, 32 bits, folded to 16 bits).
+	 * This is used at compile-time by `TRACE()`.
+	 */
+	constexpr uint16_t hash(const char* format)
+	{
+		uint32_t hash = 2166136261UL;
+		while (*format)
+			hash = (hash ^ uint8_t(*format++)) * 16777619UL;
+		return uint16_t(hash ^ (hash >> 16));
+	}
+
+	/**
+	 * API to start and stop tracing, used by all `TRACE()` sites.
+	 */
+	class Tracer
+	{
+	private:
+		using TRAIT = board_traits::Timer_trait<FASTARDUINO_TRACE_TIMER>;
+
+	public:
+		/** The type of prescaler of the trace timer. */
+		using PRESCALER = typename TRAIT::TIMER_PRESCALER;
+
+		/** The first byte of every trace record. */
+		static constexpr const uint8_t SYNC = 0xA5;
+
+		Tracer() = delete;
+
+		/**
+		 * Start tracing to @p output, and start the trace timer in normal mode
+		 * with @p prescaler.
+		 * @param output the output buffer (e.g. from `serial::hard::UATX`)
+		 * to which all trace records will be pushed; it should not be used for
+		 * anything else.
+		 * @param prescaler the prescaler value for the trace timer
+		 * @param start_timer if `false`, the trace timer is not started by this
+		 * method, e.g. because it is already running in normal mode for other
+		 * purposes
+		 */
+		static void begin(streams::ostreambuf& output, PRESCALER prescaler = PRESCALER::NO_PRESCALING,
+			bool start_timer = true)
+		{
+			synchronized
+			{
+				if (start_timer)
+				{
+					if (!TRAIT::TCCRA.is_no_reg()) TRAIT::TCCRA = 0;
+					TRAIT::TCCRB = TRAIT::TCCRB_prescaler(prescaler);
+					TRAIT::TCNT = 0;
+				}
+				dropped_ = 0;
+				output_ = &output;
+			}
+		}
+
+		/**
+		 * Stop tracing; all subsequent `TRACE()` do nothing.
+		 */
+		static void end()
+		{
+			synchronized output_ = nullptr;
+		}
+
+		/**
+		 * Number of trace records that were dropped since `begin()`, because
+		 * output buffer was full.
+		 */
+		static uint16_t dropped()
+		{
+			synchronized return dropped_;
+		}
+
+		/// @cond notdocumented
+		template<typename... ARGS> static void trace(uint16_t id, ARGS... args)
+		{
+			constexpr uint8_t SIZE = HEADER_SIZE + (0 + ... + sizeof(promote_(args)));
+			uint8_t record[SIZE];
+			record[0] = SYNC;
+			record[1] = uint8_t(id);
+			record[2] = uint8_t(id >> 8);
+			if constexpr (sizeof...(ARGS) > 0)
+			{
+				uint8_t* next = &record[HEADER_SIZE];
+				(append_(next, promote_(args)), ...);
+			}
+			synchronized
+			{
+				if (output_ == nullptr) return;
+				if (output_->queue().free_() < SIZE)
+				{
+					++dropped_;
+					return;
+				}
+				const uint16_t timestamp = TRAIT::TCNT;
+				record[3] = uint8_t(timestamp);
+				record[4] = uint8_t(timestamp >> 8);
+				output_->sputn((const char*) record, SIZE);
+			}
+		}
+		/// @endcond
+
+	private:
+		static constexpr const uint8_t HEADER_SIZE = 5;
+
+		// Promote arguments as for variadic functions (printf)
+		template<typename T> static auto promote_(T value)
+		{
+			return +value;
+		}
+		static double promote_(float value)
+		{
+			return value;
+		}
+		static double promote_(double value)
+		{
+			return value;
+		}
+
+		template<typename T> static void append_(uint8_t*& next, T value)
+		{
+			const uint8_t* source = (const uint8_t*) &value;
+			for (uint8_t i = 0; i < sizeof(T); ++i)
+				*next++ = *source++;
+		}
+
+		static inline streams::ostreambuf* output_ = nullptr;
+		static inline uint16_t dropped_ = 0;
+	};
+}
+
+#endif /* TRACE_HH */
+/// @endcond
@@ -67,6 +67,56 @@
 		serial::hard::isr_handler::uart_rx<UART_NUM>(); \
 	}
 
+/**
+ * Register the necessary ISR (Interrupt Service Routine) for @p UATX, a global
+ * serial::hard::UATX instance, to work correctly.
+ * Contrarily to `REGISTER_UATX_ISR()`, the ISR is bound to @p UATX at compile
+ * time and directly uses its address, known at link time, instead of loading
+ * the registered handler pointer.
+ * @param UART_NUM the number of the USART feature for the target MCU
+ * @param UATX the global (or static) `serial::hard::UATX` instance for @p UART_NUM
+ */
+#define REGISTER_UATX_ISR_STATIC(UART_NUM, UATX)                  \
+	ISR(CAT3(USART, UART_NUM, _UDRE_vect))                        \
+	{                                                             \
+		serial::hard::isr_handler::uatx_static<UART_NUM, UATX>(); \
+	}
+
+/**
+ * Register the necessary ISR (Interrupt Service Routine) for @p UARX, a global
+ * serial::hard::UARX instance, to work correctly.
+ * Contrarily to `REGISTER_UARX_ISR()`, the ISR is bound to @p UARX at compile
+ * time and directly uses its address, known at link time, instead of loading
+ * the registered handler pointer.
+ * @param UART_NUM the number of the USART feature for the target MCU
+ * @param UARX the global (or static) `serial::hard::UARX` instance for @p UART_NUM
+ */
+#define REGISTER_UARX_ISR_STATIC(UART_NUM, UARX)                  \
+	ISR(CAT3(USART, UART_NUM, _RX_vect))                          \
+	{                                                             \
+		serial::hard::isr_handler::uarx_static<UART_NUM, UARX>(); \
+	}
+
+/**
+ * Register the necessary ISR (Interrupt Service Routine) for @p UART, a global
+ * serial::hard::UART instance, to work correctly.
+ * Contrarily to `REGISTER_UART_ISR()`, the ISR are bound to @p UART at compile
+ * time and directly use its address, known at link time, instead of loading
+ * the registered handler pointer.
+ * @param UART_NUM the number of the USART feature for the target MCU
+ * @param UART the global (or static) `serial::hard::UART` instance for @p UART_NUM
+ */
+#define REGISTER_UART_ISR_STATIC(UART_NUM, UART)                     \
+	ISR(CAT3(USART, UART_NUM, _UDRE_vect))                           \
+	{                                                                \
+		serial::hard::isr_handler::uart_tx_static<UART_NUM, UART>(); \
+	}                                                                \
+                                                                     \
+	ISR(CAT3(USART, UART_NUM, _RX_vect))                             \
+	{                                                                \
+		serial::hard::isr_handler::uart_rx_static<UART_NUM, UART>(); \
+	}
+
 namespace serial
 {
 	/**
@@ -229,7 +279,7 @@ namespace serial::hard
 	/**
 	 * Hardware serial transmitter API.
 	 * For this API to be fully functional, you must register the right ISR in your
-	 * program, through `REGISTER_UATX_ISR()`.
+	 * program, through `REGISTER_UATX_ISR()` (or `REGISTER_UATX_ISR_STATIC()`).
 	 * You must also register this class as a `streams::ostreambuf` callback listener
 	 * through `REGISTER_OSTREAMBUF_LISTENERS()`.
 	 * 
@@ -343,7 +393,7 @@ namespace serial::hard
 	/**
 	 * Hardware serial receiver API.
 	 * For this API to be fully functional, you must register the right ISR in your
-	 * program, through `REGISTER_UARX_ISR()`.
+	 * program, through `REGISTER_UARX_ISR()` (or `REGISTER_UARX_ISR_STATIC()`).
 	 * 
 	 * @tparam USART_ the hardware `board::USART` to use
 	 * @sa REGISTER_UARX_ISR()
@@ -408,7 +458,7 @@ namespace serial::hard
 	/**
 	 * Hardware serial receiver/transceiver API.
 	 * For this API to be fully functional, you must register the right ISR in your
-	 * program, through `REGISTER_UART_ISR()`.
+	 * program, through `REGISTER_UART_ISR()` (or `REGISTER_UART_ISR_STATIC()`).
 	 * You must also register this class as a `streams::ostreambuf` callback listener
 	 * through `REGISTER_OSTREAMBUF_LISTENERS()`.
 	 * 
@@ -530,6 +580,30 @@ namespace serial::hard
 			static constexpr board::USART USART = check_uart<UART_NUM_>();
 			interrupt::HandlerHolder<UART<USART>>::handler()->data_receive_complete();
 		}
+
+		template<uint8_t UART_NUM_, UATX<board::USART(UART_NUM_)>& UATX_> static void uatx_static()
+		{
+			check_uart<UART_NUM_>();
+			UATX_.data_register_empty();
+		}
+
+		template<uint8_t UART_NUM_, UARX<board::USART(UART_NUM_)>& UARX_> static void uarx_static()
+		{
+			check_uart<UART_NUM_>();
+			UARX_.data_receive_complete();
+		}
+
+		template<uint8_t UART_NUM_, UART<board::USART(UART_NUM_)>& UART_> static void uart_tx_static()
+		{
+			check_uart<UART_NUM_>();
+			UART_.data_register_empty();
+		}
+
+		template<uint8_t UART_NUM_, UART<board::USART(UART_NUM_)>& UART_> static void uart_rx_static()
+		{
+			check_uart<UART_NUM_>();
+			UART_.data_receive_complete();
+		}
 	};
 	/// @endcond
 }
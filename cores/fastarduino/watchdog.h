@@ -24,6 +24,7 @@
 #include "boards/board.h"
 #include "boards/board_traits.h"
 #include <avr/interrupt.h>
+#include <avr/wdt.h>
 #include "interrupts.h"
 #include "events.h"
 
@@ -179,7 +180,7 @@ namespace watchdog
 		/// @cond notdocumented
 		void begin_with_config(uint8_t config) INLINE
 		{
-			__asm__ __volatile__("wdr");
+			wdt_reset();
 			MCUSR_ |= 1 << WDRF;
 			WDTCSR_ = bits::BV8(WDCE, WDE);
 			WDTCSR_ = config;
@@ -0,0 +1,26 @@
+//   Copyright 2016-2023 Jean-Francois Poilpret
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+// Host replacement of avr-libc <avr/eeprom.h>, used only by host-native
+// builds (CONF=HOST): EEMEM variables are simply located in host memory.
+// Note that FastArduino eeprom::EEPROM accesses EEPROM through simulated
+// registers, hence EEPROM content must be simulated by register hooks.
+#ifndef HOST_AVR_EEPROM_H
+#define HOST_AVR_EEPROM_H
+
+#include <avr/io.h>
+
+#define EEMEM
+
+#endif /* HOST_AVR_EEPROM_H */
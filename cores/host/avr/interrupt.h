@@ -0,0 +1,40 @@
+//   Copyright 2016-2023 Jean-Francois Poilpret
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+// Host replacement of avr-libc <avr/interrupt.h>, used only by host-native
+// builds (CONF=HOST). ISRs become plain extern "C" functions that can be
+// called directly to simulate interrupts; sei() and cli() only update the
+// I bit of simulated SREG.
+#ifndef HOST_AVR_INTERRUPT_H
+#define HOST_AVR_INTERRUPT_H
+
+#include <avr/io.h>
+
+#define sei() (host::registers[host::SREG_ADDRESS] |= host::SREG_I_BIT)
+#define cli() (host::registers[host::SREG_ADDRESS] &= uint8_t(~host::SREG_I_BIT))
+#define reti() return
+
+#define __INTR_ATTRS used
+#define ISR_BLOCK
+#define ISR_NOBLOCK
+#define ISR_NAKED
+#define ISR_FLATTEN
+#define ISR_ALIASOF(vector)
+#define ISR(vector, ...) extern "C" void vector(void) __attribute__((__INTR_ATTRS)); void vector(void)
+#define SIGNAL(vector) ISR(vector)
+#define EMPTY_INTERRUPT(vector) extern "C" void vector(void) __attribute__((__INTR_ATTRS)); void vector(void) {}
+#define ISR_ALIAS(vector, target) extern "C" void vector(void) {target();}
+#define BADISR_vect __vector_default
+
+#endif /* HOST_AVR_INTERRUPT_H */
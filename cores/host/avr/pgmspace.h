@@ -0,0 +1,36 @@
+//   Copyright 2016-2023 Jean-Francois Poilpret
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+// Host replacement of avr-libc <avr/pgmspace.h>, used only by host-native
+// builds (CONF=HOST): flash data is simply located in host memory.
+#ifndef HOST_AVR_PGMSPACE_H
+#define HOST_AVR_PGMSPACE_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+#define PGM_P const char*
+#define PSTR(s) (s)
+#define pgm_read_byte(address) (*((const uint8_t*) (address)))
+#define pgm_read_word(address) (*((const uint16_t*) (address)))
+#define pgm_read_dword(address) (*((const uint32_t*) (address)))
+#define pgm_read_float(address) (*((const float*) (address)))
+#define pgm_read_ptr(address) (*((void* const*) (address)))
+#define memcpy_P memcpy
+#define strcpy_P strcpy
+#define strlen_P strlen
+#define strcmp_P strcmp
+
+#endif /* HOST_AVR_PGMSPACE_H */
@@ -0,0 +1,36 @@
+//   Copyright 2016-2023 Jean-Francois Poilpret
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+// Host replacement of avr-libc <avr/sleep.h>, used only by host-native
+// builds (CONF=HOST): sleeping does nothing.
+#ifndef HOST_AVR_SLEEP_H
+#define HOST_AVR_SLEEP_H
+
+#include <avr/io.h>
+
+#define SLEEP_MODE_IDLE (0x00 << 1)
+#define SLEEP_MODE_ADC (0x01 << 1)
+#define SLEEP_MODE_PWR_DOWN (0x02 << 1)
+#define SLEEP_MODE_PWR_SAVE (0x03 << 1)
+#define SLEEP_MODE_STANDBY (0x06 << 1)
+#define SLEEP_MODE_EXT_STANDBY (0x07 << 1)
+
+#define set_sleep_mode(mode) ((void) (mode))
+#define sleep_enable()
+#define sleep_disable()
+#define sleep_cpu()
+#define sleep_mode()
+#define sleep_bod_disable()
+
+#endif /* HOST_AVR_SLEEP_H */
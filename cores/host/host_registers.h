@@ -0,0 +1,122 @@
+//   Copyright 2016-2023 Jean-Francois Poilpret
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+/// @cond api
+
+/**
+ * @file
+ * Simulated AVR registers, used only by host-native builds (`CONF=HOST`).
+ *
+ * In a host build, all `board_traits::REGISTER` accesses are redirected to an
+ * in-memory register file, `host::registers`, indexed by the AVR data space
+ * address of each register; this allows compiling and running FastArduino
+ * code (containers, streams, futures, events...) on a development machine,
+ * e.g. for unit tests or micro-benchmarks.
+ *
+ * Simulated hardware can be plugged by registering hooks on register
+ * addresses: a read hook is called before every read of a register through
+ * `board_traits::REGISTER` (e.g. to set a status flag that some code is
+ * waiting for), a write hook is called after every write.
+ *
+ * @code
+ * // Simulate an always ready UART
+ * host::set_read_hook(R_(UCSR0A), [](uint16_t address) {host::registers[address] |= _BV(UDRE0);});
+ * @endcode
+ */
+#ifndef HOST_REGISTERS_HH
+#define HOST_REGISTERS_HH
+
+#include <stdint.h>
+
+namespace host
+{
+	/** Size of the simulated register file (covers I/O and extended I/O). */
+	static constexpr const uint16_t REGISTERS_SIZE = 0x200;
+
+	/** Address of SREG in the simulated register file. */
+	static constexpr const uint16_t SREG_ADDRESS = 0x5F;
+
+	/** Bit of global interrupts enable in SREG. */
+	static constexpr const uint8_t SREG_I_BIT = 0x80;
+
+	/**
+	 * The type of hooks called on register accesses.
+	 * @param address the address of the accessed register (the address of its
+	 * low byte for a 16-bits register)
+	 */
+	using HOOK = void (*)(uint16_t address);
+
+	/** The simulated register file. */
+	inline volatile uint8_t registers[REGISTERS_SIZE];
+
+	/// @cond notdocumented
+	inline HOOK read_hooks[REGISTERS_SIZE];
+	inline HOOK write_hooks[REGISTERS_SIZE];
+	/// @endcond
+
+	/**
+	 * Register @p hook to be called before every read of register at @p address.
+	 * @param address the register address
+	 * @param hook the hook to call, or `nullptr` to remove current hook
+	 */
+	inline void set_read_hook(uint16_t address, HOOK hook)
+	{
+		read_hooks[address] = hook;
+	}
+
+	/**
+	 * Register @p hook to be called after every write of register at @p address.
+	 * @param address the register address
+	 * @param hook the hook to call, or `nullptr` to remove current hook
+	 */
+	inline void set_write_hook(uint16_t address, HOOK hook)
+	{
+		write_hooks[address] = hook;
+	}
+
+	/**
+	 * Reset all simulated registers to `0` and remove all hooks.
+	 */
+	inline void reset()
+	{
+		for (uint16_t i = 0; i < REGISTERS_SIZE; ++i)
+		{
+			registers[i] = 0;
+			read_hooks[i] = nullptr;
+			write_hooks[i] = nullptr;
+		}
+	}
+
+	/// @cond notdocumented
+	template<typename T> inline volatile T& reference(uint16_t address)
+	{
+		return *((volatile T*) &registers[address]);
+	}
+
+	inline void on_read(uint16_t address)
+	{
+		HOOK hook = read_hooks[address];
+		if (hook) hook(address);
+	}
+
+	inline void on_write(uint16_t address)
+	{
+		HOOK hook = write_hooks[address];
+		if (hook) hook(address);
+	}
+	/// @endcond
+}
+
+#endif /* HOST_REGISTERS_HH */
+/// @endcond
@@ -0,0 +1,101 @@
+//   Copyright 2016-2023 Jean-Francois Poilpret
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+// Host wrapper of <stdlib.h>, used only by host-native builds (CONF=HOST):
+// it adds avr-libc non-standard conversion functions used by FastArduino.
+#include_next <stdlib.h>
+
+#if defined(__cplusplus) && !defined(HOST_STDLIB_H)
+#define HOST_STDLIB_H
+
+#include_next <stdio.h>
+
+#define DTOSTR_ALWAYS_SIGN 0x01
+#define DTOSTR_PLUS_SIGN 0x02
+#define DTOSTR_UPPERCASE 0x04
+
+/// @cond notdocumented
+namespace host
+{
+	template<typename T> inline char* unsigned_to_string(T value, char* str, int radix)
+	{
+		char* p = str;
+		do
+		{
+			const unsigned digit = unsigned(value % T(radix));
+			*p++ = char(digit < 10 ? '0' + digit : 'a' + digit - 10);
+			value /= T(radix);
+		}
+		while (value);
+		*p = 0;
+		// Reverse digits
+		for (char* q = str; q < --p; ++q)
+		{
+			const char c = *q;
+			*q = *p;
+			*p = c;
+		}
+		return str;
+	}
+
+	template<typename T, typename U> inline char* signed_to_string(T value, char* str, int radix)
+	{
+		if (value < 0 && radix == 10)
+		{
+			*str = '-';
+			unsigned_to_string(U(-(value + 1)) + 1U, str + 1, radix);
+			return str;
+		}
+		return unsigned_to_string(U(value), str, radix);
+	}
+}
+/// @endcond
+
+inline char* itoa(int value, char* str, int radix)
+{
+	return host::signed_to_string<int16_t, uint16_t>(int16_t(value), str, radix);
+}
+
+inline char* utoa(unsigned value, char* str, int radix)
+{
+	return host::unsigned_to_string(uint16_t(value), str, radix);
+}
+
+inline char* ltoa(long value, char* str, int radix)
+{
+	return host::signed_to_string<int32_t, uint32_t>(int32_t(value), str, radix);
+}
+
+inline char* ultoa(unsigned long value, char* str, int radix)
+{
+	return host::unsigned_to_string(uint32_t(value), str, radix);
+}
+
+inline char* dtostrf(double value, signed char width, unsigned char precision, char* str)
+{
+	sprintf(str, "%*.*f", width, precision, value);
+	return str;
+}
+
+inline char* dtostre(double value, char* str, unsigned char precision, unsigned char flags)
+{
+	const char* format = (flags & DTOSTR_UPPERCASE)
+		? ((flags & DTOSTR_PLUS_SIGN) ? "%+.*E" : (flags & DTOSTR_ALWAYS_SIGN) ? "% .*E" : "%.*E")
+		: ((flags & DTOSTR_PLUS_SIGN) ? "%+.*e" : (flags & DTOSTR_ALWAYS_SIGN) ? "% .*e" : "%.*e");
+	// avr-libc limits precision to 7
+	sprintf(str, format, (precision > 7 ? 7 : precision), value);
+	return str;
+}
+
+#endif /* HOST_STDLIB_H */
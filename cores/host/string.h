@@ -0,0 +1,29 @@
+//   Copyright 2016-2023 Jean-Francois Poilpret
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+// Host wrapper of <string.h>, used only by host-native builds (CONF=HOST):
+// it adds avr-libc non-standard functions used by FastArduino.
+#include_next <string.h>
+
+#if defined(__cplusplus) && !defined(HOST_STRING_H)
+#define HOST_STRING_H
+
+inline char* strupr(char* str)
+{
+	for (char* p = str; *p; ++p)
+		if (*p >= 'a' && *p <= 'z') *p = char(*p - 'a' + 'A');
+	return str;
+}
+
+#endif /* HOST_STRING_H */
@@ -0,0 +1,44 @@
+//   Copyright 2016-2023 Jean-Francois Poilpret
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+// Host replacement of avr-libc <util/atomic.h>, used only by host-native
+// builds (CONF=HOST): atomic blocks save, clear and restore the I bit of
+// simulated SREG, exactly as on AVR.
+#ifndef HOST_UTIL_ATOMIC_H
+#define HOST_UTIL_ATOMIC_H
+
+#include <avr/interrupt.h>
+
+static inline uint8_t __iCliRetVal(void)
+{
+	cli();
+	return 1;
+}
+
+static inline void __iRestore(const uint8_t* sreg)
+{
+	host::registers[host::SREG_ADDRESS] = *sreg;
+}
+
+static inline void __iSeiParam(const uint8_t* unused __attribute__((unused)))
+{
+	sei();
+}
+
+#define ATOMIC_RESTORESTATE \
+	uint8_t sreg_save __attribute__((__cleanup__(__iRestore))) = host::registers[host::SREG_ADDRESS]
+#define ATOMIC_FORCEON uint8_t sreg_save __attribute__((__cleanup__(__iSeiParam))) = 0
+#define ATOMIC_BLOCK(type) for (type, __ToDo = __iCliRetVal(); __ToDo; __ToDo = 0)
+
+#endif /* HOST_UTIL_ATOMIC_H */
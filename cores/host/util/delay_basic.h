@@ -0,0 +1,25 @@
+//   Copyright 2016-2023 Jean-Francois Poilpret
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+// Host replacement of avr-libc <util/delay_basic.h>, used only by host-native
+// builds (CONF=HOST): busy loops do not wait at all.
+#ifndef HOST_UTIL_DELAY_BASIC_H
+#define HOST_UTIL_DELAY_BASIC_H
+
+#include <stdint.h>
+
+static inline void _delay_loop_1(uint8_t count __attribute__((unused))) {}
+static inline void _delay_loop_2(uint16_t count __attribute__((unused))) {}
+
+#endif /* HOST_UTIL_DELAY_BASIC_H */
@@ -0,0 +1,215 @@
+//   Copyright 2016-2023 Jean-Francois Poilpret
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+/*
+ * Special check of MCP23017 registers shadow (i2c::CachedI2CDevice), for
+ * host-native builds (CONF=HOST): the MCP23017 chip is simulated on the
+ * simulated TWI registers, and I2C transactions are counted.
+ * Both synchronous and asynchronous I2C managers are checked; for the latter,
+ * TWI interrupts are simulated by calling TWI ISR from main().
+ * This program is not aimed for upload, just build and run on host:
+ * it prints results with printf() and returns non zero on failure.
+ */
+
+#include <stdio.h>
+#include <fastarduino/future.h>
+#include <fastarduino/i2c_handler.h>
+#include <fastarduino/devices/mcp23017.h>
+#include <host_registers.h>
+
+#if !defined(FASTARDUINO_HOST)
+#error "Current target is not yet supported!"
+#endif
+
+using MANAGER = i2c::I2CSyncManager<i2c::I2CMode::FAST>;
+using MCP = devices::mcp230xx::MCP23017<MANAGER>;
+using ASYNC_MANAGER = i2c::I2CAsyncManager<i2c::I2CMode::FAST>;
+using ASYNC_MCP = devices::mcp230xx::MCP23017<ASYNC_MANAGER>;
+
+REGISTER_I2C_ISR(ASYNC_MANAGER)
+REGISTER_FUTURE_NO_LISTENERS()
+
+static constexpr const uint8_t I2C_BUFFER_SIZE = 32;
+static ASYNC_MANAGER::I2CCOMMAND i2c_buffer[I2C_BUFFER_SIZE];
+using devices::mcp230xx::MCP23017Port;
+using i2c::Status;
+
+// Simulated MCP23017 chip at address 0x20
+namespace chip
+{
+	static constexpr const uint8_t ADDRESS = 0x20;
+
+	static uint8_t registers[0x16];
+	static uint16_t transactions = 0;
+	// When true, chip does not acknowledge data bytes written to it
+	static bool nack = false;
+	// Set whenever TWI interrupt would be triggered
+	static bool interrupt = false;
+
+	// Simulated TWI registers
+	static volatile uint8_t& twsr = host::registers[R_(TWSR)];
+	static volatile uint8_t& twdr = host::registers[R_(TWDR)];
+	static volatile uint8_t& twcr = host::registers[R_(TWCR)];
+
+	static bool address_next = false;
+	static bool first_byte = false;
+	static uint8_t pointer = 0;
+
+	static void set_status(Status status)
+	{
+		twsr = uint8_t(status);
+		interrupt = true;
+	}
+
+	// Called after every write of TWCR by I2C handler
+	static void on_twcr(uint16_t address UNUSED)
+	{
+		const uint8_t command = twcr;
+		if (!(command & _BV(TWINT))) return;
+		if (command & _BV(TWSTO)) return;
+		if (command & _BV(TWSTA))
+		{
+			address_next = true;
+			set_status(Status::START_TRANSMITTED);
+			return;
+		}
+		const uint8_t data = twdr;
+		if (address_next)
+		{
+			address_next = false;
+			const bool read = data & 0x01U;
+			if ((data >> 1) != ADDRESS)
+				set_status(read ? Status::SLA_R_TRANSMITTED_NACK : Status::SLA_W_TRANSMITTED_NACK);
+			else if (read)
+				set_status(Status::SLA_R_TRANSMITTED_ACK);
+			else
+			{
+				++transactions;
+				first_byte = true;
+				set_status(Status::SLA_W_TRANSMITTED_ACK);
+			}
+		}
+		else if (twsr == uint8_t(Status::SLA_R_TRANSMITTED_ACK) || twsr == uint8_t(Status::DATA_RECEIVED_ACK))
+		{
+			twdr = registers[pointer++];
+			set_status((command & _BV(TWEA)) ? Status::DATA_RECEIVED_ACK : Status::DATA_RECEIVED_NACK);
+		}
+		else if (nack)
+			set_status(Status::DATA_TRANSMITTED_NACK);
+		else
+		{
+			if (first_byte)
+				pointer = data;
+			else
+				registers[pointer++] = data;
+			first_byte = false;
+			set_status(Status::DATA_TRANSMITTED_ACK);
+		}
+	}
+}
+
+// Execute TWI ISR until asynchronous I2C transaction is finished
+template<typename F> static future::FutureStatus complete(F& future)
+{
+	while (chip::interrupt)
+	{
+		chip::interrupt = false;
+		TWI_vect();
+	}
+	return future.status();
+}
+
+static int check(const char* name, bool ok)
+{
+	printf("%s: %s (%u transactions)\n", name, ok ? "OK" : "FAILED", chip::transactions);
+	chip::transactions = 0;
+	return ok ? 0 : 1;
+}
+
+int main()
+{
+	host::set_write_hook(R_(TWCR), chip::on_twcr);
+
+	MANAGER manager;
+	manager.begin();
+	MCP mcp{manager, 0x00};
+	int errors = 0;
+
+	mcp.begin();
+	errors += check("begin", chip::transactions == 1);
+	mcp.begin();
+	errors += check("begin again", chip::transactions == 0);
+
+	// IODIR and IPOL are consecutive, hence written at once
+	mcp.configure_gpio<MCP23017Port::PORT_AB>(0xFF00, 0x0F00, 0x0100);
+	errors += check("configure GPIO", chip::transactions == 2
+		&& chip::registers[0x00] == 0x00 && chip::registers[0x01] == 0xFF
+		&& chip::registers[0x03] == 0x01 && chip::registers[0x0D] == 0x0F);
+	mcp.configure_gpio<MCP23017Port::PORT_AB>(0xFF00, 0x0F00, 0x0100);
+	errors += check("configure GPIO again", chip::transactions == 0);
+	mcp.configure_gpio<MCP23017Port::PORT_AB>(0xFF00, 0xFF00, 0x0100);
+	errors += check("change GPIO pullups", chip::transactions == 1 && chip::registers[0x0D] == 0xFF);
+
+	mcp.values<MCP23017Port::PORT_A>(0x55);
+	mcp.values<MCP23017Port::PORT_A>(0x55);
+	errors += check("set values", chip::transactions == 1 && chip::registers[0x14] == 0x55);
+
+	// Failed writes must not update registers shadow
+	chip::nack = true;
+	const bool result = mcp.values<MCP23017Port::PORT_A>(0xAA);
+	chip::nack = false;
+	chip::transactions = 0;
+	mcp.values<MCP23017Port::PORT_A>(0x55);
+	errors += check("set values after failure", !result && chip::transactions == 1);
+
+	chip::nack = true;
+	MCP::SetValuesFuture<MCP23017Port::PORT_A> future{0xAA};
+	mcp.values<MCP23017Port::PORT_A>(future);
+	const future::FutureStatus status = future.await();
+	chip::nack = false;
+	chip::transactions = 0;
+	mcp.values<MCP23017Port::PORT_A>(0xAA);
+	errors += check("set values after future failure",
+		status == future::FutureStatus::ERROR && chip::transactions == 1 && chip::registers[0x14] == 0xAA);
+	manager.end();
+	chip::interrupt = false;
+
+	// Asynchronous I2C manager: errors are reported after the transaction is launched
+	ASYNC_MANAGER async_manager{i2c_buffer};
+	async_manager.begin();
+	ASYNC_MCP async_mcp{async_manager, 0x00};
+	ASYNC_MCP::SetValuesFuture<MCP23017Port::PORT_B> future1{0x11};
+	async_mcp.values<MCP23017Port::PORT_B>(future1);
+	const future::FutureStatus status1 = complete(future1);
+	ASYNC_MCP::SetValuesFuture<MCP23017Port::PORT_B> future2{0x11};
+	async_mcp.values<MCP23017Port::PORT_B>(future2);
+	const future::FutureStatus status2 = complete(future2);
+	errors += check("async set values", status1 == future::FutureStatus::READY
+		&& status2 == future::FutureStatus::READY && chip::transactions == 1 && chip::registers[0x15] == 0x11);
+
+	chip::nack = true;
+	ASYNC_MCP::SetValuesFuture<MCP23017Port::PORT_B> future3{0x22};
+	async_mcp.values<MCP23017Port::PORT_B>(future3);
+	const future::FutureStatus status3 = complete(future3);
+	chip::nack = false;
+	chip::transactions = 0;
+	ASYNC_MCP::SetValuesFuture<MCP23017Port::PORT_B> future4{0x22};
+	async_mcp.values<MCP23017Port::PORT_B>(future4);
+	const future::FutureStatus status4 = complete(future4);
+	errors += check("async set values after failure", status3 == future::FutureStatus::ERROR
+		&& status4 == future::FutureStatus::READY && chip::transactions == 1 && chip::registers[0x15] == 0x22);
+
+	printf("%s\n", errors ? "FAILED" : "OK");
+	return errors;
+}
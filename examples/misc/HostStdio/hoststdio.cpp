@@ -0,0 +1,76 @@
+//   Copyright 2016-2023 Jean-Francois Poilpret
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+/*
+ * Special check for host-native builds (CONF=HOST): FastArduino streams must
+ * compile and work when <stdio.h> (which defines EOF) is included first.
+ * This program is not aimed for upload, just build and run on host:
+ * it prints results with printf() and returns non zero on failure.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <fastarduino/streams.h>
+
+#if !defined(FASTARDUINO_HOST)
+#error "Current target is not yet supported!"
+#endif
+
+REGISTER_OSTREAMBUF_NO_LISTENERS()
+
+static constexpr const uint8_t BUFFER_SIZE = 64;
+static char output_buffer[BUFFER_SIZE];
+static char input_buffer[BUFFER_SIZE];
+
+using namespace streams;
+
+int main()
+{
+	int errors = 0;
+
+	// Check output stream formatting against printf()
+	ostreambuf obuf{output_buffer};
+	// ostreambuf is locked until its consumer (normally a UART) starts
+	obuf.queue().unlock();
+	ostream out{obuf};
+	out << 1234 << ' ' << hex << 255 << '\n';
+	char actual[BUFFER_SIZE];
+	char* p = actual;
+	char c;
+	while (obuf.queue().pull(c)) *p++ = c;
+	*p = 0;
+	char expected[BUFFER_SIZE];
+	snprintf(expected, sizeof expected, "%d %x\n", 1234, 255);
+	printf("ostream: %s", actual);
+	if (strcmp(actual, expected) != 0)
+	{
+		printf("ERROR: expected %s", expected);
+		++errors;
+	}
+
+	// Check input stream EOF handling
+	istreambuf ibuf{input_buffer};
+	for (const char* s = "ab"; *s; ++s) ibuf.queue().push(*s);
+	istream in{ibuf};
+	in.ignore(2);
+	// Here EOF is <stdio.h> macro, it must match istreambuf::EOF
+	if (ibuf.sbumpc() != EOF)
+	{
+		printf("ERROR: istreambuf not empty\n");
+		++errors;
+	}
+
+	printf("%s\n", errors ? "FAILED" : "OK");
+	return errors;
+}
@@ -0,0 +1,187 @@
+//   Copyright 2016-2023 Jean-Francois Poilpret
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+/*
+ * Special check of devices::rf::Transport reception, for host-native builds
+ * (CONF=HOST): fragments are fed by a fake radio driver, no real NRF24L01
+ * device is used.
+ * This program is not aimed for upload, just build and run on host:
+ * it prints results with printf() and returns non zero on failure.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <fastarduino/errors.h>
+#include <fastarduino/time.h>
+#include <fastarduino/devices/nrf24l01p_transport.h>
+
+#if !defined(FASTARDUINO_HOST)
+#error "Current target is not yet supported!"
+#endif
+
+// Fake radio driver, receiving scripted payloads
+class FakeRadio
+{
+public:
+	static constexpr const uint8_t PAYLOAD_MAX = 30;
+	static const uint8_t BROADCAST = 0x00;
+	static constexpr const uint8_t SRC = 0x12;
+	static constexpr const uint8_t PORT = 0x01;
+
+	// Add one fragment to received payloads
+	void push(uint8_t msg_id, uint8_t index, uint8_t count, const uint8_t* data, uint8_t length)
+	{
+		Payload& payload = payloads_[count_++];
+		payload.data[0] = msg_id;
+		payload.data[1] = index;
+		payload.data[2] = count;
+		memcpy(&payload.data[3], data, length);
+		payload.length = 3 + length;
+	}
+
+	// Make recv_() time out once, when reaching this point
+	void push_timeout()
+	{
+		payloads_[count_++].length = 0;
+	}
+
+	uint8_t final_acks() const
+	{
+		return final_acks_;
+	}
+
+	// API used by Transport
+	int recv_(uint8_t& src, uint8_t& port, uint8_t* buf, size_t size, uint32_t ms UNUSED)
+	{
+		if (next_ == count_) return errors::ETIME;
+		const Payload& payload = payloads_[next_++];
+		if (payload.length == 0 || payload.length > size) return errors::ETIME;
+		src = SRC;
+		port = PORT;
+		memcpy(buf, payload.data, payload.length);
+		return payload.length;
+	}
+
+	int send_(uint8_t dest UNUSED, uint8_t port UNUSED, const uint8_t* buf UNUSED, size_t len UNUSED)
+	{
+		return errors::EIO;
+	}
+
+	int read_ack_payload(uint8_t* buf UNUSED, size_t size UNUSED)
+	{
+		return 0;
+	}
+
+	void write_ack_payload(const uint8_t* buf UNUSED, size_t len UNUSED, uint8_t copies = 1)
+	{
+		if (copies > 1) ++final_acks_;
+	}
+
+	void flush_tx() {}
+
+private:
+	struct Payload
+	{
+		uint8_t length;
+		uint8_t data[PAYLOAD_MAX];
+	};
+
+	Payload payloads_[16];
+	uint8_t count_ = 0;
+	uint8_t next_ = 0;
+	uint8_t final_acks_ = 0;
+};
+
+using TRANSPORT = devices::rf::Transport<FakeRadio>;
+static constexpr const uint8_t FRAGMENT_MAX = TRANSPORT::FRAGMENT_MAX;
+static constexpr const uint16_t MESSAGE_SIZE = FRAGMENT_MAX + 10;
+
+static uint8_t message[MESSAGE_SIZE];
+
+// No RTT here, time is frozen
+static uint32_t frozen_millis()
+{
+	return 0UL;
+}
+
+static int check(const char* name, bool ok)
+{
+	printf("%s: %s\n", name, ok ? "OK" : "FAILED");
+	return ok ? 0 : 1;
+}
+
+// Last fragment received before a timeout, first one after it
+static int check_resume_after_timeout()
+{
+	FakeRadio radio;
+	TRANSPORT transport{radio};
+	radio.push(1, 1, 2, message + FRAGMENT_MAX, MESSAGE_SIZE - FRAGMENT_MAX);
+	radio.push_timeout();
+	radio.push(1, 0, 2, message, FRAGMENT_MAX);
+
+	uint8_t buffer[MESSAGE_SIZE];
+	uint8_t src, port;
+	const int result1 = transport.recv(src, port, buffer, sizeof buffer);
+	const int result2 = transport.recv(src, port, buffer, sizeof buffer);
+	return check("resume after ETIME",
+		result1 == errors::ETIME && result2 == MESSAGE_SIZE && memcmp(buffer, message, MESSAGE_SIZE) == 0);
+}
+
+// Partial message is dropped when resumed with another buffer
+static int check_resume_other_buffer()
+{
+	FakeRadio radio;
+	TRANSPORT transport{radio};
+	radio.push(1, 1, 2, message + FRAGMENT_MAX, MESSAGE_SIZE - FRAGMENT_MAX);
+	radio.push_timeout();
+	radio.push(1, 0, 2, message, FRAGMENT_MAX);
+
+	uint8_t buffer1[MESSAGE_SIZE];
+	uint8_t buffer2[MESSAGE_SIZE];
+	uint8_t src, port;
+	const int result1 = transport.recv(src, port, buffer1, sizeof buffer1);
+	const int result2 = transport.recv(src, port, buffer2, sizeof buffer2);
+	return check("resume with other buffer", result1 == errors::ETIME && result2 == errors::ETIME);
+}
+
+// Header with no fragment is ignored, and does not prevent receiving same message id
+static int check_zero_count()
+{
+	FakeRadio radio;
+	TRANSPORT transport{radio};
+	radio.push(2, 0, 0, nullptr, 0);
+	radio.push_timeout();
+	radio.push(2, 0, 1, message, 10);
+
+	uint8_t buffer[MESSAGE_SIZE];
+	uint8_t src, port;
+	const int result1 = transport.recv(src, port, buffer, sizeof buffer);
+	const uint8_t final_acks = radio.final_acks();
+	const int result2 = transport.recv(src, port, buffer, sizeof buffer);
+	return check("zero count header",
+		result1 == errors::ETIME && final_acks == 0 && result2 == 10 && memcmp(buffer, message, 10) == 0);
+}
+
+int main()
+{
+	time::millis = frozen_millis;
+	for (uint16_t i = 0; i < MESSAGE_SIZE; ++i) message[i] = uint8_t(i * 7 + 1);
+
+	int errors = 0;
+	errors += check_resume_after_timeout();
+	errors += check_resume_other_buffer();
+	errors += check_zero_count();
+	printf("%s\n", errors ? "FAILED" : "OK");
+	return errors;
+}
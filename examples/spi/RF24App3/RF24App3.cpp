@@ -0,0 +1,166 @@
+//   Copyright 2016-2023 Jean-Francois Poilpret
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+/*
+ * NRF24L01+ asynchronous ping/pong example.
+ * This program shows usage of FastArduino support for NRF24L01+ device in
+ * fully asynchronous mode: sending never blocks, received packets and 
+ * transmission results are notified through events.
+ * The program should be uploaded to 2 boards.
+ * One board will act as "master" (initiates all exchanges), the other one as a
+ * "slave", will wait for master requests and will send reply after each received
+ * request.
+ * Master/Slave selection is performed by grounding PIN_CONFIG (if slave) or keep
+ * it floating (if master).
+ * Traces of all exchanges (and errors) are sent to the hardware USART.
+ * 
+ * Wiring:
+ * - on ATmega328P based boards (including Arduino UNO):
+ *   - D1 (TX) used for tracing program activities
+ *   - D7 master/slave configuration pin
+ *   - D13 (SCK), D12 (MISO), D11 (MOSI), D8 (CSN): SPI interface to NRF24L01+
+ *   - D9 (CE): interface to NRF24L01+
+ *   - D2 (EXT0, IRQ): interface to NRF24L01+
+ */
+
+#include <fastarduino/gpio.h>
+#include <fastarduino/realtime_timer.h>
+#include <fastarduino/time.h>
+#include <fastarduino/events.h>
+#include <fastarduino/uart.h>
+#include <fastarduino/devices/nrf24l01p.h>
+
+#if defined(ARDUINO_UNO) || defined(BREADBOARD_ATMEGA328P) || defined(ARDUINO_NANO)
+static const constexpr board::USART UART = board::USART::USART0;
+static const constexpr board::ExternalInterruptPin PIN_IRQ = board::ExternalInterruptPin::D2_PD2_EXT0;
+static const constexpr board::DigitalPin PIN_CONFIG = board::DigitalPin::D7_PD7;
+static const constexpr board::DigitalPin PIN_CSN = board::DigitalPin::D8_PB0;
+static const constexpr board::DigitalPin PIN_CE = board::DigitalPin::D9_PB1;
+static const constexpr board::Timer RTT_TIMER = board::Timer::TIMER2;
+#define INT_NUM 0
+#define USART_NUM 0
+#define TIMER_NUM 2
+#else
+#error "Current target is not yet supported!"
+#endif
+
+using EVENT = events::Event<void>;
+using RF = devices::rf::AsyncNRF24L01<PIN_CSN, PIN_CE, PIN_IRQ, EVENT>;
+
+// Buffers for UART
+static const uint8_t OUTPUT_BUFFER_SIZE = 64;
+static char output_buffer[OUTPUT_BUFFER_SIZE];
+
+// Buffers for received packets and events
+static const uint8_t PACKETS_SIZE = 8;
+static devices::rf::Packet packets_buffer[PACKETS_SIZE];
+static const uint8_t EVENTS_SIZE = 32;
+static EVENT events_buffer[EVENTS_SIZE];
+
+// Define vectors we need in the example
+REGISTER_UATX_ISR(USART_NUM)
+REGISTER_OSTREAMBUF_LISTENERS(serial::hard::UATX<UART>)
+REGISTER_RTT_ISR(TIMER_NUM)
+REGISTER_ASYNC_NRF24L01_ISR(INT_NUM, RF)
+
+static const uint16_t NETWORK = 0xFFFF;
+static const uint8_t MASTER = 0x01;
+static const uint8_t SLAVE = 0x02;
+
+static const uint32_t DELAY_BETWEEN_2_FRAMES_MS = 100L;
+
+static bool is_master()
+{
+	gpio::FAST_PIN<PIN_CONFIG> config{gpio::PinMode::INPUT_PULLUP};
+	return config.value();
+}
+
+int main()
+{
+	board::init();
+	// Enable interrupts at startup time
+	sei();
+
+	// Setup traces
+	serial::hard::UATX<UART> uatx{output_buffer};
+	uatx.begin(115200);
+	auto trace = uatx.out();
+	trace.width(0);
+	
+	bool master = is_master();
+	uint8_t self_device = master ? MASTER : SLAVE;
+	uint8_t other_device = master ? SLAVE : MASTER;
+	trace << "RF24App3 started as " << (master ? "Master" : "Slave") << streams::endl;
+
+	// Setup RTT
+	timer::RTT<RTT_TIMER> rtt;
+	rtt.begin();
+	// Set RTT instance as default clock from now
+	time::set_clock(rtt);
+
+	// Start SPI and setup NRF24
+	containers::Queue<devices::rf::Packet> packets{packets_buffer};
+	containers::Queue<EVENT> events{events_buffer};
+	spi::init();
+	RF rf{NETWORK, self_device, packets, events};
+	rf.begin();
+	trace << "NRF24L01+ started" << streams::endl;
+
+	uint8_t sent_port = 0;
+	if (master)
+	{
+		rf.send(other_device, sent_port);
+	}
+	
+	// Event Loop
+	while (true)
+	{
+		EVENT event = containers::pull(events);
+		switch (event.type())
+		{
+			case events::Type::RF_RECEIVED:
+			{
+				devices::rf::Packet packet;
+				if (rf.recv(packet))
+				{
+					trace << "R " << uint16_t(packet.port) << " (" << uint16_t(packet.src) << ") " << streams::flush;
+					// Slave replies to master with same content
+					if (!master)
+						rf.send(packet.src, packet.port);
+				}
+				if (master)
+				{
+					time::delay(DELAY_BETWEEN_2_FRAMES_MS);
+					rf.send(other_device, ++sent_port);
+				}
+				break;
+			}
+
+			case events::Type::RF_SEND_FAILED:
+			trace	<< "\nError! #Trans=" << rf.get_trans() 
+					<< " #Retrans=" << rf.get_retrans() 
+					<< " #Drops=" << rf.get_drops()
+					<< " #RxDrops=" << rf.get_rx_drops() << streams::endl;
+			if (master)
+			{
+				time::delay(DELAY_BETWEEN_2_FRAMES_MS);
+				rf.send(other_device, ++sent_port);
+			}
+			break;
+
+			default:
+			break;
+		}
+	}
+}
@@ -0,0 +1,67 @@
+#   Copyright 2016-2023 Jean-Francois Poilpret
+#
+#   Licensed under the Apache License, Version 2.0 (the "License");
+#   you may not use this file except in compliance with the License.
+#   You may obtain a copy of the License at
+#
+#       http://www.apache.org/licenses/LICENSE-2.0
+#
+#   Unless required by applicable law or agreed to in writing, software
+#   distributed under the License is distributed on an "AS IS" BASIS,
+#   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#   See the License for the specific language governing permissions and
+#   limitations under the License.
+
+# Makefile defining all FastArduino micro-benchmarks and how to run them under
+# simavr, for ATmega328P based targets only.
+#
+# > make CONF=UNO benchmarks
+# builds and runs all benchmarks then generates a tab-delimited sheet
+# (benchmarks-UNO.txt by default, can be changed with BENCH_SHEET variable)
+# with the number of CPU cycles of each benchmark.
+# Two such sheets (e.g. from 2 commits) can then be compared with:
+# > make/compare-bench-sheets.py benchmarks-old.txt benchmarks-new.txt
+#
+# > make CONF=UNO benchmarks-isr
+# does the same with all benchmarks built with ISR profiling, and generates
+# a sheet (isr-UNO.txt by default, can be changed with ISR_SHEET variable)
+# with the maximum and average CPU cycles of each ISR called by benchmarks.
+#
+# simavr executable can be set with SIMAVR variable (default is to use $PATH)
+
+ALL_BENCHMARKS=	queue streams fastpin future events i2c spi uart
+
+SIMAVR?=simavr
+BENCH_SHEET?=benchmarks-$(CONF).txt
+ISR_SHEET?=isr-$(CONF).txt
+
+bench_freq:=$(patsubst %UL,%,$(F_CPU))
+bench_logs:=$(foreach bench, $(ALL_BENCHMARKS), benchmarks/$(bench)/dist/$(config)/$(bench).log)
+
+.PHONY: .benchmarks-check
+.benchmarks-check:
+ifeq ($(HOST),true)
+	$(error Benchmarks cannot run on host-native build)
+endif
+ifneq ($(MCU),atmega328p)
+	$(error Benchmarks can only run on ATmega328P based targets (e.g. CONF=UNO))
+endif
+
+.PHONY: benchmarks
+benchmarks: .benchmarks-check build
+	$(foreach bench, $(ALL_BENCHMARKS), $(MAKE) -C benchmarks/$(bench) &&) true
+	$(foreach bench, $(ALL_BENCHMARKS), \
+		$(SIMAVR) -m $(MCU) -f $(bench_freq) benchmarks/$(bench)/dist/$(config)/$(bench) \
+			>benchmarks/$(bench)/dist/$(config)/$(bench).log 2>&1 &&) true
+	$(thispath)gen-bench-sheet.py $(BENCH_SHEET) $(bench_logs)
+
+.PHONY: benchmarks-isr
+benchmarks-isr: .benchmarks-check
+	$(MAKE) clean-benchmarks
+	$(MAKE) benchmarks ADDITIONAL_CXX_OPTIONS="$(ADDITIONAL_CXX_OPTIONS) -DFASTARDUINO_ISR_PROFILE" \
+		BENCH_SHEET=$(ISR_SHEET)
+	$(MAKE) clean-benchmarks
+
+.PHONY: clean-benchmarks
+clean-benchmarks:
+	$(foreach bench, $(ALL_BENCHMARKS), $(MAKE) -C benchmarks/$(bench) clean;)
@@ -92,7 +92,8 @@ EXAMPLES_ARDUINO_UNO=	complete/Conway							\
 						spi/Nokia5110_1							\
 						spi/Nokia5110_2							\
 						spi/Nokia5110_3							\
-						spi/Nokia5110_4							
+						spi/Nokia5110_4							\
+						spi/RF24App3							
 
 EXAMPLES_BREADBOARD_ATMEGAXX4P=	int/ExternalInterrupt3					\
 								analog/AnalogComparator1				\
@@ -214,9 +215,14 @@ EXAMPLES_BREADBOARD_ATTINYX5=	io/FastPin1 io/FastPin2			\
 								future/PCIFuture				\
 								tones/tones00					
 
+# Examples for host-native build (CONF=HOST), not aimed for upload
+EXAMPLES_HOST=	misc/HostStdio misc/HostTransportCheck misc/HostMCP23017Check
+
 # Finally define all examples supported for the current variant (defined by current configuration)
 # Note that ATtinyX5 needs its own (reduced) set of examples (because of many limitations)
-ifeq ($(VARIANT), BREADBOARD_ATTINYX5)
+ifeq ($(HOST), true)
+	ALL_EXAMPLES = ${EXAMPLES_HOST}
+else ifeq ($(VARIANT), BREADBOARD_ATTINYX5)
 	ALL_EXAMPLES = ${EXAMPLES_${VARIANT}}
 else
 	ALL_EXAMPLES = ${COMMON_EXAMPLES} ${EXAMPLES_${VARIANT}}
@@ -225,7 +231,7 @@ endif
 REALLY_ALL_EXAMPLES =	${COMMON_EXAMPLES} ${EXAMPLES_ARDUINO_UNO} ${EXAMPLES_ARDUINO_LEONARDO} \
 						${EXAMPLES_ARDUINO_MEGA} ${EXAMPLES_ARDUINO_NANO} ${EXAMPLES_BREADBOARD_ATMEGA328P} \
 						${EXAMPLES_BREADBOARD_ATTINYX4} ${EXAMPLES_BREADBOARD_ATTINYX5} \
-						${EXAMPLES_BREADBOARD_ATMEGAXX4P}
+						${EXAMPLES_BREADBOARD_ATMEGAXX4P} ${EXAMPLES_HOST}
 
 # Special build target for all fastArduino examples
 # Need to export all necessary variables to submakes
@@ -25,14 +25,27 @@ include $(thispath)Makefile-common.mk
 
 # Main target project using FastArduino
 $(target): $(objects) $(libs)
-	$(rm) $@ $@.eep $@.nm $@.map
+	$(rm) $@ $@.eep $@.nm $@.map $@.*.ci
 	$(link.o) $(abspath $^)
+ifeq ($(HOST),true)
+	$(nm) -S -C --size-sort $@ >$@.nm
+	$(objsize) -A $@
+else
 	$(objcopy) -R .eeprom -O ihex $@ $@.hex
 	$(objcopy) -j .eeprom --change-section-lma .eeprom=0 -O ihex $@ $@.eep
 	$(nm) --synthetic -S -C --size-sort $@ >$@.nm
 	$(objdump) -m $(ARCH) -x -d -C $@ >$@.dump
 	$(objsize) -A --mcu=$(MCU) $@
 #	$(objsize) -C --mcu=$(MCU) $@
+endif
+
+# Static worst-case stack usage analysis (build must be done with STACK_USAGE=true)
+.PHONY: stack-usage
+stack-usage: $(target)
+ifneq ($(STACK_USAGE),true)
+	$(error stack-usage requires STACK_USAGE=true)
+endif
+	$(thispath)stack-usage.py $(STACK_USAGE_OPTIONS) $$(ls $(target).*.ci $(patsubst %.o,%.ci,$(objects)) 2>/dev/null)
 
 # Upload Targets
 .PHONY: .upload-check
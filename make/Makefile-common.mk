@@ -42,7 +42,11 @@ ifndef ADDITIONAL_LD_OPTIONS
 endif
 
 # Output directories
-config:=$(VARIANT)-$(subst 000000UL,MHz,$(F_CPU))
+ifeq ($(HOST),true)
+	config:=HOST-$(VARIANT)-$(subst 000000UL,MHz,$(F_CPU))
+else
+	config:=$(VARIANT)-$(subst 000000UL,MHz,$(F_CPU))
+endif
 objdir:=build/$(config)
 depdir:=deps/$(config)
 distdir:=dist/$(config)
@@ -58,7 +62,12 @@ endif
 libs:=$(fastarduinolib) $(ADDITIONAL_LIBS)
 
 # Input directories
-includes:=$(patsubst %,-I %,$(abspath $(FASTARDUINO_ROOT)/cores $(ADDITIONAL_INCLUDES)))
+ifeq ($(HOST),true)
+	# Host replacements of avr-libc headers must be found first
+	includes:=$(patsubst %,-I %,$(abspath $(FASTARDUINO_ROOT)/cores/host $(FASTARDUINO_ROOT)/cores $(ADDITIONAL_INCLUDES)))
+else
+	includes:=$(patsubst %,-I %,$(abspath $(FASTARDUINO_ROOT)/cores $(ADDITIONAL_INCLUDES)))
+endif
 
 # List of source files
 sources:=$(shell find $(SOURCE_ROOT) -name "*.cpp")
@@ -75,13 +84,24 @@ endif
 
 # Environment
 rm:=rm -f
-ar:=$(avr_tool_path)avr-gcc-ar
-ranlib:=$(avr_tool_path)avr-gcc-ranlib
-cxx:=$(avr_tool_path)avr-g++
-nm:=$(avr_tool_path)avr-nm
-objcopy:=$(avr_tool_path)avr-objcopy
-objdump:=$(avr_tool_path)avr-objdump
-objsize:=$(avr_tool_path)avr-size
+ifeq ($(HOST),true)
+	# Host-native build uses host toolchain
+	ar:=gcc-ar
+	ranlib:=gcc-ranlib
+	cxx:=g++
+	nm:=nm
+	objcopy:=objcopy
+	objdump:=objdump
+	objsize:=size
+else
+	ar:=$(avr_tool_path)avr-gcc-ar
+	ranlib:=$(avr_tool_path)avr-gcc-ranlib
+	cxx:=$(avr_tool_path)avr-g++
+	nm:=$(avr_tool_path)avr-nm
+	objcopy:=$(avr_tool_path)avr-objcopy
+	objdump:=$(avr_tool_path)avr-objdump
+	objsize:=$(avr_tool_path)avr-size
+endif
 
 # Flags for compilation and build
 #NOTE initial common flags (9.2)
@@ -90,8 +110,23 @@ commonflags:= -mmcu=$(MCU) -DF_CPU=$(F_CPU) -D$(VARIANT) -std=c++17 -Wall -Wextr
 # Additional flags (for testing optimization) can be set to the following variable used with GCC 10.2
 extraflags:= --param=max-inline-insns-auto=20 --param=max-inline-insns-single=20 --param=early-inlining-insns=20
 
+ifeq ($(HOST),true)
+	# Host-native build: same code as for the AVR target, but simulated registers
+	commonflags:= -DFASTARDUINO_HOST -D__AVR_ATmega328P__ -DF_CPU=$(F_CPU) -D$(VARIANT) -std=c++17 -Wall -Wextra -O2 -fno-exceptions -ffunction-sections -fdata-sections
+	extraflags:=
+endif
+
+# Optional call graph with stack usage per function, for `make stack-usage` (requires GCC 10+)
+ifeq ($(STACK_USAGE),true)
+	commonflags+= -fcallgraph-info=su
+endif
+
 cxxflags:= $(commonflags) $(extraflags) -DNO_ABI $(includes) -g0
-ldflags = $(commonflags) $(extraflags) -Wl,--gc-sections -Wl,--relax -Wl,-Map,$@.map
+ifeq ($(HOST),true)
+	ldflags = $(commonflags) $(extraflags) -Wl,--gc-sections -Wl,-Map,$@.map
+else
+	ldflags = $(commonflags) $(extraflags) -Wl,--gc-sections -Wl,--relax -Wl,-Map,$@.map
+endif
 depflags = -MT $@ -MMD -MP -MF $(depdir)/$*.Td
 
 compile.cc = $(cxx) $(depflags) $(cxxflags) $(ADDITIONAL_CXX_OPTIONS) -c -o $@
@@ -105,6 +105,14 @@ else ifeq ($(findstring MEGA,$(CONF)),MEGA)
 	ifeq ($(COM),)
 		COM:=/dev/ttyACM0
 	endif
+else ifeq ($(findstring HOST,$(CONF)),HOST)
+	# Host-native build (e.g. x86-64 Linux) with simulated registers,
+	# based on ARDUINO_UNO board
+	VARIANT:=ARDUINO_UNO
+	MCU:=atmega328p
+	ARCH:=host
+	F_CPU:=16000000UL
+	HOST:=true
 # Add other targets here
 endif
 
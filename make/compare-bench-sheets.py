@@ -0,0 +1,54 @@
+#!/usr/bin/python3
+# encoding: utf-8
+
+# This script compares 2 sheets with FastArduino benchmarks CPU cycles, as
+# generated by gen-bench-sheet.py (e.g. for 2 different commits).
+# It generates a new sheet with absolute and relative differences.
+
+from __future__ import with_statement
+import argparse, sys
+
+ALL_BENCHMARKS = []
+ALL_CYCLES = {}
+
+def fill_data(infile, index):
+    global ALL_BENCHMARKS
+    global ALL_CYCLES
+    with infile:
+        num_line = 1
+        for line in infile:
+            # Skip header
+            if num_line != 1:
+                data = line.rstrip().split('\t')
+                benchmark = data[0]
+                if benchmark not in ALL_CYCLES:
+                    ALL_BENCHMARKS.append(benchmark)
+                    ALL_CYCLES[benchmark] = {}
+                ALL_CYCLES[benchmark]['cycles%d' % index] = int(data[1])
+            num_line += 1
+
+def create_diff_sheet(args):
+    with args.output:
+        args.output.write("Benchmark\tcycles\tdiff\tdiff%\n")
+        for benchmark in ALL_BENCHMARKS:
+            data = ALL_CYCLES[benchmark]
+            args.output.write("%s" % benchmark)
+            if 'cycles1' in data and 'cycles2' in data:
+                cycles1 = data['cycles1']
+                cycles2 = data['cycles2']
+                diff = cycles2 - cycles1
+                diff_percent = 100.0 * diff / cycles1 if cycles1 > 0 else 0.0
+                args.output.write("\t%d\t%d\t%.0f" % (cycles1, diff, diff_percent))
+            else:
+                args.output.write("\t\t\t")
+            args.output.write("\n")
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description = 'Compare 2 benchmarks sheets')
+    parser.add_argument('inputs', nargs=2, type=argparse.FileType('r'))
+    parser.add_argument('output', nargs='?', type=argparse.FileType('w'), default=sys.stdout)
+    args = parser.parse_args()
+
+    fill_data(args.inputs[0], 1)
+    fill_data(args.inputs[1], 2)
+    create_diff_sheet(args)
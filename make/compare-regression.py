@@ -0,0 +1,105 @@
+#!/usr/bin/python3
+# encoding: utf-8
+
+# This script compares 2 sets of FastArduino measures (e.g. for 2 different
+# commits), as collected by make/regression-report, and flags regressions
+# beyond a threshold.
+# Each set is a directory containing, for each target:
+# - sizes-<TARGET>.txt: code and data sizes of all examples, as produced by stats.py
+# - benchmarks-<TARGET>.txt: benchmarks CPU cycles, as produced by gen-bench-sheet.py
+# - isr-<TARGET>.txt: ISR CPU cycles, as produced by gen-bench-sheet.py from
+#   benchmarks built with ISR profiling (only "isr/..." lines are used)
+# Missing files are simply ignored.
+#
+# Output is machine-readable, either tab-delimited (default) or JSON, with one
+# entry per metric: metric name, old value, new value, difference, relative
+# difference and status (OK, REGRESSION, IMPROVEMENT, NEW or REMOVED).
+# Exit status is 1 if any regression was found.
+
+from __future__ import with_statement
+import argparse, glob, json, os, sys
+
+def read_sizes(filename, target, metrics):
+    with open(filename, "r") as handle:
+        for line in handle:
+            data = line.rstrip().split('\t')
+            if len(data) == 3:
+                metrics["size/%s/%s/code" % (target, data[0])] = int(data[1])
+                metrics["size/%s/%s/data" % (target, data[0])] = int(data[2])
+
+def read_cycles(filename, target, metrics, isr_only):
+    with open(filename, "r") as handle:
+        num_line = 1
+        for line in handle:
+            # Skip header
+            if num_line != 1:
+                data = line.rstrip().split('\t')
+                if not isr_only or data[0].startswith("isr/"):
+                    metrics["cycles/%s/%s" % (target, data[0])] = int(data[1])
+            num_line += 1
+
+def read_metrics(directory):
+    metrics = {}
+    for filename in sorted(glob.glob(os.path.join(directory, "*-*.txt"))):
+        kind, target = os.path.splitext(os.path.basename(filename))[0].split('-', 1)
+        if kind == "sizes":
+            read_sizes(filename, target, metrics)
+        elif kind == "benchmarks":
+            read_cycles(filename, target, metrics, False)
+        elif kind == "isr":
+            read_cycles(filename, target, metrics, True)
+    return metrics
+
+def compare(old, new, threshold, min_diff):
+    results = []
+    for metric in sorted(set(old) | set(new)):
+        entry = {"metric": metric, "old": old.get(metric), "new": new.get(metric), "diff": None, "diff%": None}
+        if metric not in new:
+            entry["status"] = "REMOVED"
+        elif metric not in old:
+            entry["status"] = "NEW"
+        else:
+            diff = new[metric] - old[metric]
+            diff_percent = 100.0 * diff / old[metric] if old[metric] > 0 else (100.0 if diff else 0.0)
+            entry["diff"] = diff
+            entry["diff%"] = round(diff_percent, 2)
+            if abs(diff) <= min_diff or abs(diff_percent) <= threshold:
+                entry["status"] = "OK"
+            elif diff > 0:
+                entry["status"] = "REGRESSION"
+            else:
+                entry["status"] = "IMPROVEMENT"
+        results.append(entry)
+    return results
+
+def write_tsv(output, results, all_metrics):
+    output.write("metric\told\tnew\tdiff\tdiff%\tstatus\n")
+    for entry in results:
+        if all_metrics or entry["status"] != "OK":
+            output.write("\t".join("" if entry[key] is None else str(entry[key])
+                for key in ("metric", "old", "new", "diff", "diff%", "status")) + "\n")
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description = 'Compare 2 sets of FastArduino size and cycles measures')
+    parser.add_argument('--threshold', type=float, default=1.0,
+        help='relative difference (in %%) above which a change is flagged (default: 1.0)')
+    parser.add_argument('--min-diff', type=int, default=0,
+        help='absolute difference (bytes or cycles) under which a change is never flagged (default: 0)')
+    parser.add_argument('--json', action='store_true', help='output JSON instead of tab-delimited text')
+    parser.add_argument('--all', action='store_true', help='output all metrics, not only changed ones')
+    parser.add_argument('old', help='directory of measures of the old revision')
+    parser.add_argument('new', help='directory of measures of the new revision')
+    parser.add_argument('output', nargs='?', type=argparse.FileType('w'), default=sys.stdout)
+    args = parser.parse_args()
+
+    results = compare(read_metrics(args.old), read_metrics(args.new), args.threshold, args.min_diff)
+    with args.output:
+        if args.json:
+            json.dump([entry for entry in results if args.all or entry["status"] != "OK"], args.output, indent = 1)
+            args.output.write("\n")
+        else:
+            write_tsv(args.output, results, args.all)
+    regressions = [entry["metric"] for entry in results if entry["status"] == "REGRESSION"]
+    if regressions:
+        sys.stderr.write("%d regression(s) found\n" % len(regressions))
+        sys.exit(1)
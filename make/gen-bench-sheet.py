@@ -0,0 +1,44 @@
+#!/usr/bin/python3
+# encoding: utf-8
+
+# This script generates a sheet (ready for LibreOffice import as tab-delimited)
+# with the number of CPU cycles of all FastArduino benchmarks, from the output
+# logs of all benchmarks run under simavr.
+# Each benchmark outputs one line per result: "BENCH\t<name>\t<cycles>".
+# When built with ISR profiling, each benchmark also outputs one line per ISR:
+# "ISR\t<vector>\t<count>\t<max>\t<avg>"; these are added to the sheet as
+# "isr/<benchmark>/<vector>/max" and "isr/<benchmark>/<vector>/avg".
+
+from __future__ import with_statement
+import argparse, os, re, sys
+
+BENCH_EXTRACTOR = re.compile(r"BENCH\t([^\t]+)\t([0-9]+)")
+ISR_EXTRACTOR = re.compile(r"ISR\t([^\t]+)\t([0-9]+)\t([0-9]+)\t([0-9]+)")
+
+def create_sheet(args):
+    with args.output:
+        args.output.write("Benchmark\tcycles\n")
+        for log in args.logs:
+            count = 0
+            benchmark = os.path.splitext(os.path.basename(log.name))[0]
+            with log:
+                for line in log:
+                    matcher = BENCH_EXTRACTOR.search(line)
+                    if matcher:
+                        args.output.write("%s\t%s\n" % (matcher.group(1), matcher.group(2)))
+                        count += 1
+                        continue
+                    matcher = ISR_EXTRACTOR.search(line)
+                    if matcher:
+                        args.output.write("isr/%s/%s/max\t%s\n" % (benchmark, matcher.group(1), matcher.group(3)))
+                        args.output.write("isr/%s/%s/avg\t%s\n" % (benchmark, matcher.group(1), matcher.group(4)))
+                        count += 1
+            if count == 0:
+                sys.stderr.write("No benchmark result found in %s\n" % log.name)
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description = 'Generate benchmarks sheet from simavr logs')
+    parser.add_argument('output', type=argparse.FileType('w'))
+    parser.add_argument('logs', nargs='+', type=argparse.FileType('r'))
+    args = parser.parse_args()
+    create_sheet(args)
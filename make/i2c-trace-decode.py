@@ -0,0 +1,153 @@
+#!/usr/bin/python3
+# encoding: utf-8
+
+# This script decodes binary I2C bus events streamed by FastArduino
+# i2c::debug::I2CBusTracer (see fastarduino/i2c_debug.h), reconstructs all
+# I2C transactions (from START to STOP) and prints them, one per line:
+# "<time us>\t<device>\t<bytes written and read>\t<duration us>\t<errors>",
+# followed by per-device statistics (transactions, bytes, errors, min, max and
+# average transaction duration, share of bus time) and global bus utilization.
+# Events are read from a file or a serial device (already configured, e.g.
+# with stty), or from standard input, until end of input (or Ctrl+C).
+# Timestamps are unwrapped assuming at least one event per trace timer period;
+# --tick-us must match the trace timer prescaler (4us for DIV_64 at 16MHz).
+
+from __future__ import with_statement
+import argparse, sys
+
+SYNC = 0x5A
+RECORD_SIZE = 5
+
+START, REPEAT_START, SLAW, SLAR, SEND, RECV, RECV_LAST, STOP, \
+    SEND_OK, SEND_ERROR, RECV_OK, RECV_ERROR = range(12)
+STATUS_ERROR = 0x0E
+DROPPED = 0x0F
+
+class Transaction:
+    def __init__(self, time):
+        self.time = time
+        self.device = None
+        self.content = []
+        self.errors = []
+        self.written = 0
+        self.read = 0
+        self.duration = None
+
+class DeviceStats:
+    def __init__(self):
+        self.count = 0
+        self.written = 0
+        self.read = 0
+        self.errors = 0
+        self.busy = 0.0
+        self.min = None
+        self.max = 0.0
+
+    def add(self, transaction):
+        self.count += 1
+        self.written += transaction.written
+        self.read += transaction.read
+        self.errors += (1 if transaction.errors else 0)
+        self.busy += transaction.duration
+        self.min = transaction.duration if self.min is None else min(self.min, transaction.duration)
+        self.max = max(self.max, transaction.duration)
+
+def read_events(input):
+    buffer = bytearray()
+    while True:
+        chunk = input.read1(256) if hasattr(input, "read1") else input.read(256)
+        if not chunk:
+            break
+        buffer.extend(chunk)
+        while len(buffer) >= RECORD_SIZE:
+            if buffer[0] != SYNC or buffer[3] > DROPPED:
+                # Lost synchronization: skip to next potential record
+                del buffer[0]
+                continue
+            yield buffer[1] | (buffer[2] << 8), buffer[3], buffer[4]
+            del buffer[:RECORD_SIZE]
+
+def decode(args, output):
+    devices = {}
+    current = None
+    last = None
+    clock = 0
+    first = None
+    dropped = 0
+    def close(transaction, time):
+        transaction.duration = (time - transaction.time) * args.tick_us
+        device = "0x%02x" % transaction.device if transaction.device is not None else "?"
+        output.write("%.0f\t%s\t%s\t%.0f\t%s\n" % (transaction.time * args.tick_us, device,
+            " ".join(transaction.content), transaction.duration, " ".join(transaction.errors)))
+        output.flush()
+        devices.setdefault(device, DeviceStats()).add(transaction)
+    try:
+        for timestamp, event, data in read_events(args.input):
+            if last is not None:
+                clock += (timestamp - last) & 0xFFFF
+            last = timestamp
+            if first is None:
+                first = clock
+            if event == START:
+                if current is not None:
+                    current.errors.append("NO_STOP")
+                    close(current, clock)
+                current = Transaction(clock)
+                continue
+            if event == DROPPED:
+                dropped += data
+            if current is None:
+                # Events before first START (e.g. tracer started in the middle of a transaction)
+                continue
+            if event == REPEAT_START:
+                current.content.append("RS")
+            elif event in (SLAW, SLAR):
+                if current.device is None:
+                    current.device = data >> 1
+                current.content.append("W" if event == SLAW else "R")
+            elif event == SEND:
+                current.content.append("%02x" % data)
+                current.written += 1
+            elif event == SEND_ERROR:
+                current.errors.append("NACK")
+            elif event == RECV_OK:
+                current.content.append("%02x" % data)
+                current.read += 1
+            elif event == RECV_ERROR:
+                current.content.append("%02x!" % data)
+                current.read += 1
+                current.errors.append("RECV_ERROR")
+            elif event == STATUS_ERROR:
+                current.errors.append("STATUS=0x%02x" % data)
+            elif event == DROPPED:
+                current.errors.append("DROPPED=%d" % data)
+            elif event == STOP:
+                close(current, clock)
+                current = None
+    except KeyboardInterrupt:
+        pass
+
+    if first is None:
+        sys.stderr.write("No I2C event found\n")
+        return
+    span = (clock - first) * args.tick_us
+    busy = sum(stats.busy for stats in devices.values())
+    output.write("\nDevice\tcount\twritten\tread\terrors\tmin us\tmax us\tavg us\tbus share\n")
+    for device in sorted(devices):
+        stats = devices[device]
+        output.write("%s\t%d\t%d\t%d\t%d\t%.0f\t%.0f\t%.0f\t%.1f%%\n" % (device, stats.count, stats.written,
+            stats.read, stats.errors, stats.min, stats.max, stats.busy / stats.count,
+            100.0 * stats.busy / busy if busy else 0.0))
+    output.write("Bus utilization\t%.1f%% (%.0f us busy over %.0f us)\n" % (
+        100.0 * busy / span if span else 0.0, busy, span))
+    if dropped:
+        output.write("Dropped events\t%d\n" % dropped)
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description = 'Decode FastArduino binary I2C bus traces')
+    parser.add_argument('--tick-us', type=float, default=4.0,
+        help='duration of one trace timer tick, in microseconds (default: 4)')
+    parser.add_argument('input', nargs='?', type=argparse.FileType('rb'), default=sys.stdin.buffer,
+        help='file or serial device to read I2C events from (default: stdin)')
+    args = parser.parse_args()
+    decode(args, sys.stdout)
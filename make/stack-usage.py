@@ -0,0 +1,141 @@
+#!/usr/bin/python3
+# encoding: utf-8
+
+# This script computes the static worst-case stack usage of a FastArduino
+# program, from the call graph files (*.ci) generated by GCC (10 or later)
+# with "-fcallgraph-info=su", i.e. by building with STACK_USAGE=true:
+# > make CONF=UNO STACK_USAGE=true stack-usage
+#
+# The worst case of each root (main and each ISR, i.e. __vector_N) is the
+# deepest path in its call tree; the program worst case is then the worst
+# case of main plus the worst case of all ISR that can preempt it: the worst
+# single ISR by default (ISR do not nest on AVR), or the sum of all ISR if
+# --nested-isr is set (for programs using ISR_NOBLOCK).
+#
+# Recursive calls, dynamic stack allocation, indirect calls and functions
+# with unknown stack usage (e.g. assembly functions from libgcc) make the
+# result unsafe; they are all reported. Stack usage of such functions can be
+# provided with --extra NAME=BYTES (use __indirect_call for indirect calls).
+
+from __future__ import with_statement
+import argparse, re, sys
+
+NODE_EXTRACTOR = re.compile(r'node: \{ title: "([^"]+)" label: "([^"]*)"')
+EDGE_EXTRACTOR = re.compile(r'edge: \{ sourcename: "([^"]+)" targetname: "([^"]+)"')
+USAGE_EXTRACTOR = re.compile(r"\\n([0-9]+) bytes \(([a-z,]+)\)")
+INDIRECT_CALL = "__indirect_call"
+ISR_EXTRACTOR = re.compile(r"^__vector_[0-9]+$")
+
+class Function:
+    def __init__(self, title):
+        self.title = title
+        self.symbol = title.split(":")[-1]
+        self.name = self.symbol
+        self.usage = None
+        self.qualifier = None
+        self.callees = set()
+
+def read_graphs(files):
+    functions = {}
+    def function(title):
+        if title not in functions:
+            functions[title] = Function(title)
+        return functions[title]
+    for ci in files:
+        with ci:
+            for line in ci:
+                matcher = NODE_EXTRACTOR.search(line)
+                if matcher:
+                    node = function(matcher.group(1))
+                    name = matcher.group(2).split("\\n")[0]
+                    if name and node.title != INDIRECT_CALL:
+                        node.name = name
+                    usage = USAGE_EXTRACTOR.search(matcher.group(2))
+                    if usage:
+                        node.usage = int(usage.group(1))
+                        node.qualifier = usage.group(2)
+                    continue
+                matcher = EDGE_EXTRACTOR.search(line)
+                if matcher:
+                    function(matcher.group(1)).callees.add(function(matcher.group(2)).title)
+    return functions
+
+def analyze(functions, extra, warnings):
+    cache = {}
+    def worst(title, path):
+        if title in path:
+            warnings.add("recursion: %s" % " -> ".join(functions[t].name for t in path + [title]))
+            return 0, []
+        if title in cache:
+            return cache[title]
+        node = functions[title]
+        usage = node.usage
+        if node.symbol in extra:
+            usage = extra[node.symbol]
+        elif title == INDIRECT_CALL:
+            warnings.add("indirect call(s) from: %s" % functions[path[-1]].name)
+            usage = 0
+        elif usage is None:
+            warnings.add("unknown stack usage: %s" % node.name)
+            usage = 0
+        elif node.qualifier != "static":
+            warnings.add("%s stack usage: %s" % (node.qualifier, node.name))
+        deepest, deepest_path = 0, []
+        for callee in sorted(node.callees):
+            size, callee_path = worst(callee, path + [title])
+            if size > deepest:
+                deepest, deepest_path = size, callee_path
+        result = (usage + deepest, [title] + deepest_path)
+        cache[title] = result
+        return result
+    return worst
+
+def report(args):
+    functions = read_graphs(args.graphs)
+    if not functions:
+        sys.stderr.write("No call graph found\n")
+        sys.exit(1)
+    extra = dict((name, int(size)) for name, size in (e.split("=") for e in args.extra))
+    warnings = set()
+    worst = analyze(functions, extra, warnings)
+
+    mains = [title for title in functions if functions[title].symbol == "main" and functions[title].usage is not None]
+    isrs = sorted((title for title in functions if ISR_EXTRACTOR.match(functions[title].symbol)),
+        key = lambda title: int(functions[title].symbol[len("__vector_"):]))
+
+    print("Root\tbytes\tworst path")
+    main_usage = 0
+    for title in mains:
+        main_usage, path = worst(title, [])
+        print("main\t%d\t%s" % (main_usage, " -> ".join(functions[t].name for t in path)))
+    isr_usages = []
+    for title in isrs:
+        usage, path = worst(title, [])
+        isr_usages.append(usage)
+        print("%s\t%d\t%s" % (functions[title].symbol, usage, " -> ".join(functions[t].name for t in path)))
+
+    if args.nested_isr:
+        isr_usage = sum(isr_usages)
+    else:
+        isr_usage = max(isr_usages, default = 0)
+    total = main_usage + isr_usage
+    print("Total\t%d" % total)
+    if args.available is not None:
+        print("Margin\t%d" % (args.available - total))
+
+    for warning in sorted(warnings):
+        sys.stderr.write("Warning: %s\n" % warning)
+    if args.available is not None and total > args.available:
+        sys.exit(2)
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description = 'Compute worst-case stack usage from GCC call graph files')
+    parser.add_argument('--nested-isr', action='store_true',
+        help='assume all ISR may be nested (ISR_NOBLOCK)')
+    parser.add_argument('--available', type=int,
+        help='SRAM bytes available to the stack (e.g. as reported by memory::dump_sram()), to compute margin')
+    parser.add_argument('--extra', action='append', default=[], metavar='NAME=BYTES',
+        help='stack usage of a function not found in call graphs, or of indirect calls (__indirect_call)')
+    parser.add_argument('graphs', nargs='+', type=argparse.FileType('r'))
+    args = parser.parse_args()
+    report(args)
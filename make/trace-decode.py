@@ -0,0 +1,153 @@
+#!/usr/bin/python3
+# encoding: utf-8
+
+# This script decodes binary trace records produced by FastArduino `TRACE()`
+# (see fastarduino/trace.h) and prints them as text, one line per record:
+# "<timestamp>\t<formatted message>".
+# Format strings are read from the ".fastarduino.trace" section of the ELF file
+# of the traced program; records are read from a file or a serial device
+# (already configured, e.g. with stty), or from standard input.
+# Timestamps are unwrapped to a monotonic count of trace timer ticks (this is
+# correct only if at least one record is produced per timer period).
+
+from __future__ import with_statement
+import argparse, re, struct, sys
+
+TRACE_SECTION = b".fastarduino.trace"
+SYNC = 0xA5
+HEADER_SIZE = 5
+
+EM_AVR = 83
+
+# Sizes of (int, long, double, pointer) per target
+SIZES_AVR = (2, 4, 4, 2)
+SIZES_HOST = (4, 8, 8, 8)
+
+SPEC_EXTRACTOR = re.compile(r"%([-+ #0]*[0-9]*(?:\.[0-9]+)?)(hh|h|ll|l|j|z|t|L)?([diouxXcpeEfFgGaA%])")
+
+def fnv_hash(format):
+    hash = 2166136261
+    for c in format:
+        hash = ((hash ^ c) * 16777619) & 0xFFFFFFFF
+    return (hash ^ (hash >> 16)) & 0xFFFF
+
+def read_formats(elf):
+    data = elf.read()
+    if data[:4] != b"\x7fELF":
+        raise ValueError("%s is not an ELF file" % elf.name)
+    is64 = (data[4] == 2)
+    endian = "<" if data[5] == 1 else ">"
+    machine = struct.unpack_from(endian + "H", data, 18)[0]
+    if is64:
+        shoff = struct.unpack_from(endian + "Q", data, 0x28)[0]
+        shentsize, shnum, shstrndx = struct.unpack_from(endian + "HHH", data, 0x3A)
+    else:
+        shoff = struct.unpack_from(endian + "I", data, 0x20)[0]
+        shentsize, shnum, shstrndx = struct.unpack_from(endian + "HHH", data, 0x2E)
+
+    def section(index):
+        base = shoff + index * shentsize
+        if is64:
+            name, _, _, _, offset, size = struct.unpack_from(endian + "IIQQQQ", data, base)
+        else:
+            name, _, _, _, offset, size = struct.unpack_from(endian + "IIIIII", data, base)
+        return name, offset, size
+
+    _, strtab, _ = section(shstrndx)
+    formats = []
+    for index in range(shnum):
+        name, offset, size = section(index)
+        name = data[strtab + name : data.index(b"\0", strtab + name)]
+        if name == TRACE_SECTION:
+            formats.extend(s for s in data[offset : offset + size].split(b"\0") if s)
+    return (SIZES_AVR if machine == EM_AVR else SIZES_HOST), formats
+
+def compile_format(format, sizes):
+    int_size, long_size, double_size, pointer_size = sizes
+    args = []
+    def convert(matcher):
+        flags, length, conversion = matcher.groups()
+        if conversion == "%":
+            return "%%"
+        if conversion in "eEfFgGaA":
+            if double_size == 4:
+                args.append("<f")
+            else:
+                args.append("<d")
+            return "%" + flags + conversion
+        if conversion == "p":
+            args.append("<" + {2: "H", 4: "I", 8: "Q"}[pointer_size])
+            return "0x%" + flags + "x"
+        if length == "ll":
+            size = 8
+        elif length in ("l", "j", "z", "t"):
+            size = long_size
+        else:
+            size = int_size
+        code = {2: "h", 4: "i", 8: "q"}[size]
+        args.append("<" + (code if conversion in "di" else code.upper()))
+        if conversion == "u":
+            conversion = "d"
+        return "%" + flags + conversion
+    text = SPEC_EXTRACTOR.sub(convert, format)
+    return text, args
+
+def build_table(sizes, formats):
+    table = {}
+    for format in formats:
+        id = fnv_hash(format)
+        text = format.decode("utf-8", "replace")
+        if id in table and table[id][0] != text:
+            sys.stderr.write("Trace ID collision (0x%04x) between \"%s\" and \"%s\"\n" % (id, table[id][0], text))
+        compiled, args = compile_format(text, sizes)
+        table[id] = (text, compiled, args, sum(struct.calcsize(arg) for arg in args))
+    return table
+
+def decode(table, input, output):
+    buffer = bytearray()
+    last = None
+    clock = 0
+    while True:
+        chunk = input.read1(256) if hasattr(input, "read1") else input.read(256)
+        if not chunk:
+            break
+        buffer.extend(chunk)
+        while len(buffer) >= HEADER_SIZE:
+            if buffer[0] != SYNC:
+                del buffer[0]
+                continue
+            id, timestamp = struct.unpack_from("<HH", buffer, 1)
+            if id not in table:
+                # Lost synchronization: skip to next potential record
+                del buffer[0]
+                continue
+            _, compiled, args, size = table[id]
+            if len(buffer) < HEADER_SIZE + size:
+                break
+            values = []
+            offset = HEADER_SIZE
+            for arg in args:
+                values.append(struct.unpack_from(arg, buffer, offset)[0])
+                offset += struct.calcsize(arg)
+            del buffer[:offset]
+            if last is not None:
+                clock += (timestamp - last) & 0xFFFF
+            last = timestamp
+            output.write("%d\t%s\n" % (clock, compiled % tuple(values)))
+            output.flush()
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description = 'Decode FastArduino binary trace records')
+    parser.add_argument('elf', type=argparse.FileType('rb'), help='ELF file of the traced program')
+    parser.add_argument('input', nargs='?', type=argparse.FileType('rb'), default=sys.stdin.buffer,
+        help='file or serial device to read trace records from (default: stdin)')
+    args = parser.parse_args()
+    with args.elf:
+        sizes, formats = read_formats(args.elf)
+    if not formats:
+        sys.stderr.write("No trace format found in %s\n" % args.elf.name)
+        sys.exit(1)
+    try:
+        decode(build_table(sizes, formats), args.input, sys.stdout)
+    except KeyboardInterrupt:
+        pass